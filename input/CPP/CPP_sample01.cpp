@@ -15,10 +15,60 @@
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <queue>
+#include <exception>
+#include <type_traits>
+#include <cstdint>
+#include <array>
+#include <stdexcept>
+
+#if defined(__has_include) && !defined(ALGORITHM_TOOLKIT_NO_STD_EXECUTION)
+#if __has_include(<execution>)
+#include <execution>
+#endif
+#endif
+
+#if defined(__cpp_lib_parallel_algorithm) && !defined(ALGORITHM_TOOLKIT_NO_STD_EXECUTION)
+#define ALGORITHM_TOOLKIT_HAS_STD_EXECUTION 1
+#else
+#define ALGORITHM_TOOLKIT_HAS_STD_EXECUTION 0
+#endif
 
 namespace AlgorithmToolkit {
 
 
+enum class ExecutionMode {
+    Sequential,
+    Parallel,
+    ParallelUnsequenced,
+    ThreadPool
+};
+
+inline const char* executionModeName(ExecutionMode mode) {
+    switch (mode) {
+        case ExecutionMode::Sequential: return "seq";
+        case ExecutionMode::Parallel: return "par";
+        case ExecutionMode::ParallelUnsequenced: return "par_unseq";
+        case ExecutionMode::ThreadPool: return "pool";
+    }
+    return "unknown";
+}
+
+inline std::vector<ExecutionMode> availableExecutionModes() {
+    std::vector<ExecutionMode> modes = {ExecutionMode::Sequential};
+#if ALGORITHM_TOOLKIT_HAS_STD_EXECUTION
+    modes.push_back(ExecutionMode::Parallel);
+    modes.push_back(ExecutionMode::ParallelUnsequenced);
+#endif
+    modes.push_back(ExecutionMode::ThreadPool);
+    return modes;
+}
+
+
 struct Person {
     std::string name;
     int age;
@@ -47,8 +97,197 @@ struct Person {
 };
 
 
+class PersonTable {
+    std::vector<int> ages;
+    std::vector<double> salaries;
+    std::vector<uint8_t> department_codes;
+    std::vector<std::string> department_names;
+    std::unordered_map<std::string, uint8_t> department_lookup;
+    std::vector<char> name_data;
+    std::vector<size_t> name_offsets = {0};
+    
+public:
+    static constexpr uint8_t kMaxDepartments = 255;
+    static constexpr uint8_t kNoDepartment = 255;
+    
+    void reserve(size_t rows, size_t name_bytes = 0) {
+        ages.reserve(rows);
+        salaries.reserve(rows);
+        department_codes.reserve(rows);
+        name_offsets.reserve(rows + 1);
+        name_data.reserve(name_bytes);
+    }
+    
+    uint8_t internDepartment(const std::string& department) {
+        auto it = department_lookup.find(department);
+        if (it != department_lookup.end()) {
+            return it->second;
+        }
+        if (department_names.size() >= kMaxDepartments) {
+            throw std::length_error("PersonTable supports at most 255 departments");
+        }
+        uint8_t code = static_cast<uint8_t>(department_names.size());
+        department_names.push_back(department);
+        department_lookup.emplace(department, code);
+        return code;
+    }
+    
+    uint8_t departmentCode(const std::string& department) const {
+        auto it = department_lookup.find(department);
+        return it == department_lookup.end() ? kNoDepartment : it->second;
+    }
+    
+    const std::string& departmentName(uint8_t code) const {
+        return department_names.at(code);
+    }
+    
+    size_t departmentCount() const { return department_names.size(); }
+    
+    void append(const std::string& name, int age, double salary, uint8_t department_code) {
+        name_data.insert(name_data.end(), name.begin(), name.end());
+        name_offsets.push_back(name_data.size());
+        ages.push_back(age);
+        salaries.push_back(salary);
+        department_codes.push_back(department_code);
+    }
+    
+    void append(const Person& person) {
+        append(person.name, person.age, person.salary, internDepartment(person.department));
+    }
+    
+    static PersonTable fromPeople(const std::vector<Person>& people) {
+        PersonTable table;
+        table.reserve(people.size());
+        for (const auto& person : people) {
+            table.append(person);
+        }
+        return table;
+    }
+    
+    size_t size() const { return ages.size(); }
+    bool empty() const { return ages.empty(); }
+    
+    const std::vector<int>& ageColumn() const { return ages; }
+    const std::vector<double>& salaryColumn() const { return salaries; }
+    const std::vector<uint8_t>& departmentColumn() const { return department_codes; }
+    
+    std::string name(size_t row) const {
+        return std::string(name_data.data() + name_offsets[row], name_data.data() + name_offsets[row + 1]);
+    }
+    
+    Person row(size_t index) const {
+        return Person(name(index), ages[index], salaries[index], department_names[department_codes[index]]);
+    }
+    
+    double totalSalary() const {
+        const double* salary = salaries.data();
+        size_t n = salaries.size();
+        double total = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            total += salary[i];
+        }
+        return total;
+    }
+    
+    double averageSalary() const {
+        return empty() ? 0.0 : totalSalary() / size();
+    }
+    
+    size_t countSalaryAbove(double threshold) const {
+        const double* salary = salaries.data();
+        size_t n = salaries.size();
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            count += salary[i] > threshold;
+        }
+        return count;
+    }
+    
+    size_t countDepartment(uint8_t code) const {
+        const uint8_t* dept = department_codes.data();
+        size_t n = department_codes.size();
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            count += dept[i] == code;
+        }
+        return count;
+    }
+    
+    std::pair<size_t, size_t> minmaxAgeRows() const {
+        if (empty()) {
+            return {0, 0};
+        }
+        const int* age = ages.data();
+        size_t n = ages.size();
+        int min_age = age[0];
+        int max_age = age[0];
+        for (size_t i = 1; i < n; ++i) {
+            min_age = std::min(min_age, age[i]);
+            max_age = std::max(max_age, age[i]);
+        }
+        // Matches std::minmax_element: first minimum, last maximum.
+        size_t min_row = std::find(ages.begin(), ages.end(), min_age) - ages.begin();
+        size_t max_row = n - 1 - (std::find(ages.rbegin(), ages.rend(), max_age) - ages.rbegin());
+        return {min_row, max_row};
+    }
+    
+    std::vector<uint32_t> selectDepartment(uint8_t code) const {
+        const uint8_t* dept = department_codes.data();
+        size_t n = department_codes.size();
+        std::vector<uint32_t> rows(n);
+        uint32_t* out = rows.data();
+        size_t selected = 0;
+        for (size_t i = 0; i < n; ++i) {
+            out[selected] = static_cast<uint32_t>(i);
+            selected += dept[i] == code;
+        }
+        rows.resize(selected);
+        return rows;
+    }
+    
+    PersonTable gather(const std::vector<uint32_t>& rows) const {
+        PersonTable result;
+        result.department_names = department_names;
+        result.department_lookup = department_lookup;
+        result.reserve(rows.size());
+        for (uint32_t r : rows) {
+            result.name_data.insert(result.name_data.end(), name_data.begin() + name_offsets[r],
+                                    name_data.begin() + name_offsets[r + 1]);
+            result.name_offsets.push_back(result.name_data.size());
+            result.ages.push_back(ages[r]);
+            result.salaries.push_back(salaries[r]);
+            result.department_codes.push_back(department_codes[r]);
+        }
+        return result;
+    }
+    
+    struct DepartmentSummary {
+        size_t headcount = 0;
+        double total_salary = 0.0;
+        long long total_age = 0;
+    };
+    
+    std::vector<DepartmentSummary> summarizeByDepartment() const {
+        std::vector<DepartmentSummary> summary(department_names.size());
+        const uint8_t* dept = department_codes.data();
+        const double* salary = salaries.data();
+        const int* age = ages.data();
+        size_t n = size();
+        for (size_t i = 0; i < n; ++i) {
+            auto& bucket = summary[dept[i]];
+            ++bucket.headcount;
+            bucket.total_salary += salary[i];
+            bucket.total_age += age[i];
+        }
+        return summary;
+    }
+};
+
+
 class PerformanceTimer {
     std::chrono::high_resolution_clock::time_point start_time;
+    std::vector<std::string> operations;
+    std::map<std::string, std::map<ExecutionMode, double>> mode_results;
     
 public:
     void start() {
@@ -60,6 +299,401 @@ public:
         auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
         return duration.count() / 1000.0;
     }
+    
+    void record(const std::string& operation, ExecutionMode mode, double ms) {
+        if (mode_results.find(operation) == mode_results.end()) {
+            operations.push_back(operation);
+        }
+        mode_results[operation][mode] = ms;
+    }
+    
+    void printModeComparison(const std::vector<ExecutionMode>& modes) const {
+        std::cout << std::left << std::setw(22) << "operation";
+        for (ExecutionMode mode : modes) {
+            std::cout << std::right << std::setw(12) << executionModeName(mode);
+        }
+        std::cout << std::right << std::setw(10) << "speedup" << "\n";
+        
+        auto old_flags = std::cout.flags();
+        auto old_precision = std::cout.precision();
+        std::cout << std::fixed << std::setprecision(3);
+        
+        for (const auto& operation : operations) {
+            const auto& row = mode_results.at(operation);
+            std::cout << std::left << std::setw(22) << operation << std::right;
+            
+            double best = 0.0;
+            for (ExecutionMode mode : modes) {
+                auto it = row.find(mode);
+                if (it == row.end()) {
+                    std::cout << std::setw(12) << "-";
+                    continue;
+                }
+                std::cout << std::setw(12) << it->second;
+                if (best == 0.0 || it->second < best) {
+                    best = it->second;
+                }
+            }
+            
+            auto seq = row.find(ExecutionMode::Sequential);
+            if (seq != row.end() && best > 0.0) {
+                std::cout << std::setw(9) << std::setprecision(2) << seq->second / best << "x"
+                          << std::setprecision(3);
+            }
+            std::cout << "\n";
+        }
+        
+        std::cout.flags(old_flags);
+        std::cout.precision(old_precision);
+    }
+};
+
+
+class WorkerPool {
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    bool stopping = false;
+    
+    struct ChunkBatch {
+        std::atomic<size_t> next_chunk{0};
+        size_t chunk_count = 0;
+        size_t pending_helpers = 0;
+        std::mutex done_mutex;
+        std::condition_variable done_cv;
+        std::exception_ptr error;
+    };
+    
+    void workerLoop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+    
+    template<typename Fn>
+    static void drainChunks(ChunkBatch& batch, Fn& fn) {
+        for (;;) {
+            size_t chunk = batch.next_chunk.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= batch.chunk_count) {
+                return;
+            }
+            try {
+                fn(chunk);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(batch.done_mutex);
+                if (!batch.error) {
+                    batch.error = std::current_exception();
+                }
+            }
+        }
+    }
+    
+public:
+    explicit WorkerPool(size_t thread_count = std::max(1u, std::thread::hardware_concurrency())) {
+        // The calling thread always takes part in parallelFor, so one fewer worker is enough.
+        for (size_t i = 1; i < thread_count; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+    
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            stopping = true;
+        }
+        queue_cv.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    
+    static WorkerPool& instance() {
+        static WorkerPool pool;
+        return pool;
+    }
+    
+    size_t concurrency() const {
+        return workers.size() + 1;
+    }
+    
+    template<typename Fn>
+    void parallelFor(size_t chunk_count, Fn&& fn) {
+        if (chunk_count == 0) {
+            return;
+        }
+        
+        ChunkBatch batch;
+        batch.chunk_count = chunk_count;
+        size_t helpers = std::min(workers.size(), chunk_count - 1);
+        batch.pending_helpers = helpers;
+        
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            for (size_t i = 0; i < helpers; ++i) {
+                tasks.push([&batch, &fn] {
+                    drainChunks(batch, fn);
+                    std::lock_guard<std::mutex> done_lock(batch.done_mutex);
+                    if (--batch.pending_helpers == 0) {
+                        batch.done_cv.notify_one();
+                    }
+                });
+            }
+        }
+        queue_cv.notify_all();
+        
+        drainChunks(batch, fn);
+        
+        std::unique_lock<std::mutex> lock(batch.done_mutex);
+        batch.done_cv.wait(lock, [&batch] { return batch.pending_helpers == 0; });
+        if (batch.error) {
+            std::rethrow_exception(batch.error);
+        }
+    }
+};
+
+
+class ParallelAlgorithms {
+    static constexpr size_t kPoolCutoff = 1 << 13;
+    
+    static size_t chunkCountFor(size_t size) {
+        if (size < kPoolCutoff) {
+            return 1;
+        }
+        return std::min(WorkerPool::instance().concurrency(), size / (kPoolCutoff / 2));
+    }
+    
+    static size_t chunkBegin(size_t size, size_t chunks, size_t index) {
+        return size / chunks * index + std::min(index, size % chunks);
+    }
+    
+    template<typename It, typename Compare>
+    static void poolSort(It first, It last, Compare comp, bool stable) {
+        size_t size = static_cast<size_t>(std::distance(first, last));
+        size_t chunks = chunkCountFor(size);
+        if (chunks <= 1) {
+            if (stable) {
+                std::stable_sort(first, last, comp);
+            } else {
+                std::sort(first, last, comp);
+            }
+            return;
+        }
+        
+        std::vector<size_t> bounds(chunks + 1);
+        for (size_t i = 0; i <= chunks; ++i) {
+            bounds[i] = chunkBegin(size, chunks, i);
+        }
+        
+        WorkerPool::instance().parallelFor(chunks, [&](size_t i) {
+            if (stable) {
+                std::stable_sort(first + bounds[i], first + bounds[i + 1], comp);
+            } else {
+                std::sort(first + bounds[i], first + bounds[i + 1], comp);
+            }
+        });
+        
+        // inplace_merge of adjacent runs keeps equal elements in order, so the
+        // merge rounds preserve stability for stable_sort as well.
+        for (size_t width = 1; width < chunks; width *= 2) {
+            size_t merges = (chunks + 2 * width - 1) / (2 * width);
+            WorkerPool::instance().parallelFor(merges, [&](size_t m) {
+                size_t lo = m * 2 * width;
+                size_t mid = std::min(lo + width, chunks);
+                size_t hi = std::min(lo + 2 * width, chunks);
+                if (mid < hi) {
+                    std::inplace_merge(first + bounds[lo], first + bounds[mid], first + bounds[hi], comp);
+                }
+            });
+        }
+    }
+    
+public:
+    template<typename It, typename Compare = std::less<>>
+    static void sort(ExecutionMode mode, It first, It last, Compare comp = Compare()) {
+        switch (mode) {
+#if ALGORITHM_TOOLKIT_HAS_STD_EXECUTION
+            case ExecutionMode::Parallel:
+                std::sort(std::execution::par, first, last, comp);
+                return;
+            case ExecutionMode::ParallelUnsequenced:
+                std::sort(std::execution::par_unseq, first, last, comp);
+                return;
+#endif
+            case ExecutionMode::ThreadPool:
+                poolSort(first, last, comp, false);
+                return;
+            default:
+                std::sort(first, last, comp);
+                return;
+        }
+    }
+    
+    template<typename It, typename Compare = std::less<>>
+    static void stable_sort(ExecutionMode mode, It first, It last, Compare comp = Compare()) {
+        switch (mode) {
+#if ALGORITHM_TOOLKIT_HAS_STD_EXECUTION
+            case ExecutionMode::Parallel:
+                std::stable_sort(std::execution::par, first, last, comp);
+                return;
+            case ExecutionMode::ParallelUnsequenced:
+                std::stable_sort(std::execution::par_unseq, first, last, comp);
+                return;
+#endif
+            case ExecutionMode::ThreadPool:
+                poolSort(first, last, comp, true);
+                return;
+            default:
+                std::stable_sort(first, last, comp);
+                return;
+        }
+    }
+    
+    template<typename It, typename Compare = std::less<>>
+    static void nth_element(ExecutionMode mode, It first, It nth, It last, Compare comp = Compare()) {
+        switch (mode) {
+#if ALGORITHM_TOOLKIT_HAS_STD_EXECUTION
+            case ExecutionMode::Parallel:
+                std::nth_element(std::execution::par, first, nth, last, comp);
+                return;
+            case ExecutionMode::ParallelUnsequenced:
+                std::nth_element(std::execution::par_unseq, first, nth, last, comp);
+                return;
+#endif
+            default:
+                // Selection is a single linear pass bounded by memory bandwidth;
+                // the pool has no partitioning scheme that beats it, so it runs inline.
+                std::nth_element(first, nth, last, comp);
+                return;
+        }
+    }
+    
+    template<typename It, typename Predicate>
+    static size_t count_if(ExecutionMode mode, It first, It last, Predicate pred) {
+        switch (mode) {
+#if ALGORITHM_TOOLKIT_HAS_STD_EXECUTION
+            case ExecutionMode::Parallel:
+                return std::count_if(std::execution::par, first, last, pred);
+            case ExecutionMode::ParallelUnsequenced:
+                return std::count_if(std::execution::par_unseq, first, last, pred);
+#endif
+            case ExecutionMode::ThreadPool: {
+                size_t size = static_cast<size_t>(std::distance(first, last));
+                size_t chunks = chunkCountFor(size);
+                std::vector<size_t> partial(chunks, 0);
+                WorkerPool::instance().parallelFor(chunks, [&](size_t i) {
+                    partial[i] = std::count_if(first + chunkBegin(size, chunks, i),
+                                               first + chunkBegin(size, chunks, i + 1), pred);
+                });
+                return std::accumulate(partial.begin(), partial.end(), size_t(0));
+            }
+            default:
+                return std::count_if(first, last, pred);
+        }
+    }
+    
+    template<typename It, typename Predicate>
+    static std::vector<typename std::iterator_traits<It>::value_type>
+    copy_if(ExecutionMode mode, It first, It last, Predicate pred) {
+        using Value = typename std::iterator_traits<It>::value_type;
+        std::vector<Value> result;
+        
+#if ALGORITHM_TOOLKIT_HAS_STD_EXECUTION
+        if constexpr (std::is_default_constructible_v<Value>) {
+            if (mode == ExecutionMode::Parallel || mode == ExecutionMode::ParallelUnsequenced) {
+                result.resize(static_cast<size_t>(std::distance(first, last)));
+                auto end = mode == ExecutionMode::Parallel
+                    ? std::copy_if(std::execution::par, first, last, result.begin(), pred)
+                    : std::copy_if(std::execution::par_unseq, first, last, result.begin(), pred);
+                result.erase(end, result.end());
+                return result;
+            }
+        }
+#endif
+        
+        if (mode == ExecutionMode::Sequential) {
+            std::copy_if(first, last, std::back_inserter(result), pred);
+            return result;
+        }
+        
+        // Non-default-constructible values cannot be pre-sized for the policy
+        // overloads, so they share the pool path: filter per chunk, splice in order.
+        size_t size = static_cast<size_t>(std::distance(first, last));
+        size_t chunks = chunkCountFor(size);
+        std::vector<std::vector<Value>> partial(chunks);
+        WorkerPool::instance().parallelFor(chunks, [&](size_t i) {
+            std::copy_if(first + chunkBegin(size, chunks, i), first + chunkBegin(size, chunks, i + 1),
+                         std::back_inserter(partial[i]), pred);
+        });
+        
+        size_t total = 0;
+        for (const auto& part : partial) {
+            total += part.size();
+        }
+        result.reserve(total);
+        for (auto& part : partial) {
+            std::move(part.begin(), part.end(), std::back_inserter(result));
+        }
+        return result;
+    }
+    
+    template<typename It, typename T, typename BinaryOp = std::plus<>>
+    static T reduce(ExecutionMode mode, It first, It last, T init, BinaryOp op = BinaryOp()) {
+        return transform_reduce(mode, first, last, init, op, [](const auto& x) { return x; });
+    }
+    
+    template<typename It, typename T, typename BinaryOp, typename UnaryOp>
+    static T transform_reduce(ExecutionMode mode, It first, It last, T init, BinaryOp reduce_op, UnaryOp transform_op) {
+        switch (mode) {
+#if ALGORITHM_TOOLKIT_HAS_STD_EXECUTION
+            case ExecutionMode::Parallel:
+                return std::transform_reduce(std::execution::par, first, last, init, reduce_op, transform_op);
+            case ExecutionMode::ParallelUnsequenced:
+                return std::transform_reduce(std::execution::par_unseq, first, last, init, reduce_op, transform_op);
+#endif
+            case ExecutionMode::ThreadPool: {
+                size_t size = static_cast<size_t>(std::distance(first, last));
+                size_t chunks = chunkCountFor(size);
+                std::vector<T> partial(chunks, init);
+                std::vector<char> has_value(chunks, 0);
+                WorkerPool::instance().parallelFor(chunks, [&](size_t i) {
+                    auto begin = first + chunkBegin(size, chunks, i);
+                    auto end = first + chunkBegin(size, chunks, i + 1);
+                    if (begin == end) {
+                        return;
+                    }
+                    T acc = transform_op(*begin);
+                    for (++begin; begin != end; ++begin) {
+                        acc = reduce_op(acc, transform_op(*begin));
+                    }
+                    partial[i] = acc;
+                    has_value[i] = 1;
+                });
+                T result = init;
+                for (size_t i = 0; i < chunks; ++i) {
+                    if (has_value[i]) {
+                        result = reduce_op(result, partial[i]);
+                    }
+                }
+                return result;
+            }
+            default:
+                return std::transform_reduce(first, last, init, reduce_op, transform_op);
+        }
+    }
 };
 
 
@@ -110,6 +744,187 @@ public:
         
         return result;
     }
+    
+    PersonTable generatePersonTable(size_t count) {
+        PersonTable table;
+        table.reserve(count, count * 12);
+        
+        std::uniform_int_distribution<int> age_dist(22, 65);
+        std::uniform_real_distribution<double> salary_dist(30000.0, 150000.0);
+        std::uniform_int_distribution<size_t> name_dist(0, first_names.size() - 1);
+        std::uniform_int_distribution<size_t> dept_dist(0, departments.size() - 1);
+        
+        std::vector<uint8_t> dept_codes;
+        for (const auto& dept : departments) {
+            dept_codes.push_back(table.internDepartment(dept));
+        }
+        
+        std::string name;
+        for (size_t i = 0; i < count; ++i) {
+            name = first_names[name_dist(rng)];
+            name += std::to_string(i);
+            int age = age_dist(rng);
+            double salary = salary_dist(rng);
+            table.append(name, age, salary, dept_codes[dept_dist(rng)]);
+        }
+        
+        return table;
+    }
+};
+
+
+struct IdentityKey {
+    template<typename T>
+    T operator()(const T& value) const { return value; }
+};
+
+
+class IntegerSortEngine {
+public:
+    enum class Strategy {
+        Comparison,
+        Counting,
+        Radix
+    };
+    
+    static constexpr size_t kComparisonCutoff = 64;
+    static constexpr unsigned long long kMaxCountingRange = 1ULL << 20;
+    
+    static const char* strategyName(Strategy strategy) {
+        switch (strategy) {
+            case Strategy::Comparison: return "comparison";
+            case Strategy::Counting: return "counting";
+            case Strategy::Radix: return "radix";
+        }
+        return "unknown";
+    }
+    
+    template<typename It, typename KeyFn = IdentityKey>
+    static Strategy sort(It first, It last, KeyFn key = KeyFn()) {
+        size_t n = static_cast<size_t>(std::distance(first, last));
+        if (n < kComparisonCutoff) {
+            std::stable_sort(first, last, [&key](const auto& a, const auto& b) { return key(a) < key(b); });
+            return Strategy::Comparison;
+        }
+        
+        auto [min_it, max_it] = std::minmax_element(first, last,
+            [&key](const auto& a, const auto& b) { return key(a) < key(b); });
+        auto min_key = key(*min_it);
+        auto max_key = key(*max_it);
+        unsigned long long range = toUnsigned(max_key) - toUnsigned(min_key) + 1;
+        
+        if (range != 0 && range <= kMaxCountingRange && range <= std::max<unsigned long long>(n, 256)) {
+            countingSort(first, last, key, min_key, max_key);
+            return Strategy::Counting;
+        }
+        radixSort(first, last, key);
+        return Strategy::Radix;
+    }
+    
+    template<typename It, typename KeyFn, typename Key>
+    static void countingSort(It first, It last, KeyFn key, Key min_key, Key max_key) {
+        using Value = typename std::iterator_traits<It>::value_type;
+        size_t n = static_cast<size_t>(std::distance(first, last));
+        if (n < 2) {
+            return;
+        }
+        
+        auto base = toUnsigned(min_key);
+        size_t range = static_cast<size_t>(toUnsigned(max_key) - base) + 1;
+        std::vector<size_t> counts(range, 0);
+        for (It it = first; it != last; ++it) {
+            ++counts[static_cast<size_t>(toUnsigned(key(*it)) - base)];
+        }
+        
+        // Integral values sorted by themselves carry no payload, so the
+        // histogram can be expanded in place without a scatter buffer.
+        if constexpr (std::is_same_v<KeyFn, IdentityKey> && std::is_integral_v<Value>) {
+            It out = first;
+            for (size_t k = 0; k < range; ++k) {
+                out = std::fill_n(out, counts[k], static_cast<Value>(min_key + static_cast<Value>(k)));
+            }
+        } else {
+            size_t offset = 0;
+            for (size_t k = 0; k < range; ++k) {
+                size_t count = counts[k];
+                counts[k] = offset;
+                offset += count;
+            }
+            
+            std::vector<Value> buffer(first, last);
+            for (const auto& value : buffer) {
+                *(first + counts[static_cast<size_t>(toUnsigned(key(value)) - base)]++) = value;
+            }
+        }
+    }
+    
+    template<typename It, typename KeyFn = IdentityKey>
+    static void radixSort(It first, It last, KeyFn key = KeyFn()) {
+        using Value = typename std::iterator_traits<It>::value_type;
+        using Key = std::decay_t<decltype(key(*first))>;
+        static_assert(std::is_integral_v<Key>, "radixSort requires an integral key");
+        constexpr size_t kPasses = sizeof(Key);
+        
+        size_t n = static_cast<size_t>(std::distance(first, last));
+        if (n < 2) {
+            return;
+        }
+        
+        std::vector<std::array<size_t, 256>> counts(kPasses);
+        for (auto& pass : counts) {
+            pass.fill(0);
+        }
+        for (It it = first; it != last; ++it) {
+            auto u = toUnsigned(key(*it));
+            for (size_t pass = 0; pass < kPasses; ++pass) {
+                ++counts[pass][(u >> (8 * pass)) & 0xFF];
+            }
+        }
+        
+        std::vector<Value> buffer(first, last);
+        std::vector<Value> scratch(buffer);
+        Value* src = buffer.data();
+        Value* dst = scratch.data();
+        bool moved = false;
+        
+        for (size_t pass = 0; pass < kPasses; ++pass) {
+            auto& histogram = counts[pass];
+            size_t first_digit = (toUnsigned(key(src[0])) >> (8 * pass)) & 0xFF;
+            if (histogram[first_digit] == n) {
+                continue;
+            }
+            
+            size_t offset = 0;
+            for (auto& count : histogram) {
+                size_t c = count;
+                count = offset;
+                offset += c;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                size_t digit = (toUnsigned(key(src[i])) >> (8 * pass)) & 0xFF;
+                dst[histogram[digit]++] = std::move(src[i]);
+            }
+            std::swap(src, dst);
+            moved = true;
+        }
+        
+        if (moved) {
+            std::move(src, src + n, first);
+        }
+    }
+    
+private:
+    // Maps a signed key onto an unsigned one with the same ordering by
+    // flipping the sign bit, so both share one digit extraction path.
+    template<typename Key>
+    static auto toUnsigned(Key key) {
+        using UKey = std::make_unsigned_t<Key>;
+        if constexpr (std::is_signed_v<Key>) {
+            return static_cast<UKey>(static_cast<UKey>(key) ^ (UKey(1) << (sizeof(Key) * 8 - 1)));
+        } else {
+            return static_cast<UKey>(key);
+        }
+    }
 };
 
 
@@ -151,6 +966,131 @@ public:
         
         bool is_sorted = std::is_sorted(data1.begin(), data1.end());
         std::cout << "Result is sorted: " << (is_sorted ? "Yes" : "No") << "\n";
+        
+        if constexpr (std::is_integral_v<typename Container::value_type>) {
+            demonstrateIntegerSorting(data);
+        }
+        
+        demonstrateExecutionModes(data);
+    }
+    
+    template<typename Container>
+    static void demonstrateIntegerSorting(const Container& data) {
+        std::cout << "\nInteger sort engine vs std::sort (" << data.size() << " elements):\n";
+        
+        PerformanceTimer timer;
+        
+        auto reference = data;
+        timer.start();
+        std::sort(reference.begin(), reference.end());
+        double std_time = timer.elapsed_ms();
+        
+        auto counted = data;
+        timer.start();
+        if (!counted.empty()) {
+            auto [min_it, max_it] = std::minmax_element(counted.begin(), counted.end());
+            IntegerSortEngine::countingSort(counted.begin(), counted.end(), IdentityKey(), *min_it, *max_it);
+        }
+        double counting_time = timer.elapsed_ms();
+        
+        auto radixed = data;
+        timer.start();
+        IntegerSortEngine::radixSort(radixed.begin(), radixed.end());
+        double radix_time = timer.elapsed_ms();
+        
+        auto automatic = data;
+        timer.start();
+        auto strategy = IntegerSortEngine::sort(automatic.begin(), automatic.end());
+        double auto_time = timer.elapsed_ms();
+        
+        auto speedup = [std_time](double ms) { return ms > 0.0 ? std_time / ms : 0.0; };
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "std::sort: " << std_time << " ms\n";
+        std::cout << "counting sort: " << counting_time << " ms (" << std::setprecision(1)
+                  << speedup(counting_time) << "x)\n" << std::setprecision(3);
+        std::cout << "LSD radix sort: " << radix_time << " ms (" << std::setprecision(1)
+                  << speedup(radix_time) << "x)\n" << std::setprecision(3);
+        std::cout << "IntegerSortEngine::sort [" << IntegerSortEngine::strategyName(strategy) << "]: "
+                  << auto_time << " ms (" << std::setprecision(1) << speedup(auto_time) << "x)\n";
+        
+        bool matches = counted == reference && radixed == reference && automatic == reference;
+        std::cout << "Engine results match std::sort: " << (matches ? "Yes" : "No") << "\n";
+    }
+    
+    static void demonstrateKeySorting(size_t count) {
+        std::cout << "\n=== Key-Extractor Sorting (" << count << " people) ===\n";
+        
+        DataGenerator gen;
+        auto people = gen.generatePeople(count);
+        auto by_age = [](const Person& p) { return p.age; };
+        
+        PerformanceTimer timer;
+        
+        auto reference = people;
+        timer.start();
+        std::stable_sort(reference.begin(), reference.end(),
+                         [](const Person& a, const Person& b) { return a.age < b.age; });
+        double std_time = timer.elapsed_ms();
+        
+        auto sorted = people;
+        timer.start();
+        auto strategy = IntegerSortEngine::sort(sorted.begin(), sorted.end(), by_age);
+        double engine_time = timer.elapsed_ms();
+        
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "std::stable_sort by age: " << std_time << " ms\n";
+        std::cout << "IntegerSortEngine by age [" << IntegerSortEngine::strategyName(strategy) << "]: "
+                  << engine_time << " ms\n";
+        std::cout << "Same order as std::stable_sort: " << (sorted == reference ? "Yes" : "No") << "\n";
+        
+        
+        auto table = PersonTable::fromPeople(people);
+        const auto& departments = table.departmentColumn();
+        std::vector<uint32_t> rows(table.size());
+        std::iota(rows.begin(), rows.end(), 0u);
+        
+        timer.start();
+        strategy = IntegerSortEngine::sort(rows.begin(), rows.end(),
+                                           [&departments](uint32_t r) { return departments[r]; });
+        double dept_time = timer.elapsed_ms();
+        
+        bool grouped = std::is_sorted(rows.begin(), rows.end(),
+            [&departments](uint32_t a, uint32_t b) { return departments[a] < departments[b]; });
+        std::cout << "Row order by department code [" << IntegerSortEngine::strategyName(strategy) << "]: "
+                  << dept_time << " ms, grouped: " << (grouped ? "Yes" : "No") << "\n";
+    }
+    
+    template<typename Container>
+    static void demonstrateExecutionModes(const Container& data) {
+        std::cout << "\nExecution modes (" << data.size() << " elements, "
+                  << WorkerPool::instance().concurrency() << " pool threads):\n";
+        
+        auto modes = availableExecutionModes();
+        PerformanceTimer timer;
+        bool all_sorted = true;
+        
+        for (ExecutionMode mode : modes) {
+            auto sorted = data;
+            timer.start();
+            ParallelAlgorithms::sort(mode, sorted.begin(), sorted.end());
+            timer.record("sort", mode, timer.elapsed_ms());
+            all_sorted = all_sorted && std::is_sorted(sorted.begin(), sorted.end());
+            
+            auto stable = data;
+            timer.start();
+            ParallelAlgorithms::stable_sort(mode, stable.begin(), stable.end());
+            timer.record("stable_sort", mode, timer.elapsed_ms());
+            all_sorted = all_sorted && std::is_sorted(stable.begin(), stable.end());
+            
+            auto selected = data;
+            timer.start();
+            ParallelAlgorithms::nth_element(mode, selected.begin(), selected.begin() + selected.size() / 2,
+                                            selected.end());
+            timer.record("nth_element (median)", mode, timer.elapsed_ms());
+        }
+        
+        timer.printModeComparison(modes);
+        std::cout << "All modes sorted correctly: " << (all_sorted ? "Yes" : "No") << "\n";
     }
     
     static void demonstrateCustomSorting() {
@@ -235,33 +1175,119 @@ public:
         std::cout << "\n=== Advanced Search Patterns ===\n";
         
         DataGenerator gen;
-        auto people = gen.generatePeople(100);
+        auto people = gen.generatePersonTable(100);
         
         
         std::string target_dept = "Engineering";
-        std::vector<Person> engineers;
-        
-        std::copy_if(people.begin(), people.end(), std::back_inserter(engineers),
-                     [&target_dept](const Person& p) { return p.department == target_dept; });
+        auto engineers = people.selectDepartment(people.departmentCode(target_dept));
         
         std::cout << "Found " << engineers.size() << " people in " << target_dept << "\n";
         
         
-        double avg_salary = std::accumulate(people.begin(), people.end(), 0.0,
-                                          [](double sum, const Person& p) { return sum + p.salary; }) / people.size();
-        
-        auto high_earners = std::count_if(people.begin(), people.end(),
-                                        [avg_salary](const Person& p) { return p.salary > avg_salary; });
+        double avg_salary = people.averageSalary();
+        auto high_earners = people.countSalaryAbove(avg_salary);
         
         std::cout << "Average salary: $" << std::fixed << std::setprecision(0) << avg_salary << "\n";
         std::cout << "People earning above average: " << high_earners << "\n";
         
         
-        auto [min_age_it, max_age_it] = std::minmax_element(people.begin(), people.end(),
-                                                          [](const Person& a, const Person& b) { return a.age < b.age; });
+        auto [min_age_row, max_age_row] = people.minmaxAgeRows();
         
-        std::cout << "Youngest person: " << min_age_it->toString() << "\n";
-        std::cout << "Oldest person: " << max_age_it->toString() << "\n";
+        std::cout << "Youngest person: " << people.row(min_age_row).toString() << "\n";
+        std::cout << "Oldest person: " << people.row(max_age_row).toString() << "\n";
+    }
+    
+    static void demonstrateDepartmentAnalytics(size_t count) {
+        std::cout << "\n=== Columnar Department Analytics (" << count << " rows) ===\n";
+        
+        DataGenerator gen;
+        auto table = gen.generatePersonTable(count);
+        if (table.empty()) {
+            return;
+        }
+        
+        PerformanceTimer timer;
+        
+        timer.start();
+        double avg_salary = table.averageSalary();
+        double avg_time = timer.elapsed_ms();
+        
+        timer.start();
+        size_t high_earners = table.countSalaryAbove(avg_salary);
+        double count_time = timer.elapsed_ms();
+        
+        timer.start();
+        auto [min_age_row, max_age_row] = table.minmaxAgeRows();
+        double minmax_time = timer.elapsed_ms();
+        
+        timer.start();
+        auto engineers = table.selectDepartment(table.departmentCode("Engineering"));
+        double select_time = timer.elapsed_ms();
+        
+        timer.start();
+        auto summary = table.summarizeByDepartment();
+        double summary_time = timer.elapsed_ms();
+        
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "Average salary: " << avg_time << " ms, above average: " << high_earners
+                  << " (" << count_time << " ms)\n";
+        std::cout << "Age range " << table.ageColumn()[min_age_row] << "-" << table.ageColumn()[max_age_row]
+                  << " (" << minmax_time << " ms)\n";
+        std::cout << "Engineering rows selected: " << engineers.size() << " (" << select_time << " ms)\n";
+        std::cout << "Department summary (" << summary_time << " ms):\n";
+        
+        std::cout << std::setprecision(0);
+        for (size_t code = 0; code < summary.size(); ++code) {
+            const auto& dept = summary[code];
+            if (dept.headcount == 0) {
+                continue;
+            }
+            std::cout << "  " << std::left << std::setw(12) << table.departmentName(static_cast<uint8_t>(code))
+                      << std::right << std::setw(10) << dept.headcount << " people, avg salary $"
+                      << dept.total_salary / dept.headcount << ", avg age "
+                      << std::setprecision(1) << static_cast<double>(dept.total_age) / dept.headcount
+                      << std::setprecision(0) << "\n";
+        }
+    }
+    
+    static void demonstrateParallelFilters(size_t count) {
+        std::cout << "\n=== Parallel Filter Patterns (" << count << " people) ===\n";
+        
+        DataGenerator gen;
+        auto people = gen.generatePeople(count);
+        if (people.empty()) {
+            return;
+        }
+        
+        auto modes = availableExecutionModes();
+        PerformanceTimer timer;
+        std::set<size_t> engineer_counts;
+        std::set<size_t> high_earner_counts;
+        
+        for (ExecutionMode mode : modes) {
+            timer.start();
+            double total_salary = ParallelAlgorithms::transform_reduce(
+                mode, people.begin(), people.end(), 0.0, std::plus<>(),
+                [](const Person& p) { return p.salary; });
+            timer.record("salary reduce", mode, timer.elapsed_ms());
+            
+            double avg_salary = total_salary / people.size();
+            timer.start();
+            size_t high_earners = ParallelAlgorithms::count_if(mode, people.begin(), people.end(),
+                [avg_salary](const Person& p) { return p.salary > avg_salary; });
+            timer.record("count_if", mode, timer.elapsed_ms());
+            high_earner_counts.insert(high_earners);
+            
+            timer.start();
+            auto engineers = ParallelAlgorithms::copy_if(mode, people.begin(), people.end(),
+                [](const Person& p) { return p.department == "Engineering"; });
+            timer.record("copy_if", mode, timer.elapsed_ms());
+            engineer_counts.insert(engineers.size());
+        }
+        
+        timer.printModeComparison(modes);
+        std::cout << "Modes agree on results: "
+                  << (engineer_counts.size() == 1 && high_earner_counts.size() == 1 ? "Yes" : "No") << "\n";
     }
 };
 
@@ -293,17 +1319,46 @@ public:
                   << " (computed in " << timer.elapsed_ms() << " ms)\n";
         
         
-        timer.start();
-        int parallel_sum = std::accumulate(numbers.begin(), numbers.end(), 0);
-        std::cout << "Alternative sum: " << parallel_sum << " (computed in " << timer.elapsed_ms() << " ms)\n";
-        
-        
         timer.start();
         int sum_of_squares = std::transform_reduce(numbers.begin(), numbers.end(), 0, std::plus<>(),
                                                  [](int x) { return x * x; });
         std::cout << "Sum of squares: " << sum_of_squares << " (computed in " << timer.elapsed_ms() << " ms)\n";
     }
     
+    static void demonstrateParallelReductions(size_t count) {
+        std::cout << "\n=== Parallel Reductions (" << count << " elements) ===\n";
+        
+        DataGenerator gen;
+        auto numbers = gen.generateIntegers(count, 1, 100);
+        
+        auto modes = availableExecutionModes();
+        PerformanceTimer timer;
+        std::set<long long> sums;
+        std::set<long long> sums_of_squares;
+        
+        for (ExecutionMode mode : modes) {
+            timer.start();
+            long long sum = ParallelAlgorithms::reduce(mode, numbers.begin(), numbers.end(), 0LL);
+            timer.record("sum", mode, timer.elapsed_ms());
+            sums.insert(sum);
+            
+            timer.start();
+            long long squares = ParallelAlgorithms::transform_reduce(
+                mode, numbers.begin(), numbers.end(), 0LL, std::plus<>(),
+                [](int x) { return static_cast<long long>(x) * x; });
+            timer.record("sum of squares", mode, timer.elapsed_ms());
+            sums_of_squares.insert(squares);
+        }
+        
+        timer.printModeComparison(modes);
+        if (sums.size() == 1 && sums_of_squares.size() == 1) {
+            std::cout << "Sum: " << *sums.begin() << ", sum of squares: " << *sums_of_squares.begin()
+                      << " (identical across modes)\n";
+        } else {
+            std::cout << "Modes disagree on reduction results\n";
+        }
+    }
+    
     static void demonstrateTransformations() {
         std::cout << "\n=== Transformation Algorithms ===\n";
         
@@ -432,17 +1487,21 @@ void demonstrateAlgorithmToolkit() {
     DataGenerator gen;
     
     
-    auto integers = gen.generateIntegers(10000);
+    auto integers = gen.generateIntegers(1000000);
     SortingAlgorithms::demonstrateSorting(integers, "Integer");
     SortingAlgorithms::demonstrateCustomSorting();
+    SortingAlgorithms::demonstrateKeySorting(200000);
     
     
     int target = integers[integers.size() / 2]; 
     SearchAlgorithms::demonstrateSearch(integers, target);
     SearchAlgorithms::demonstrateAdvancedSearch();
+    SearchAlgorithms::demonstrateDepartmentAnalytics(2000000);
+    SearchAlgorithms::demonstrateParallelFilters(200000);
     
     
     NumericAlgorithms::demonstrateAccumulation();
+    NumericAlgorithms::demonstrateParallelReductions(4000000);
     NumericAlgorithms::demonstrateTransformations();
     
     
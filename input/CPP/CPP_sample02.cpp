@@ -6,14 +6,67 @@
 #include <algorithm>
 #include <stdexcept>
 #include <iomanip>
+#include <cmath>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <limits>
+#include <unordered_map>
 
 namespace GeometryLib {
 
 
+enum class ShapeKind { CIRCLE, RECTANGLE, TRIANGLE, OTHER };
+
+
+struct BoundingBox {
+    double minX, minY, maxX, maxY;
+    
+    bool intersects(const BoundingBox& other) const {
+        return minX <= other.maxX && other.minX <= maxX &&
+               minY <= other.maxY && other.minY <= maxY;
+    }
+    
+    bool contains(double x, double y) const {
+        return x >= minX && x <= maxX && y >= minY && y <= maxY;
+    }
+    
+    BoundingBox translated(double dx, double dy) const {
+        return {minX + dx, minY + dy, maxX + dx, maxY + dy};
+    }
+};
+
+class Shape;
+
+class ShapeObserver {
+public:
+    virtual ~ShapeObserver() = default;
+    virtual void onGeometryChanged(const Shape& shape) = 0;
+    virtual void onPositionChanged(const Shape& shape) = 0;
+};
+
+
 class Shape {
 protected:
     std::string name_;
     double x_, y_; 
+    ShapeKind kind_ = ShapeKind::OTHER;
+    ShapeObserver* observer_ = nullptr;
+    
+    Shape(ShapeKind kind, const std::string& name, double x, double y)
+        : name_(name), x_(x), y_(y), kind_(kind) {}
+    
+    void notifyGeometryChanged() {
+        if (observer_) {
+            observer_->onGeometryChanged(*this);
+        }
+    }
+    
+    void notifyPositionChanged() {
+        if (observer_) {
+            observer_->onPositionChanged(*this);
+        }
+    }
     
 public:
     Shape(const std::string& name, double x = 0.0, double y = 0.0)
@@ -21,6 +74,9 @@ public:
     
     virtual ~Shape() = default;
     
+    ShapeKind kind() const { return kind_; }
+    void setObserver(ShapeObserver* observer) { observer_ = observer; }
+    
     
     virtual double area() const = 0;
     virtual double perimeter() const = 0;
@@ -28,18 +84,37 @@ public:
     virtual std::unique_ptr<Shape> clone() const = 0;
     
     
+    virtual BoundingBox bounds() const {
+        return {x_, y_, x_, y_};
+    }
+    
+    
     virtual void move(double dx, double dy) {
         x_ += dx;
         y_ += dy;
+        notifyPositionChanged();
         std::cout << name_ << " moved by (" << dx << ", " << dy << ")\n";
     }
     
     virtual void setPosition(double x, double y) {
         x_ = x;
         y_ = y;
+        notifyPositionChanged();
         std::cout << name_ << " positioned at (" << x << ", " << y << ")\n";
     }
     
+    void translate(double dx, double dy) {
+        x_ += dx;
+        y_ += dy;
+        notifyPositionChanged();
+    }
+    
+    void placeAt(double x, double y) {
+        x_ = x;
+        y_ = y;
+        notifyPositionChanged();
+    }
+    
     
     std::string getName() const { return name_; }
     double getX() const { return x_; }
@@ -62,7 +137,7 @@ private:
     
 public:
     Circle(double radius, double x = 0.0, double y = 0.0)
-        : Shape("Circle", x, y), radius_(radius) {
+        : Shape(ShapeKind::CIRCLE, "Circle", x, y), radius_(radius) {
         if (radius <= 0) {
             throw std::invalid_argument("Circle radius must be positive");
         }
@@ -85,6 +160,10 @@ public:
         return std::make_unique<Circle>(radius_, x_, y_);
     }
     
+    BoundingBox bounds() const override {
+        return {x_ - radius_, y_ - radius_, x_ + radius_, y_ + radius_};
+    }
+    
     
     double getRadius() const { return radius_; }
     void setRadius(double radius) {
@@ -92,6 +171,7 @@ public:
             throw std::invalid_argument("Circle radius must be positive");
         }
         radius_ = radius;
+        notifyGeometryChanged();
     }
     
     double getDiameter() const { return 2 * radius_; }
@@ -104,7 +184,7 @@ private:
     
 public:
     Rectangle(double width, double height, double x = 0.0, double y = 0.0)
-        : Shape("Rectangle", x, y), width_(width), height_(height) {
+        : Shape(ShapeKind::RECTANGLE, "Rectangle", x, y), width_(width), height_(height) {
         if (width <= 0 || height <= 0) {
             throw std::invalid_argument("Rectangle dimensions must be positive");
         }
@@ -127,6 +207,10 @@ public:
         return std::make_unique<Rectangle>(width_, height_, x_, y_);
     }
     
+    BoundingBox bounds() const override {
+        return {x_, y_, x_ + width_, y_ + height_};
+    }
+    
     
     double getWidth() const { return width_; }
     double getHeight() const { return height_; }
@@ -137,6 +221,7 @@ public:
         }
         width_ = width;
         height_ = height;
+        notifyGeometryChanged();
     }
     
     bool isSquare() const {
@@ -155,7 +240,7 @@ private:
     
 public:
     Triangle(double side1, double side2, double side3, double x = 0.0, double y = 0.0)
-        : Shape("Triangle", x, y), side1_(side1), side2_(side2), side3_(side3) {
+        : Shape(ShapeKind::TRIANGLE, "Triangle", x, y), side1_(side1), side2_(side2), side3_(side3) {
         if (side1 <= 0 || side2 <= 0 || side3 <= 0) {
             throw std::invalid_argument("Triangle sides must be positive");
         }
@@ -183,6 +268,14 @@ public:
         return std::make_unique<Triangle>(side1_, side2_, side3_, x_, y_);
     }
     
+    // The triangle is placed with side1 running along the x axis from
+    // (x, y); side3 joins (x, y) to the apex and side2 closes the shape.
+    BoundingBox bounds() const override {
+        double apexX = (side1_ * side1_ + side3_ * side3_ - side2_ * side2_) / (2 * side1_);
+        double apexY = std::sqrt(std::max(0.0, side3_ * side3_ - apexX * apexX));
+        return {x_ + std::min(0.0, apexX), y_, x_ + std::max(side1_, apexX), y_ + apexY};
+    }
+    
     
     bool isEquilateral() const {
         return std::abs(side1_ - side2_) < 1e-9 && std::abs(side2_ - side3_) < 1e-9;
@@ -199,25 +292,392 @@ public:
         std::sort(sides.begin(), sides.end());
         return std::abs(sides[0]*sides[0] + sides[1]*sides[1] - sides[2]*sides[2]) < 1e-9;
     }
+    
+    double getSide1() const { return side1_; }
+    double getSide2() const { return side2_; }
+    double getSide3() const { return side3_; }
 };
 
 
-class ShapeGroup {
+class SpatialGrid {
 private:
+    struct Entry {
+        Shape* shape = nullptr;
+        BoundingBox box{};
+        int cellMinX = 0, cellMinY = 0, cellMaxX = -1, cellMaxY = -1;
+        bool oversized = false;
+        mutable uint64_t queryStamp = 0;
+    };
+    
+    // Shapes covering more cells than this live in one shared list that
+    // every query checks, instead of being copied into each cell.
+    static constexpr double kMaxCellsPerEntry = 64;
+    
+    double cellSize_;
+    double offsetX_ = 0.0, offsetY_ = 0.0;
+    std::vector<Entry> entries_;
+    std::vector<uint32_t> freeEntries_;
+    std::unordered_map<const Shape*, uint32_t> entryIds_;
+    std::unordered_map<int64_t, std::vector<uint32_t>> cells_;
+    std::vector<uint32_t> oversized_;
+    mutable uint64_t queryCounter_ = 0;
+    
+    static int64_t cellKey(int cx, int cy) {
+        return static_cast<int64_t>((static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) |
+                                    static_cast<uint32_t>(cy));
+    }
+    
+    int cellCoord(double v) const {
+        double c = std::floor(v / cellSize_);
+        c = std::max(c, static_cast<double>(std::numeric_limits<int>::min()));
+        c = std::min(c, static_cast<double>(std::numeric_limits<int>::max()));
+        return static_cast<int>(c);
+    }
+    
+    static double cellSpan(int minX, int minY, int maxX, int maxY) {
+        return (static_cast<double>(maxX) - minX + 1) * (static_cast<double>(maxY) - minY + 1);
+    }
+    
+    static void eraseId(std::vector<uint32_t>& ids, uint32_t id) {
+        auto pos = std::find(ids.begin(), ids.end(), id);
+        if (pos != ids.end()) {
+            *pos = ids.back();
+            ids.pop_back();
+        }
+    }
+    
+    void link(uint32_t id) {
+        Entry& e = entries_[id];
+        e.cellMinX = cellCoord(e.box.minX);
+        e.cellMinY = cellCoord(e.box.minY);
+        e.cellMaxX = cellCoord(e.box.maxX);
+        e.cellMaxY = cellCoord(e.box.maxY);
+        e.oversized = cellSpan(e.cellMinX, e.cellMinY, e.cellMaxX, e.cellMaxY) > kMaxCellsPerEntry;
+        if (e.oversized) {
+            oversized_.push_back(id);
+            return;
+        }
+        for (int64_t cx = e.cellMinX; cx <= e.cellMaxX; ++cx) {
+            for (int64_t cy = e.cellMinY; cy <= e.cellMaxY; ++cy) {
+                cells_[cellKey(static_cast<int>(cx), static_cast<int>(cy))].push_back(id);
+            }
+        }
+    }
+    
+    void unlink(uint32_t id) {
+        const Entry& e = entries_[id];
+        if (e.oversized) {
+            eraseId(oversized_, id);
+            return;
+        }
+        for (int64_t cx = e.cellMinX; cx <= e.cellMaxX; ++cx) {
+            for (int64_t cy = e.cellMinY; cy <= e.cellMaxY; ++cy) {
+                auto it = cells_.find(cellKey(static_cast<int>(cx), static_cast<int>(cy)));
+                if (it == cells_.end()) {
+                    continue;
+                }
+                auto& ids = it->second;
+                eraseId(ids, id);
+                if (ids.empty()) {
+                    cells_.erase(it);
+                }
+            }
+        }
+    }
+    
+    // Boxes are stored relative to a grid-wide offset so translating every
+    // shape at once is O(1) for the index.
+    BoundingBox localBounds(const Shape& shape) const {
+        return shape.bounds().translated(-offsetX_, -offsetY_);
+    }
+    
+public:
+    explicit SpatialGrid(double cellSize) : cellSize_(cellSize) {
+        if (cellSize <= 0) {
+            throw std::invalid_argument("Spatial grid cell size must be positive");
+        }
+    }
+    
+    double getCellSize() const { return cellSize_; }
+    size_t size() const { return entryIds_.size(); }
+    size_t cellCount() const { return cells_.size(); }
+    
+    void insert(Shape* shape) {
+        if (!shape || entryIds_.count(shape)) {
+            return;
+        }
+        uint32_t id;
+        if (!freeEntries_.empty()) {
+            id = freeEntries_.back();
+            freeEntries_.pop_back();
+        } else {
+            id = static_cast<uint32_t>(entries_.size());
+            entries_.emplace_back();
+        }
+        Entry& e = entries_[id];
+        e.shape = shape;
+        e.box = localBounds(*shape);
+        e.queryStamp = 0;
+        entryIds_.emplace(shape, id);
+        link(id);
+    }
+    
+    void remove(const Shape* shape) {
+        auto it = entryIds_.find(shape);
+        if (it == entryIds_.end()) {
+            return;
+        }
+        uint32_t id = it->second;
+        unlink(id);
+        entries_[id].shape = nullptr;
+        freeEntries_.push_back(id);
+        entryIds_.erase(it);
+    }
+    
+    void update(const Shape* shape) {
+        auto it = entryIds_.find(shape);
+        if (it == entryIds_.end()) {
+            return;
+        }
+        uint32_t id = it->second;
+        Entry& e = entries_[id];
+        e.box = localBounds(*shape);
+        if (cellCoord(e.box.minX) == e.cellMinX && cellCoord(e.box.minY) == e.cellMinY &&
+            cellCoord(e.box.maxX) == e.cellMaxX && cellCoord(e.box.maxY) == e.cellMaxY) {
+            return;
+        }
+        unlink(id);
+        link(id);
+    }
+    
+    void translateAll(double dx, double dy) {
+        offsetX_ += dx;
+        offsetY_ += dy;
+    }
+    
+    void clear() {
+        entries_.clear();
+        freeEntries_.clear();
+        entryIds_.clear();
+        cells_.clear();
+        oversized_.clear();
+        offsetX_ = offsetY_ = 0.0;
+    }
+    
+    std::vector<Shape*> query(const BoundingBox& region) const {
+        std::vector<Shape*> result;
+        BoundingBox local = region.translated(-offsetX_, -offsetY_);
+        uint64_t stamp = ++queryCounter_;
+        
+        int minX = cellCoord(local.minX), maxX = cellCoord(local.maxX);
+        int minY = cellCoord(local.minY), maxY = cellCoord(local.maxY);
+        
+        // Regions covering more cells than are occupied are cheaper to
+        // answer by walking the occupied cells directly.
+        auto visit = [&](const std::vector<uint32_t>& ids) {
+            for (uint32_t id : ids) {
+                const Entry& e = entries_[id];
+                if (e.queryStamp != stamp) {
+                    e.queryStamp = stamp;
+                    if (e.box.intersects(local)) {
+                        result.push_back(e.shape);
+                    }
+                }
+            }
+        };
+        
+        visit(oversized_);
+        if (cellSpan(minX, minY, maxX, maxY) > static_cast<double>(cells_.size())) {
+            for (const auto& cell : cells_) {
+                visit(cell.second);
+            }
+        } else {
+            for (int64_t cx = minX; cx <= maxX; ++cx) {
+                for (int64_t cy = minY; cy <= maxY; ++cy) {
+                    auto it = cells_.find(cellKey(static_cast<int>(cx), static_cast<int>(cy)));
+                    if (it != cells_.end()) {
+                        visit(it->second);
+                    }
+                }
+            }
+        }
+        return result;
+    }
+};
+
+
+class ShapeGroup : public ShapeObserver {
+public:
+    enum class StorageMode { POLYMORPHIC, TYPE_PARTITIONED };
+    
+private:
+    struct TypePartition {
+        std::vector<double> circleRadius;
+        std::vector<uint32_t> circleSlot;
+        std::vector<double> rectWidth, rectHeight;
+        std::vector<uint32_t> rectSlot;
+        std::vector<double> triSide1, triSide2, triSide3;
+        std::vector<uint32_t> triSlot;
+        std::vector<uint32_t> otherSlot;
+        
+        void clear() {
+            circleRadius.clear();
+            circleSlot.clear();
+            rectWidth.clear();
+            rectHeight.clear();
+            rectSlot.clear();
+            triSide1.clear();
+            triSide2.clear();
+            triSide3.clear();
+            triSlot.clear();
+            otherSlot.clear();
+        }
+    };
+    
     std::vector<std::unique_ptr<Shape>> shapes_;
     std::string groupName_;
+    StorageMode storageMode_ = StorageMode::POLYMORPHIC;
+    mutable TypePartition partition_;
+    mutable bool partitionDirty_ = true;
+    std::unique_ptr<SpatialGrid> spatialIndex_;
+    bool bulkUpdate_ = false;
+    
+    void attachShapes() {
+        for (auto& shape : shapes_) {
+            shape->setObserver(this);
+        }
+    }
+    
+    void detachShapes() {
+        for (auto& shape : shapes_) {
+            shape->setObserver(nullptr);
+        }
+    }
+    
+    const TypePartition& partition() const {
+        if (!partitionDirty_) {
+            return partition_;
+        }
+        
+        partition_.clear();
+        for (size_t i = 0; i < shapes_.size(); ++i) {
+            const Shape* shape = shapes_[i].get();
+            uint32_t slot = static_cast<uint32_t>(i);
+            switch (shape->kind()) {
+                case ShapeKind::CIRCLE: {
+                    const auto* circle = static_cast<const Circle*>(shape);
+                    partition_.circleRadius.push_back(circle->getRadius());
+                    partition_.circleSlot.push_back(slot);
+                    break;
+                }
+                case ShapeKind::RECTANGLE: {
+                    const auto* rect = static_cast<const Rectangle*>(shape);
+                    partition_.rectWidth.push_back(rect->getWidth());
+                    partition_.rectHeight.push_back(rect->getHeight());
+                    partition_.rectSlot.push_back(slot);
+                    break;
+                }
+                case ShapeKind::TRIANGLE: {
+                    const auto* tri = static_cast<const Triangle*>(shape);
+                    partition_.triSide1.push_back(tri->getSide1());
+                    partition_.triSide2.push_back(tri->getSide2());
+                    partition_.triSide3.push_back(tri->getSide3());
+                    partition_.triSlot.push_back(slot);
+                    break;
+                }
+                default:
+                    partition_.otherSlot.push_back(slot);
+                    break;
+            }
+        }
+        partitionDirty_ = false;
+        return partition_;
+    }
+    
+    // The per-type kernels below repeat the exact expressions used by each
+    // shape's area(), so filters give the same answer in either storage mode.
+    static double circleArea(double r) { return M_PI * r * r; }
+    static double triangleArea(double a, double b, double c) {
+        double s = (a + b + c) / 2.0;
+        return std::sqrt(s * (s - a) * (s - b) * (s - c));
+    }
+    
+    static double sumCircleAreas(const TypePartition& p) {
+        const double* r = p.circleRadius.data();
+        size_t n = p.circleRadius.size();
+        double total = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            total += r[i] * r[i];
+        }
+        return M_PI * total;
+    }
+    
+    static double sumRectangleAreas(const TypePartition& p) {
+        const double* w = p.rectWidth.data();
+        const double* h = p.rectHeight.data();
+        size_t n = p.rectWidth.size();
+        double total = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            total += w[i] * h[i];
+        }
+        return total;
+    }
+    
+    static double sumTriangleAreas(const TypePartition& p) {
+        const double* a = p.triSide1.data();
+        const double* b = p.triSide2.data();
+        const double* c = p.triSide3.data();
+        size_t n = p.triSide1.size();
+        double total = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            total += triangleArea(a[i], b[i], c[i]);
+        }
+        return total;
+    }
+    
+    static double sumValues(const std::vector<double>& values) {
+        const double* v = values.data();
+        size_t n = values.size();
+        double total = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            total += v[i];
+        }
+        return total;
+    }
+    
+    template<typename AreaFn>
+    static void collectSlots(size_t n, AreaFn area, const std::vector<uint32_t>& slots,
+                             double minArea, std::vector<uint32_t>& out) {
+        for (size_t i = 0; i < n; ++i) {
+            if (area(i) >= minArea) {
+                out.push_back(slots[i]);
+            }
+        }
+    }
     
 public:
     explicit ShapeGroup(const std::string& name) : groupName_(name) {}
     
     
     ShapeGroup(ShapeGroup&& other) noexcept 
-        : shapes_(std::move(other.shapes_)), groupName_(std::move(other.groupName_)) {}
+        : shapes_(std::move(other.shapes_)), groupName_(std::move(other.groupName_)),
+          storageMode_(other.storageMode_), spatialIndex_(std::move(other.spatialIndex_)) {
+        other.partition_.clear();
+        other.partitionDirty_ = true;
+        attachShapes();
+    }
     
     ShapeGroup& operator=(ShapeGroup&& other) noexcept {
         if (this != &other) {
+            detachShapes();
             shapes_ = std::move(other.shapes_);
             groupName_ = std::move(other.groupName_);
+            storageMode_ = other.storageMode_;
+            spatialIndex_ = std::move(other.spatialIndex_);
+            partitionDirty_ = true;
+            other.partition_.clear();
+            other.partitionDirty_ = true;
+            attachShapes();
         }
         return *this;
     }
@@ -226,21 +686,97 @@ public:
     ShapeGroup(const ShapeGroup&) = delete;
     ShapeGroup& operator=(const ShapeGroup&) = delete;
     
+    void onGeometryChanged(const Shape& shape) override {
+        partitionDirty_ = true;
+        if (spatialIndex_) {
+            spatialIndex_->update(&shape);
+        }
+    }
+    
+    void onPositionChanged(const Shape& shape) override {
+        if (spatialIndex_ && !bulkUpdate_) {
+            spatialIndex_->update(&shape);
+        }
+    }
+    
+    void enableSpatialIndex(double cellSize) {
+        spatialIndex_ = std::make_unique<SpatialGrid>(cellSize);
+        for (auto& shape : shapes_) {
+            spatialIndex_->insert(shape.get());
+        }
+    }
+    
+    void disableSpatialIndex() {
+        spatialIndex_.reset();
+    }
+    
+    bool hasSpatialIndex() const { return spatialIndex_ != nullptr; }
+    
+    void setStorageMode(StorageMode mode) {
+        storageMode_ = mode;
+        if (mode == StorageMode::POLYMORPHIC) {
+            partition_ = TypePartition();
+        }
+        partitionDirty_ = true;
+    }
+    
+    StorageMode getStorageMode() const { return storageMode_; }
+    
+    void reserve(size_t count) {
+        shapes_.reserve(count);
+    }
+    
     void addShape(std::unique_ptr<Shape> shape) {
         if (shape) {
+            shape->setObserver(this);
+            if (spatialIndex_) {
+                spatialIndex_->insert(shape.get());
+            }
             shapes_.push_back(std::move(shape));
+            partitionDirty_ = true;
             std::cout << "Added " << shapes_.back()->getName() << " to group " << groupName_ << "\n";
         }
     }
     
+    void addShapes(std::vector<std::unique_ptr<Shape>> shapes) {
+        size_t added = 0;
+        shapes_.reserve(shapes_.size() + shapes.size());
+        for (auto& shape : shapes) {
+            if (shape) {
+                shape->setObserver(this);
+                if (spatialIndex_) {
+                    spatialIndex_->insert(shape.get());
+                }
+                shapes_.push_back(std::move(shape));
+                ++added;
+            }
+        }
+        partitionDirty_ = true;
+        std::cout << "Added " << added << " shapes to group " << groupName_ << "\n";
+    }
+    
     void removeShape(size_t index) {
         if (index < shapes_.size()) {
             std::cout << "Removed " << shapes_[index]->getName() << " from group " << groupName_ << "\n";
+            shapes_[index]->setObserver(nullptr);
+            if (spatialIndex_) {
+                spatialIndex_->remove(shapes_[index].get());
+            }
             shapes_.erase(shapes_.begin() + index);
+            partitionDirty_ = true;
         }
     }
     
     double getTotalArea() const {
+        if (storageMode_ == StorageMode::TYPE_PARTITIONED) {
+            const auto& p = partition();
+            double total = sumCircleAreas(p) + sumRectangleAreas(p) + sumTriangleAreas(p);
+            for (uint32_t slot : p.otherSlot) {
+                total += shapes_[slot]->area();
+            }
+            return total;
+        }
+        
         double total = 0.0;
         for (const auto& shape : shapes_) {
             total += shape->area();
@@ -249,6 +785,17 @@ public:
     }
     
     double getTotalPerimeter() const {
+        if (storageMode_ == StorageMode::TYPE_PARTITIONED) {
+            const auto& p = partition();
+            double total = 2 * M_PI * sumValues(p.circleRadius)
+                         + 2 * (sumValues(p.rectWidth) + sumValues(p.rectHeight))
+                         + sumValues(p.triSide1) + sumValues(p.triSide2) + sumValues(p.triSide3);
+            for (uint32_t slot : p.otherSlot) {
+                total += shapes_[slot]->perimeter();
+            }
+            return total;
+        }
+        
         double total = 0.0;
         for (const auto& shape : shapes_) {
             total += shape->perimeter();
@@ -271,6 +818,68 @@ public:
         }
     }
     
+    void translateAll(double dx, double dy) {
+        bulkUpdate_ = true;
+        for (auto& shape : shapes_) {
+            shape->translate(dx, dy);
+        }
+        bulkUpdate_ = false;
+        if (spatialIndex_) {
+            spatialIndex_->translateAll(dx, dy);
+        }
+    }
+    
+    template<typename PositionFn>
+    void transformPositions(PositionFn&& fn) {
+        bulkUpdate_ = true;
+        for (auto& shape : shapes_) {
+            auto [x, y] = fn(shape->getX(), shape->getY());
+            shape->placeAt(x, y);
+        }
+        bulkUpdate_ = false;
+        if (spatialIndex_) {
+            enableSpatialIndex(spatialIndex_->getCellSize());
+        }
+    }
+    
+    std::vector<Shape*> findShapesInRegion(const BoundingBox& region) const {
+        if (spatialIndex_) {
+            return spatialIndex_->query(region);
+        }
+        std::vector<Shape*> result;
+        for (const auto& shape : shapes_) {
+            if (shape->bounds().intersects(region)) {
+                result.push_back(shape.get());
+            }
+        }
+        return result;
+    }
+    
+    // Hit test against bounding boxes; the exact outline is not checked.
+    std::vector<Shape*> findShapesAtPoint(double x, double y) const {
+        return findShapesInRegion({x, y, x, y});
+    }
+    
+    void countByKind(size_t& circles, size_t& rectangles, size_t& triangles) const {
+        if (storageMode_ == StorageMode::TYPE_PARTITIONED) {
+            const auto& p = partition();
+            circles = p.circleSlot.size();
+            rectangles = p.rectSlot.size();
+            triangles = p.triSlot.size();
+            return;
+        }
+        
+        circles = rectangles = triangles = 0;
+        for (const auto& shape : shapes_) {
+            switch (shape->kind()) {
+                case ShapeKind::CIRCLE: circles++; break;
+                case ShapeKind::RECTANGLE: rectangles++; break;
+                case ShapeKind::TRIANGLE: triangles++; break;
+                default: break;
+            }
+        }
+    }
+    
     void printStatistics() const {
         std::cout << "\n=== Group Statistics: " << groupName_ << " ===\n";
         std::cout << "Number of shapes: " << shapes_.size() << "\n";
@@ -278,12 +887,8 @@ public:
         std::cout << "Total perimeter: " << getTotalPerimeter() << "\n";
         
         
-        int circles = 0, rectangles = 0, triangles = 0;
-        for (const auto& shape : shapes_) {
-            if (dynamic_cast<const Circle*>(shape.get())) circles++;
-            else if (dynamic_cast<const Rectangle*>(shape.get())) rectangles++;
-            else if (dynamic_cast<const Triangle*>(shape.get())) triangles++;
-        }
+        size_t circles = 0, rectangles = 0, triangles = 0;
+        countByKind(circles, rectangles, triangles);
         
         std::cout << "Shape distribution: " << circles << " circles, " 
                   << rectangles << " rectangles, " << triangles << " triangles\n";
@@ -293,6 +898,41 @@ public:
     
     std::vector<Shape*> findShapesByMinArea(double minArea) const {
         std::vector<Shape*> result;
+        
+        if (storageMode_ == StorageMode::TYPE_PARTITIONED) {
+            const auto& p = partition();
+            std::vector<uint32_t> slots;
+            
+            const double* r = p.circleRadius.data();
+            collectSlots(p.circleRadius.size(), [r](size_t i) { return circleArea(r[i]); },
+                         p.circleSlot, minArea, slots);
+            
+            const double* w = p.rectWidth.data();
+            const double* h = p.rectHeight.data();
+            collectSlots(p.rectWidth.size(), [w, h](size_t i) { return w[i] * h[i]; },
+                         p.rectSlot, minArea, slots);
+            
+            const double* a = p.triSide1.data();
+            const double* b = p.triSide2.data();
+            const double* c = p.triSide3.data();
+            collectSlots(p.triSide1.size(), [a, b, c](size_t i) { return triangleArea(a[i], b[i], c[i]); },
+                         p.triSlot, minArea, slots);
+            
+            for (uint32_t slot : p.otherSlot) {
+                if (shapes_[slot]->area() >= minArea) {
+                    slots.push_back(slot);
+                }
+            }
+            
+            // Callers see shapes in insertion order regardless of storage mode.
+            std::sort(slots.begin(), slots.end());
+            result.reserve(slots.size());
+            for (uint32_t slot : slots) {
+                result.push_back(shapes_[slot].get());
+            }
+            return result;
+        }
+        
         for (const auto& shape : shapes_) {
             if (shape->area() >= minArea) {
                 result.push_back(shape.get());
@@ -315,6 +955,10 @@ public:
     
     std::unique_ptr<ShapeGroup> clone() const {
         auto newGroup = std::make_unique<ShapeGroup>(groupName_ + "_copy");
+        newGroup->setStorageMode(storageMode_);
+        if (spatialIndex_) {
+            newGroup->enableSpatialIndex(spatialIndex_->getCellSize());
+        }
         for (const auto& shape : shapes_) {
             newGroup->addShape(shape->clone());
         }
@@ -444,11 +1088,114 @@ void demonstrateGeometryLibrary() {
     std::cout << "\n=== Demonstration Complete ===\n";
 }
 
+void benchmarkStorageModes(size_t count) {
+    using namespace GeometryLib;
+    using Clock = std::chrono::steady_clock;
+    
+    std::cout << "\n=== Storage Mode Benchmark (" << count << " shapes) ===\n";
+    
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> size_dist(1.0, 10.0);
+    std::uniform_int_distribution<int> kind_dist(0, 2);
+    
+    std::vector<std::unique_ptr<Shape>> shapes;
+    shapes.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        double a = size_dist(rng);
+        switch (kind_dist(rng)) {
+            case 0:
+                shapes.push_back(std::make_unique<Circle>(a));
+                break;
+            case 1:
+                shapes.push_back(std::make_unique<Rectangle>(a, size_dist(rng)));
+                break;
+            default:
+                shapes.push_back(std::make_unique<Triangle>(a, a, a));
+                break;
+        }
+    }
+    
+    ShapeGroup group("Benchmark");
+    group.addShapes(std::move(shapes));
+    
+    auto run = [&group](const char* label) {
+        auto start = Clock::now();
+        double area = group.getTotalArea();
+        double perimeter = group.getTotalPerimeter();
+        size_t circles = 0, rectangles = 0, triangles = 0;
+        group.countByKind(circles, rectangles, triangles);
+        size_t large = group.findShapesByMinArea(50.0).size();
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        
+        std::cout << std::fixed << std::setprecision(2)
+                  << label << ": area " << area << ", perimeter " << perimeter
+                  << ", " << circles << "/" << rectangles << "/" << triangles
+                  << " c/r/t, " << large << " with area >= 50 in " << ms << " ms\n";
+    };
+    
+    run("polymorphic     ");
+    group.setStorageMode(ShapeGroup::StorageMode::TYPE_PARTITIONED);
+    run("partitioned cold");
+    run("partitioned warm");
+}
+
+void benchmarkSpatialQueries(size_t count) {
+    using namespace GeometryLib;
+    using Clock = std::chrono::steady_clock;
+    
+    std::cout << "\n=== Spatial Index Benchmark (" << count << " shapes) ===\n";
+    
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> pos_dist(0.0, 10000.0);
+    std::uniform_real_distribution<double> size_dist(1.0, 10.0);
+    
+    std::vector<std::unique_ptr<Shape>> shapes;
+    shapes.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        double x = pos_dist(rng), y = pos_dist(rng);
+        if (i % 2 == 0) {
+            shapes.push_back(std::make_unique<Circle>(size_dist(rng), x, y));
+        } else {
+            shapes.push_back(std::make_unique<Rectangle>(size_dist(rng), size_dist(rng), x, y));
+        }
+    }
+    
+    ShapeGroup group("SpatialBenchmark");
+    group.addShapes(std::move(shapes));
+    
+    const int queries = 200;
+    auto runQueries = [&](const char* label) {
+        std::mt19937 query_rng(99);
+        size_t hits = 0;
+        auto start = Clock::now();
+        for (int q = 0; q < queries; ++q) {
+            double x = pos_dist(query_rng), y = pos_dist(query_rng);
+            hits += group.findShapesInRegion({x, y, x + 100.0, y + 100.0}).size();
+            hits += group.findShapesAtPoint(x, y).size();
+        }
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        std::cout << std::fixed << std::setprecision(2) << label << ": " << hits
+                  << " hits for " << queries << " region+point queries in " << ms << " ms\n";
+    };
+    
+    runQueries("linear scan ");
+    group.enableSpatialIndex(50.0);
+    runQueries("grid index  ");
+    
+    auto start = Clock::now();
+    group.translateAll(25.0, -25.0);
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << "translateAll without logging: " << ms << " ms\n";
+    runQueries("grid (moved)");
+}
+
 int main() {
     std::cout << "C++ Object-Oriented Programming Demo\n";
     std::cout << "====================================\n\n";
     
     demonstrateGeometryLibrary();
+    benchmarkStorageModes(500000);
+    benchmarkSpatialQueries(200000);
     
     return 0;
 } 
\ No newline at end of file
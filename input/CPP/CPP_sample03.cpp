@@ -9,6 +9,18 @@
 #include <iomanip>
 #include <sstream>
 #include <functional>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <numeric>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <queue>
+#include <future>
+#include <exception>
+#include <array>
 
 namespace GraphicsEngine {
 
@@ -91,40 +103,202 @@ struct Rectangle {
 };
 
 
+template<typename T, size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+    
+    template<typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+    
+    AlignedAllocator() = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+    
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    
+    void deallocate(T* p, size_t) {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+    
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+
 class Canvas {
+public:
+    static constexpr size_t kRowAlignment = 64;
+    
 private:
-    std::vector<std::vector<Color>> pixels_;
+    std::vector<Color, AlignedAllocator<Color, kRowAlignment>> pixels_;
+    Color* data_;
     int width_, height_;
+    int stride_;
     Color background_color_;
+    int clip_x0_, clip_y0_, clip_x1_, clip_y1_;
+    bool owning_;
+    
+    static int aligned_stride(int width) {
+        constexpr int pixels_per_line = static_cast<int>(kRowAlignment / sizeof(Color));
+        return (std::max(width, 0) + pixels_per_line - 1) / pixels_per_line * pixels_per_line;
+    }
+    
+    static void fill_pixels(Color* dst, size_t count, const Color& color) {
+        if (color.r == color.g && color.g == color.b && color.b == color.a) {
+            std::memset(static_cast<void*>(dst), color.r, count * sizeof(Color));
+        } else {
+            std::fill_n(dst, count, color);
+        }
+    }
+    
+    static int isqrt(int value) {
+        int root = static_cast<int>(std::sqrt(static_cast<double>(value)));
+        while (root > 0 && root * root > value) --root;
+        while ((root + 1) * (root + 1) <= value) ++root;
+        return root;
+    }
+    
+    template<typename Plot>
+    static void bresenham(int x0, int y0, int x1, int y1, Plot plot) {
+        int dx = std::abs(x1 - x0);
+        int dy = std::abs(y1 - y0);
+        int sx = x0 < x1 ? 1 : -1;
+        int sy = y0 < y1 ? 1 : -1;
+        int err = dx - dy;
+        
+        while (true) {
+            plot(x0, y0);
+            
+            if (x0 == x1 && y0 == y1) break;
+            
+            int e2 = 2 * err;
+            if (e2 > -dy) {
+                err -= dy;
+                x0 += sx;
+            }
+            if (e2 < dx) {
+                err += dx;
+                y0 += sy;
+            }
+        }
+    }
+    
+    bool in_clip(int x, int y) const {
+        return x >= clip_x0_ && x < clip_x1_ && y >= clip_y0_ && y < clip_y1_;
+    }
+    
+    void reset_clip() {
+        clip_x0_ = 0;
+        clip_y0_ = 0;
+        clip_x1_ = std::max(width_, 0);
+        clip_y1_ = std::max(height_, 0);
+    }
+    
+    void rebind() {
+        if (owning_) {
+            data_ = pixels_.data();
+        }
+    }
     
 public:
     Canvas(int width, int height, Color bg = Color::White()) 
-        : width_(width), height_(height), background_color_(bg) {
-        pixels_.resize(height_, std::vector<Color>(width_, bg));
+        : data_(nullptr), width_(width), height_(height), stride_(aligned_stride(width)),
+          background_color_(bg), owning_(true) {
+        pixels_.resize(static_cast<size_t>(stride_) * std::max(height_, 0), bg);
+        rebind();
+        reset_clip();
+    }
+    
+    Canvas(const Canvas& other)
+        : pixels_(other.pixels_), data_(other.data_), width_(other.width_), height_(other.height_),
+          stride_(other.stride_), background_color_(other.background_color_),
+          clip_x0_(other.clip_x0_), clip_y0_(other.clip_y0_), clip_x1_(other.clip_x1_),
+          clip_y1_(other.clip_y1_), owning_(other.owning_) {
+        rebind();
+    }
+    
+    Canvas(Canvas&& other) noexcept
+        : pixels_(std::move(other.pixels_)), data_(other.data_), width_(other.width_), height_(other.height_),
+          stride_(other.stride_), background_color_(other.background_color_),
+          clip_x0_(other.clip_x0_), clip_y0_(other.clip_y0_), clip_x1_(other.clip_x1_),
+          clip_y1_(other.clip_y1_), owning_(other.owning_) {
+        rebind();
+    }
+    
+    Canvas& operator=(Canvas other) noexcept {
+        std::swap(pixels_, other.pixels_);
+        std::swap(data_, other.data_);
+        width_ = other.width_;
+        height_ = other.height_;
+        stride_ = other.stride_;
+        background_color_ = other.background_color_;
+        clip_x0_ = other.clip_x0_;
+        clip_y0_ = other.clip_y0_;
+        clip_x1_ = other.clip_x1_;
+        clip_y1_ = other.clip_y1_;
+        owning_ = other.owning_;
+        rebind();
+        return *this;
+    }
+    
+    // A view shares this canvas's pixels but only draws inside [x0, x1) x
+    // [y0, y1). Coordinates stay canvas-global, so drawables need no offset.
+    // The view must not outlive the canvas it was taken from.
+    Canvas view(int x0, int y0, int x1, int y1) {
+        Canvas result(ViewTag{}, *this);
+        result.clip_x0_ = std::max(x0, clip_x0_);
+        result.clip_y0_ = std::max(y0, clip_y0_);
+        result.clip_x1_ = std::max(result.clip_x0_, std::min(x1, clip_x1_));
+        result.clip_y1_ = std::max(result.clip_y0_, std::min(y1, clip_y1_));
+        return result;
     }
     
     int width() const { return width_; }
     int height() const { return height_; }
+    int stride() const { return stride_; }
+    bool is_view() const { return !owning_; }
+    const Color& background() const { return background_color_; }
+    
+    Color* row(int y) { return data_ + static_cast<size_t>(y) * stride_; }
+    const Color* row(int y) const { return data_ + static_cast<size_t>(y) * stride_; }
     
     void clear() {
-        for (auto& row : pixels_) {
-            std::fill(row.begin(), row.end(), background_color_);
+        if (owning_) {
+            fill_pixels(pixels_.data(), pixels_.size(), background_color_);
+            return;
+        }
+        for (int y = clip_y0_; y < clip_y1_; ++y) {
+            fill_pixels(row(y) + clip_x0_, static_cast<size_t>(clip_x1_ - clip_x0_), background_color_);
         }
     }
     
     void set_pixel(int x, int y, const Color& color) {
-        if (x >= 0 && x < width_ && y >= 0 && y < height_) {
-            pixels_[y][x] = color;
+        if (in_clip(x, y)) {
+            row(y)[x] = color;
         }
     }
     
     Color get_pixel(int x, int y) const {
         if (x >= 0 && x < width_ && y >= 0 && y < height_) {
-            return pixels_[y][x];
+            return row(y)[x];
         }
         return Color::Black();
     }
     
+    // Fills [x_begin, x_end) on row y, clipped to the canvas.
+    void fill_span(int y, int x_begin, int x_end, const Color& color) {
+        if (y < clip_y0_ || y >= clip_y1_) return;
+        x_begin = std::max(x_begin, clip_x0_);
+        x_end = std::min(x_end, clip_x1_);
+        if (x_begin < x_end) {
+            fill_pixels(row(y) + x_begin, static_cast<size_t>(x_end - x_begin), color);
+        }
+    }
+    
     
     void draw_line(Point2D start, Point2D end, const Color& color) {
         int x0 = static_cast<int>(start.x);
@@ -132,26 +306,17 @@ public:
         int x1 = static_cast<int>(end.x);
         int y1 = static_cast<int>(end.y);
         
-        int dx = std::abs(x1 - x0);
-        int dy = std::abs(y1 - y0);
-        int sx = x0 < x1 ? 1 : -1;
-        int sy = y0 < y1 ? 1 : -1;
-        int err = dx - dy;
+        if (y0 == y1) {
+            fill_span(y0, std::min(x0, x1), std::max(x0, x1) + 1, color);
+            return;
+        }
         
-        while (true) {
-            set_pixel(x0, y0, color);
-            
-            if (x0 == x1 && y0 == y1) break;
-            
-            int e2 = 2 * err;
-            if (e2 > -dy) {
-                err -= dy;
-                x0 += sx;
-            }
-            if (e2 < dx) {
-                err += dx;
-                y0 += sy;
-            }
+        bool inside = in_clip(std::min(x0, x1), std::min(y0, y1)) &&
+                      in_clip(std::max(x0, x1), std::max(y0, y1));
+        if (inside) {
+            bresenham(x0, y0, x1, y1, [this, &color](int x, int y) { row(y)[x] = color; });
+        } else {
+            bresenham(x0, y0, x1, y1, [this, &color](int x, int y) { set_pixel(x, y, color); });
         }
     }
     
@@ -159,13 +324,13 @@ public:
         int cx = static_cast<int>(center.x);
         int cy = static_cast<int>(center.y);
         int r = static_cast<int>(radius);
+        if (r < 0) return;
         
-        for (int y = -r; y <= r; ++y) {
-            for (int x = -r; x <= r; ++x) {
-                if (x * x + y * y <= r * r) {
-                    set_pixel(cx + x, cy + y, color);
-                }
-            }
+        int y_begin = std::max(-r, clip_y0_ - cy);
+        int y_end = std::min(r, clip_y1_ - 1 - cy);
+        for (int y = y_begin; y <= y_end; ++y) {
+            int half = isqrt(r * r - y * y);
+            fill_span(cy + y, cx - half, cx + half + 1, color);
         }
     }
     
@@ -175,31 +340,113 @@ public:
         int w = static_cast<int>(rect.width);
         int h = static_cast<int>(rect.height);
         
-        for (int py = y; py < y + h; ++py) {
-            for (int px = x; px < x + w; ++px) {
-                set_pixel(px, py, color);
+        int x_begin = std::max(x, clip_x0_);
+        int x_end = std::min(x + w, clip_x1_);
+        int y_begin = std::max(y, clip_y0_);
+        int y_end = std::min(y + h, clip_y1_);
+        if (x_begin >= x_end) return;
+        
+        for (int py = y_begin; py < y_end; ++py) {
+            fill_pixels(row(py) + x_begin, static_cast<size_t>(x_end - x_begin), color);
+        }
+    }
+    
+    
+    size_t ascii_size() const {
+        return width_ > 0 && height_ > 0 ? static_cast<size_t>(width_ + 1) * height_ : 0;
+    }
+    
+    // Writes ascii_size() bytes, one line per row, into out.
+    void write_ascii(char* out) const {
+        const char* ramp = ascii_ramp();
+        for (int y = 0; y < height_; ++y) {
+            const Color* pixels = row(y);
+            for (int x = 0; x < width_; ++x) {
+                *out++ = ramp[pixels[x].r + pixels[x].g + pixels[x].b];
             }
+            *out++ = '\n';
         }
     }
     
+    // Reuses out's capacity, so a caller streaming frames does not allocate.
+    void to_ascii(std::string& out) const {
+        out.resize(ascii_size());
+        if (!out.empty()) {
+            write_ascii(&out[0]);
+        }
+    }
     
     std::string to_ascii() const {
-        std::ostringstream oss;
-        for (const auto& row : pixels_) {
-            for (const auto& pixel : row) {
-                char intensity = ' ';
-                int gray = (pixel.r + pixel.g + pixel.b) / 3;
-                if (gray > 200) intensity = ' ';
-                else if (gray > 150) intensity = '.';
-                else if (gray > 100) intensity = ':';
-                else if (gray > 50) intensity = '#';
-                else intensity = '@';
-                oss << intensity;
+        std::string out;
+        to_ascii(out);
+        return out;
+    }
+    
+    std::string ppm_header() const {
+        return "P6\n" + std::to_string(std::max(width_, 0)) + " " + std::to_string(std::max(height_, 0)) + "\n255\n";
+    }
+    
+    size_t ppm_size() const {
+        return ppm_header().size() + static_cast<size_t>(std::max(width_, 0)) * std::max(height_, 0) * 3;
+    }
+    
+    // Binary PPM (P6) of the whole canvas; alpha is dropped.
+    void export_ppm(std::vector<uint8_t>& out) const {
+        std::string header = ppm_header();
+        out.resize(ppm_size());
+        std::memcpy(out.data(), header.data(), header.size());
+        
+        uint8_t* dst = out.data() + header.size();
+        for (int y = 0; y < height_; ++y) {
+            const Color* pixels = row(y);
+            for (int x = 0; x < width_; ++x) {
+                dst[0] = pixels[x].r;
+                dst[1] = pixels[x].g;
+                dst[2] = pixels[x].b;
+                dst += 3;
             }
-            oss << '\n';
         }
-        return oss.str();
     }
+    
+    // Tightly packed RGBA rows, without the stride padding.
+    void export_raw_rgba(std::vector<uint8_t>& out) const {
+        static_assert(sizeof(Color) == 4, "Color must be packed RGBA");
+        size_t row_bytes = static_cast<size_t>(std::max(width_, 0)) * sizeof(Color);
+        out.resize(row_bytes * std::max(height_, 0));
+        for (int y = 0; y < height_; ++y) {
+            std::memcpy(out.data() + y * row_bytes, static_cast<const void*>(row(y)), row_bytes);
+        }
+    }
+    
+    void write_ppm(std::ostream& os, std::vector<uint8_t>& scratch) const {
+        export_ppm(scratch);
+        os.write(reinterpret_cast<const char*>(scratch.data()), static_cast<std::streamsize>(scratch.size()));
+    }
+    
+private:
+    struct ViewTag {};
+    
+    // Indexed by r + g + b, so the per-pixel gray division disappears.
+    static const char* ascii_ramp() {
+        static const std::array<char, 3 * 255 + 1> ramp = [] {
+            std::array<char, 3 * 255 + 1> table{};
+            for (size_t sum = 0; sum < table.size(); ++sum) {
+                size_t gray = sum / 3;
+                if (gray > 200) table[sum] = ' ';
+                else if (gray > 150) table[sum] = '.';
+                else if (gray > 100) table[sum] = ':';
+                else if (gray > 50) table[sum] = '#';
+                else table[sum] = '@';
+            }
+            return table;
+        }();
+        return ramp.data();
+    }
+    
+    Canvas(ViewTag, Canvas& parent)
+        : data_(parent.data_), width_(parent.width_), height_(parent.height_), stride_(parent.stride_),
+          background_color_(parent.background_color_), clip_x0_(parent.clip_x0_), clip_y0_(parent.clip_y0_),
+          clip_x1_(parent.clip_x1_), clip_y1_(parent.clip_y1_), owning_(false) {}
 };
 
 
@@ -210,6 +457,20 @@ public:
     virtual Rectangle get_bounds() const = 0;
     virtual void update(double delta_time) {}
     virtual std::unique_ptr<Drawable> clone() const = 0;
+    
+    // Full copy of the current state, used to rasterize a frame while the
+    // live object keeps updating. Stateless drawables can use clone().
+    virtual std::unique_ptr<Drawable> snapshot() const { return clone(); }
+    
+    // Changes whenever the drawn output may differ; the scene compares it to
+    // find regions that need redrawing.
+    uint64_t get_revision() const { return revision_; }
+    
+protected:
+    void mark_changed() { ++revision_; }
+    
+private:
+    uint64_t revision_ = 0;
 };
 
 
@@ -236,7 +497,10 @@ public:
     }
     
     void update(double delta_time) override {
-        center_ = center_ + velocity_ * delta_time;
+        if (velocity_.x != 0 || velocity_.y != 0) {
+            center_ = center_ + velocity_ * delta_time;
+            mark_changed();
+        }
     }
     
     std::unique_ptr<Drawable> clone() const override {
@@ -248,8 +512,8 @@ public:
     void set_velocity(const Point2D& vel) { velocity_ = vel; }
     Point2D get_center() const { return center_; }
     double get_radius() const { return radius_; }
-    void set_center(const Point2D& center) { center_ = center; }
-    void set_color(const Color& color) { color_ = color; }
+    void set_center(const Point2D& center) { center_ = center; mark_changed(); }
+    void set_color(const Color& color) { color_ = color; mark_changed(); }
 };
 
 class RectangleShape : public Drawable {
@@ -271,7 +535,10 @@ public:
     }
     
     void update(double delta_time) override {
-        rect_.position = rect_.position + velocity_ * delta_time;
+        if (velocity_.x != 0 || velocity_.y != 0) {
+            rect_.position = rect_.position + velocity_ * delta_time;
+            mark_changed();
+        }
     }
     
     std::unique_ptr<Drawable> clone() const override {
@@ -282,8 +549,8 @@ public:
     
     void set_velocity(const Point2D& vel) { velocity_ = vel; }
     Point2D get_position() const { return rect_.position; }
-    void set_position(const Point2D& pos) { rect_.position = pos; }
-    void set_color(const Color& color) { color_ = color; }
+    void set_position(const Point2D& pos) { rect_.position = pos; mark_changed(); }
+    void set_color(const Color& color) { color_ = color; mark_changed(); }
 };
 
 
@@ -320,155 +587,718 @@ public:
 };
 
 class ParticleSystem : public Drawable {
+public:
+    static constexpr size_t kDefaultMaxParticles = 10000;
+    
 private:
-    std::vector<Particle> particles_;
+    struct ParticleStore {
+        std::vector<double> pos_x, pos_y;
+        std::vector<double> vel_x, vel_y;
+        std::vector<double> life, inv_max_life;
+        std::vector<uint8_t> red, green, blue, alpha;
+        
+        size_t size() const { return life.size(); }
+        
+        void reserve(size_t n) {
+            pos_x.reserve(n); pos_y.reserve(n);
+            vel_x.reserve(n); vel_y.reserve(n);
+            life.reserve(n); inv_max_life.reserve(n);
+            red.reserve(n); green.reserve(n); blue.reserve(n); alpha.reserve(n);
+        }
+        
+        void resize(size_t n) {
+            pos_x.resize(n); pos_y.resize(n);
+            vel_x.resize(n); vel_y.resize(n);
+            life.resize(n); inv_max_life.resize(n);
+            red.resize(n); green.resize(n); blue.resize(n); alpha.resize(n);
+        }
+        
+        void move_slot(size_t from, size_t to) {
+            pos_x[to] = pos_x[from]; pos_y[to] = pos_y[from];
+            vel_x[to] = vel_x[from]; vel_y[to] = vel_y[from];
+            life[to] = life[from]; inv_max_life[to] = inv_max_life[from];
+            red[to] = red[from]; green[to] = green[from]; blue[to] = blue[from]; alpha[to] = alpha[from];
+        }
+    };
+    
+    ParticleStore store_;
     Point2D emitter_position_;
     double emission_rate_;
     double time_since_emission_;
+    size_t max_particles_;
+    double particle_size_;
     std::mt19937 rng_;
-    
-    void emit_particle() {
-        std::uniform_real_distribution<double> angle_dist(0, 2 * M_PI);
-        std::uniform_real_distribution<double> speed_dist(20, 100);
-        std::uniform_real_distribution<double> life_dist(1.0, 3.0);
+    std::uniform_real_distribution<double> angle_dist_;
+    std::uniform_real_distribution<double> speed_dist_;
+    std::uniform_real_distribution<double> life_dist_;
+    std::uniform_int_distribution<int> red_dist_;
+    std::uniform_int_distribution<int> green_dist_;
+    std::uniform_int_distribution<int> blue_dist_;
+    
+    void emit_particles(size_t count) {
+        count = std::min(count, max_particles_ - std::min(max_particles_, store_.size()));
+        if (count == 0) return;
         
-        double angle = angle_dist(rng_);
-        double speed = speed_dist(rng_);
-        Point2D velocity(std::cos(angle) * speed, std::sin(angle) * speed);
-        
-        Color particle_color = Color(
-            static_cast<uint8_t>(std::uniform_int_distribution<int>(100, 255)(rng_)),
-            static_cast<uint8_t>(std::uniform_int_distribution<int>(50, 150)(rng_)),
-            static_cast<uint8_t>(std::uniform_int_distribution<int>(0, 100)(rng_))
-        );
+        size_t first = store_.size();
+        store_.resize(first + count);
+        for (size_t i = first; i < first + count; ++i) {
+            double angle = angle_dist_(rng_);
+            double speed = speed_dist_(rng_);
+            double life = life_dist_(rng_);
+            
+            store_.pos_x[i] = emitter_position_.x;
+            store_.pos_y[i] = emitter_position_.y;
+            store_.vel_x[i] = std::cos(angle) * speed;
+            store_.vel_y[i] = std::sin(angle) * speed;
+            store_.life[i] = life;
+            store_.inv_max_life[i] = 1.0 / life;
+            store_.red[i] = static_cast<uint8_t>(red_dist_(rng_));
+            store_.green[i] = static_cast<uint8_t>(green_dist_(rng_));
+            store_.blue[i] = static_cast<uint8_t>(blue_dist_(rng_));
+            store_.alpha[i] = 255;
+        }
+    }
+    
+    void integrate(double delta_time) {
+        size_t n = store_.size();
+        double* px = store_.pos_x.data();
+        double* py = store_.pos_y.data();
+        const double* vx = store_.vel_x.data();
+        const double* vy = store_.vel_y.data();
+        double* life = store_.life.data();
+        const double* inv_max = store_.inv_max_life.data();
+        uint8_t* alpha = store_.alpha.data();
         
-        particles_.emplace_back(emitter_position_, velocity, particle_color, life_dist(rng_));
+        for (size_t i = 0; i < n; ++i) {
+            px[i] += vx[i] * delta_time;
+            py[i] += vy[i] * delta_time;
+            life[i] -= delta_time;
+            double a = std::max(life[i] * inv_max[i], 0.0);
+            alpha[i] = static_cast<uint8_t>(255 * a);
+        }
+    }
+    
+    void remove_dead() {
+        size_t n = store_.size();
+        size_t i = 0;
+        while (i < n) {
+            if (store_.life[i] > 0) {
+                ++i;
+                continue;
+            }
+            --n;
+            if (i != n) {
+                store_.move_slot(n, i);
+            }
+        }
+        store_.resize(n);
     }
     
 public:
-    ParticleSystem(Point2D position, double rate = 50.0)
+    ParticleSystem(Point2D position, double rate = 50.0, size_t max_particles = kDefaultMaxParticles)
         : emitter_position_(position), emission_rate_(rate), time_since_emission_(0.0),
-          rng_(std::random_device{}()) {}
+          max_particles_(max_particles), particle_size_(2.0), rng_(std::random_device{}()),
+          angle_dist_(0, 2 * M_PI), speed_dist_(20, 100), life_dist_(1.0, 3.0),
+          red_dist_(100, 255), green_dist_(50, 150), blue_dist_(0, 100) {
+        store_.reserve(std::min(max_particles_, kDefaultMaxParticles));
+    }
     
     void draw(Canvas& canvas) const override {
-        for (const auto& particle : particles_) {
-            particle.draw(canvas);
+        size_t n = store_.size();
+        for (size_t i = 0; i < n; ++i) {
+            canvas.draw_circle(Point2D(store_.pos_x[i], store_.pos_y[i]), particle_size_,
+                               Color(store_.red[i], store_.green[i], store_.blue[i], store_.alpha[i]));
         }
     }
     
     Rectangle get_bounds() const override {
-        if (particles_.empty()) {
+        size_t n = store_.size();
+        if (n == 0) {
             return Rectangle(emitter_position_, 1, 1);
         }
         
-        double min_x = particles_[0].position.x;
-        double max_x = particles_[0].position.x;
-        double min_y = particles_[0].position.y;
-        double max_y = particles_[0].position.y;
+        const double* px = store_.pos_x.data();
+        const double* py = store_.pos_y.data();
+        double min_x = px[0], max_x = px[0];
+        double min_y = py[0], max_y = py[0];
         
-        for (const auto& p : particles_) {
-            min_x = std::min(min_x, p.position.x);
-            max_x = std::max(max_x, p.position.x);
-            min_y = std::min(min_y, p.position.y);
-            max_y = std::max(max_y, p.position.y);
+        for (size_t i = 1; i < n; ++i) {
+            min_x = std::min(min_x, px[i]);
+            max_x = std::max(max_x, px[i]);
+            min_y = std::min(min_y, py[i]);
+            max_y = std::max(max_y, py[i]);
         }
         
-        return Rectangle(Point2D(min_x, min_y), max_x - min_x, max_y - min_y);
+        return Rectangle(Point2D(min_x - particle_size_, min_y - particle_size_),
+                         max_x - min_x + 2 * particle_size_, max_y - min_y + 2 * particle_size_);
     }
     
     void update(double delta_time) override {
-        
-        for (auto& particle : particles_) {
-            particle.update(delta_time);
+        if (store_.size() > 0) {
+            mark_changed();
         }
-        
-        
-        particles_.erase(
-            std::remove_if(particles_.begin(), particles_.end(),
-                [](const Particle& p) { return !p.is_alive(); }),
-            particles_.end()
-        );
+        integrate(delta_time);
+        remove_dead();
         
         
         time_since_emission_ += delta_time;
         double emission_interval = 1.0 / emission_rate_;
         
-        while (time_since_emission_ >= emission_interval) {
-            emit_particle();
-            time_since_emission_ -= emission_interval;
+        if (time_since_emission_ >= emission_interval) {
+            double batches = std::floor(time_since_emission_ / emission_interval);
+            time_since_emission_ -= batches * emission_interval;
+            emit_particles(static_cast<size_t>(std::min(batches, static_cast<double>(max_particles_))));
+            mark_changed();
         }
     }
     
     std::unique_ptr<Drawable> clone() const override {
-        return std::make_unique<ParticleSystem>(emitter_position_, emission_rate_);
+        return std::make_unique<ParticleSystem>(emitter_position_, emission_rate_, max_particles_);
+    }
+    
+    std::unique_ptr<Drawable> snapshot() const override {
+        return std::make_unique<ParticleSystem>(*this);
+    }
+    
+    Particle get_particle(size_t index) const {
+        Particle particle(Point2D(store_.pos_x[index], store_.pos_y[index]),
+                          Point2D(store_.vel_x[index], store_.vel_y[index]),
+                          Color(store_.red[index], store_.green[index], store_.blue[index], store_.alpha[index]),
+                          1.0 / store_.inv_max_life[index]);
+        particle.life_time = store_.life[index];
+        particle.size = particle_size_;
+        return particle;
     }
     
     void set_position(const Point2D& pos) { emitter_position_ = pos; }
-    size_t get_particle_count() const { return particles_.size(); }
+    void set_max_particles(size_t max_particles) {
+        max_particles_ = max_particles;
+        if (store_.size() > max_particles_) {
+            store_.resize(max_particles_);
+            mark_changed();
+        }
+    }
+    size_t get_max_particles() const { return max_particles_; }
+    size_t get_particle_count() const { return store_.size(); }
+};
+
+
+class RenderWorkerPool {
+private:
+    struct Batch {
+        std::atomic<size_t> next{0};
+        size_t count = 0;
+        size_t pending_helpers = 0;
+        std::mutex done_mutex;
+        std::condition_variable done_cv;
+        std::exception_ptr error;
+    };
+    
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    bool stopping_ = false;
+    
+    void worker_loop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex_);
+                queue_cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (stopping_ && tasks_.empty()) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            task();
+        }
+    }
+    
+    template<typename Fn>
+    static void drain(Batch& batch, Fn& fn) {
+        for (;;) {
+            size_t index = batch.next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= batch.count) {
+                return;
+            }
+            try {
+                fn(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(batch.done_mutex);
+                if (!batch.error) {
+                    batch.error = std::current_exception();
+                }
+            }
+        }
+    }
+    
+public:
+    explicit RenderWorkerPool(size_t threads = 0) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (size_t i = 1; i < threads; ++i) {
+            workers_.emplace_back([this] { worker_loop(); });
+        }
+    }
+    
+    ~RenderWorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            stopping_ = true;
+        }
+        queue_cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+    
+    RenderWorkerPool(const RenderWorkerPool&) = delete;
+    RenderWorkerPool& operator=(const RenderWorkerPool&) = delete;
+    
+    size_t thread_count() const { return workers_.size() + 1; }
+    
+    // Runs fn on a pool thread (inline if the pool has no workers). A task
+    // must not call parallel_for() on its own pool: with every worker busy,
+    // the helpers it queues would never start.
+    std::future<void> submit(std::function<void()> fn) {
+        auto task = std::make_shared<std::packaged_task<void()>>(std::move(fn));
+        std::future<void> result = task->get_future();
+        if (workers_.empty()) {
+            (*task)();
+            return result;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            tasks_.push([task] { (*task)(); });
+        }
+        queue_cv_.notify_one();
+        return result;
+    }
+    
+    // Runs fn(0..count-1) across the pool; the calling thread takes part.
+    template<typename Fn>
+    void parallel_for(size_t count, Fn&& fn) {
+        if (count == 0) return;
+        
+        Batch batch;
+        batch.count = count;
+        size_t helpers = std::min(workers_.size(), count - 1);
+        batch.pending_helpers = helpers;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            for (size_t i = 0; i < helpers; ++i) {
+                tasks_.push([&batch, &fn] {
+                    drain(batch, fn);
+                    std::lock_guard<std::mutex> done_lock(batch.done_mutex);
+                    if (--batch.pending_helpers == 0) {
+                        batch.done_cv.notify_one();
+                    }
+                });
+            }
+        }
+        queue_cv_.notify_all();
+        
+        drain(batch, fn);
+        
+        std::unique_lock<std::mutex> lock(batch.done_mutex);
+        batch.done_cv.wait(lock, [&batch] { return batch.pending_helpers == 0; });
+        if (batch.error) {
+            std::rethrow_exception(batch.error);
+        }
+    }
+};
+
+
+class TiledRasterizer {
+private:
+    // get_bounds() is in floating point while rasterization truncates to
+    // integers, so objects are binned with a small safety margin.
+    static constexpr double kBinMargin = 2.0;
+    
+    int tile_size_;
+    RenderWorkerPool pool_;
+    std::vector<std::vector<uint32_t>> bins_;
+    
+public:
+    explicit TiledRasterizer(int tile_size = 64, size_t threads = 0)
+        : tile_size_(std::max(tile_size, 8)), pool_(threads) {}
+    
+    int tile_size() const { return tile_size_; }
+    size_t thread_count() const { return pool_.thread_count(); }
+    
+    void render(const std::vector<const Drawable*>& objects, Canvas& canvas) {
+        int tiles_x = (canvas.width() + tile_size_ - 1) / tile_size_;
+        int tiles_y = (canvas.height() + tile_size_ - 1) / tile_size_;
+        if (tiles_x <= 0 || tiles_y <= 0) return;
+        
+        bins_.resize(static_cast<size_t>(tiles_x) * tiles_y);
+        for (auto& bin : bins_) {
+            bin.clear();
+        }
+        
+        for (size_t i = 0; i < objects.size(); ++i) {
+            Rectangle bounds = objects[i]->get_bounds();
+            double x0 = bounds.position.x - kBinMargin;
+            double y0 = bounds.position.y - kBinMargin;
+            double x1 = bounds.position.x + bounds.width + kBinMargin;
+            double y1 = bounds.position.y + bounds.height + kBinMargin;
+            
+            int tx0 = 0, ty0 = 0, tx1 = tiles_x - 1, ty1 = tiles_y - 1;
+            if (std::isfinite(x0) && std::isfinite(y0) && std::isfinite(x1) && std::isfinite(y1)) {
+                if (x1 < 0 || y1 < 0 || x0 >= canvas.width() || y0 >= canvas.height()) continue;
+                tx0 = std::max(0, static_cast<int>(x0 / tile_size_));
+                ty0 = std::max(0, static_cast<int>(y0 / tile_size_));
+                tx1 = std::min(tiles_x - 1, static_cast<int>(x1 / tile_size_));
+                ty1 = std::min(tiles_y - 1, static_cast<int>(y1 / tile_size_));
+            }
+            
+            for (int ty = ty0; ty <= ty1; ++ty) {
+                for (int tx = tx0; tx <= tx1; ++tx) {
+                    bins_[static_cast<size_t>(ty) * tiles_x + tx].push_back(static_cast<uint32_t>(i));
+                }
+            }
+        }
+        
+        // Each pixel belongs to exactly one tile and every tile draws its
+        // objects in scene order, so the result matches a sequential render.
+        pool_.parallel_for(bins_.size(), [&](size_t tile) {
+            int tx = static_cast<int>(tile % tiles_x);
+            int ty = static_cast<int>(tile / tiles_x);
+            Canvas view = canvas.view(tx * tile_size_, ty * tile_size_,
+                                      (tx + 1) * tile_size_, (ty + 1) * tile_size_);
+            view.clear();
+            for (uint32_t index : bins_[tile]) {
+                objects[index]->draw(view);
+            }
+        });
+    }
 };
 
 
 class Scene {
 private:
+    struct SweepEntry {
+        double min_x, max_x, min_y, max_y;
+        uint32_t slot;
+    };
+    
+    struct DrawnState {
+        Rectangle bounds;
+        uint64_t revision;
+    };
+    
+    struct PixelRect {
+        int x0, y0, x1, y1;
+        
+        bool overlaps(const PixelRect& other) const {
+            return x0 < other.x1 && other.x0 < x1 && y0 < other.y1 && other.y0 < y1;
+        }
+        
+        size_t area() const { return static_cast<size_t>(x1 - x0) * (y1 - y0); }
+    };
+    
+    // Rasterization truncates float coordinates, so dirty regions are grown
+    // a little beyond get_bounds().
+    static constexpr double kDirtyMargin = 2.0;
+    static constexpr size_t kMaxDirtyRects = 64;
+    // Above this many unsorted sweep entries a full sort beats insertion.
+    static constexpr size_t kMaxInsertedPerFrame = 32;
+    
     std::vector<std::unique_ptr<Drawable>> objects_;
     Canvas canvas_;
     std::string name_;
+    std::vector<CircleShape*> collidables_;
+    std::vector<uint32_t> sweep_order_;
+    size_t sweep_sorted_ = 0;  // leading entries of sweep_order_ from the last sort
+    std::vector<SweepEntry> sweep_entries_;
+    std::vector<std::pair<uint32_t, uint32_t>> candidate_pairs_;
+    size_t last_collision_count_ = 0;
+    bool incremental_ = false;
+    bool needs_full_redraw_ = true;
+    std::vector<DrawnState> drawn_;
+    std::vector<Rectangle> pending_dirty_;
+    std::vector<PixelRect> dirty_;
+    size_t last_redrawn_pixels_ = 0;
+    
+    static bool same_bounds(const Rectangle& a, const Rectangle& b) {
+        return a.position.x == b.position.x && a.position.y == b.position.y &&
+               a.width == b.width && a.height == b.height;
+    }
+    
+    bool to_pixel_rect(const Rectangle& bounds, PixelRect& out) const {
+        double x0 = bounds.position.x - kDirtyMargin;
+        double y0 = bounds.position.y - kDirtyMargin;
+        double x1 = bounds.position.x + bounds.width + kDirtyMargin;
+        double y1 = bounds.position.y + bounds.height + kDirtyMargin;
+        if (!std::isfinite(x0) || !std::isfinite(y0) || !std::isfinite(x1) || !std::isfinite(y1)) {
+            return false;
+        }
+        double width = canvas_.width(), height = canvas_.height();
+        out.x0 = static_cast<int>(std::clamp(std::floor(x0), 0.0, width));
+        out.y0 = static_cast<int>(std::clamp(std::floor(y0), 0.0, height));
+        out.x1 = static_cast<int>(std::clamp(std::ceil(x1) + 1, 0.0, width));
+        out.y1 = static_cast<int>(std::clamp(std::ceil(y1) + 1, 0.0, height));
+        return true;
+    }
+    
+    // Merges rect with every dirty rect it overlaps. Returns false when the
+    // region can no longer be tracked and a full redraw is cheaper.
+    bool add_dirty(const Rectangle& bounds) {
+        PixelRect rect;
+        if (!to_pixel_rect(bounds, rect)) return false;
+        if (rect.x0 >= rect.x1 || rect.y0 >= rect.y1) return true;
+        
+        bool merged = true;
+        while (merged) {
+            merged = false;
+            for (size_t i = 0; i < dirty_.size(); ++i) {
+                if (rect.overlaps(dirty_[i])) {
+                    rect.x0 = std::min(rect.x0, dirty_[i].x0);
+                    rect.y0 = std::min(rect.y0, dirty_[i].y0);
+                    rect.x1 = std::max(rect.x1, dirty_[i].x1);
+                    rect.y1 = std::max(rect.y1, dirty_[i].y1);
+                    dirty_[i] = dirty_.back();
+                    dirty_.pop_back();
+                    merged = true;
+                    break;
+                }
+            }
+        }
+        dirty_.push_back(rect);
+        return dirty_.size() <= kMaxDirtyRects;
+    }
+    
+    void record_drawn_state() {
+        drawn_.clear();
+        pending_dirty_.clear();
+        if (!incremental_) {
+            needs_full_redraw_ = true;
+            return;
+        }
+        drawn_.reserve(objects_.size());
+        for (const auto& object : objects_) {
+            drawn_.push_back({object->get_bounds(), object->get_revision()});
+        }
+        needs_full_redraw_ = false;
+    }
+    
+    void render_full() {
+        canvas_.clear();
+        
+        for (const auto& object : objects_) {
+            object->draw(canvas_);
+        }
+        last_redrawn_pixels_ = static_cast<size_t>(canvas_.width()) * canvas_.height();
+        record_drawn_state();
+    }
+    
+    // Clears and repaints only the regions touched by objects that changed
+    // since the last render. Every object intersecting a region is redrawn
+    // in scene order, so the pixels match a full render.
+    void render_dirty() {
+        dirty_.clear();
+        bool trackable = true;
+        for (const auto& bounds : pending_dirty_) {
+            trackable = trackable && add_dirty(bounds);
+        }
+        pending_dirty_.clear();
+        
+        for (size_t i = 0; i < objects_.size() && trackable; ++i) {
+            uint64_t revision = objects_[i]->get_revision();
+            Rectangle bounds = objects_[i]->get_bounds();
+            if (revision != drawn_[i].revision || !same_bounds(bounds, drawn_[i].bounds)) {
+                trackable = add_dirty(drawn_[i].bounds) && add_dirty(bounds);
+                drawn_[i] = {bounds, revision};
+            }
+        }
+        
+        size_t dirty_area = 0;
+        for (const auto& rect : dirty_) {
+            dirty_area += rect.area();
+        }
+        if (!trackable || dirty_area * 2 > static_cast<size_t>(canvas_.width()) * canvas_.height()) {
+            render_full();
+            return;
+        }
+        
+        for (const auto& rect : dirty_) {
+            Canvas view = canvas_.view(rect.x0, rect.y0, rect.x1, rect.y1);
+            view.clear();
+            for (size_t i = 0; i < objects_.size(); ++i) {
+                PixelRect covered;
+                if (!to_pixel_rect(drawn_[i].bounds, covered) || covered.overlaps(rect)) {
+                    objects_[i]->draw(view);
+                }
+            }
+        }
+        last_redrawn_pixels_ = dirty_area;
+    }
+    
+    void rebuild_collidables() {
+        collidables_.clear();
+        for (const auto& object : objects_) {
+            if (auto* circle = dynamic_cast<CircleShape*>(object.get())) {
+                collidables_.push_back(circle);
+            }
+        }
+        sweep_order_.resize(collidables_.size());
+        std::iota(sweep_order_.begin(), sweep_order_.end(), 0u);
+        sweep_sorted_ = 0;
+    }
+    
+    // Sort-and-sweep on the x extent of each bounding box. The order from the
+    // previous frame is kept, so the insertion sort is close to linear when
+    // objects move a little per frame. The first frame, or one after many
+    // objects were added, has no usable order and gets a full sort instead.
+    void find_candidate_pairs() {
+        sweep_entries_.clear();
+        for (uint32_t slot : sweep_order_) {
+            Rectangle bounds = collidables_[slot]->get_bounds();
+            sweep_entries_.push_back({bounds.position.x, bounds.position.x + bounds.width,
+                                      bounds.position.y, bounds.position.y + bounds.height, slot});
+        }
+        
+        if (sweep_entries_.size() - sweep_sorted_ > kMaxInsertedPerFrame) {
+            std::sort(sweep_entries_.begin(), sweep_entries_.end(),
+                      [](const SweepEntry& a, const SweepEntry& b) { return a.min_x < b.min_x; });
+        } else {
+            for (size_t i = 1; i < sweep_entries_.size(); ++i) {
+                SweepEntry entry = sweep_entries_[i];
+                size_t j = i;
+                while (j > 0 && sweep_entries_[j - 1].min_x > entry.min_x) {
+                    sweep_entries_[j] = sweep_entries_[j - 1];
+                    --j;
+                }
+                sweep_entries_[j] = entry;
+            }
+        }
+        sweep_sorted_ = sweep_entries_.size();
+        
+        candidate_pairs_.clear();
+        for (size_t i = 0; i < sweep_entries_.size(); ++i) {
+            const SweepEntry& a = sweep_entries_[i];
+            sweep_order_[i] = a.slot;
+            for (size_t j = i + 1; j < sweep_entries_.size() && sweep_entries_[j].min_x <= a.max_x; ++j) {
+                const SweepEntry& b = sweep_entries_[j];
+                if (a.min_y <= b.max_y && b.min_y <= a.max_y) {
+                    candidate_pairs_.emplace_back(std::min(a.slot, b.slot), std::max(a.slot, b.slot));
+                }
+            }
+        }
+        
+        // Resolve in scene order so results do not depend on the sweep order.
+        std::sort(candidate_pairs_.begin(), candidate_pairs_.end());
+    }
+    
+    void resolve_collisions() {
+        find_candidate_pairs();
+        last_collision_count_ = 0;
+        
+        for (const auto& [i, j] : candidate_pairs_) {
+            CircleShape* circle1 = collidables_[i];
+            CircleShape* circle2 = collidables_[j];
+            
+            double distance = circle1->get_center().distance(circle2->get_center());
+            double min_distance = circle1->get_radius() + circle2->get_radius();
+            
+            if (distance < min_distance) {
+                
+                Point2D direction = (circle2->get_center() - circle1->get_center()).normalize();
+                double overlap = min_distance - distance;
+                
+                circle1->set_center(circle1->get_center() - direction * (overlap / 2));
+                circle2->set_center(circle2->get_center() + direction * (overlap / 2));
+                
+                
+                circle1->set_color(Color::Green());
+                circle2->set_color(Color::Green());
+                ++last_collision_count_;
+            }
+        }
+    }
     
 public:
     Scene(const std::string& name, int width, int height)
         : canvas_(width, height), name_(name) {}
     
     void add_object(std::unique_ptr<Drawable> object) {
+        if (auto* circle = dynamic_cast<CircleShape*>(object.get())) {
+            sweep_order_.push_back(static_cast<uint32_t>(collidables_.size()));
+            collidables_.push_back(circle);
+        }
+        if (!needs_full_redraw_) {
+            Rectangle bounds = object->get_bounds();
+            pending_dirty_.push_back(bounds);
+            drawn_.push_back({bounds, object->get_revision()});
+        }
         objects_.push_back(std::move(object));
     }
     
     void remove_object(size_t index) {
         if (index < objects_.size()) {
             objects_.erase(objects_.begin() + index);
+            rebuild_collidables();
+            if (!needs_full_redraw_) {
+                pending_dirty_.push_back(drawn_[index].bounds);
+                drawn_.erase(drawn_.begin() + index);
+            }
         }
     }
     
+    // With incremental rendering on, render() only repaints dirty regions
+    // after the first full frame.
+    void set_incremental_rendering(bool enabled) {
+        incremental_ = enabled;
+        needs_full_redraw_ = true;
+    }
+    
+    bool is_incremental_rendering() const { return incremental_; }
+    void invalidate() { needs_full_redraw_ = true; }
+    size_t get_last_redrawn_pixels() const { return last_redrawn_pixels_; }
+    
     void update(double delta_time) {
         for (auto& object : objects_) {
             object->update(delta_time);
         }
         
-        
-        for (size_t i = 0; i < objects_.size(); ++i) {
-            auto* circle1 = dynamic_cast<CircleShape*>(objects_[i].get());
-            if (!circle1) continue;
-            
-            for (size_t j = i + 1; j < objects_.size(); ++j) {
-                auto* circle2 = dynamic_cast<CircleShape*>(objects_[j].get());
-                if (!circle2) continue;
-                
-                double distance = circle1->get_center().distance(circle2->get_center());
-                double min_distance = circle1->get_radius() + circle2->get_radius();
-                
-                if (distance < min_distance) {
-                    
-                    Point2D direction = (circle2->get_center() - circle1->get_center()).normalize();
-                    double overlap = min_distance - distance;
-                    
-                    circle1->set_center(circle1->get_center() - direction * (overlap / 2));
-                    circle2->set_center(circle2->get_center() + direction * (overlap / 2));
-                    
-                    
-                    circle1->set_color(Color::Green());
-                    circle2->set_color(Color::Green());
-                }
-            }
-        }
+        resolve_collisions();
     }
     
+    size_t get_last_collision_count() const { return last_collision_count_; }
+    
     void render() {
-        canvas_.clear();
-        
+        if (incremental_ && !needs_full_redraw_) {
+            render_dirty();
+        } else {
+            render_full();
+        }
+    }
+    
+    void render(TiledRasterizer& rasterizer) {
+        std::vector<const Drawable*> objects;
+        objects.reserve(objects_.size());
         for (const auto& object : objects_) {
-            object->draw(canvas_);
+            objects.push_back(object.get());
+        }
+        rasterizer.render(objects, canvas_);
+        last_redrawn_pixels_ = static_cast<size_t>(canvas_.width()) * canvas_.height();
+        record_drawn_state();
+    }
+    
+    std::vector<std::unique_ptr<Drawable>> snapshot_objects() const {
+        std::vector<std::unique_ptr<Drawable>> snapshot;
+        snapshot.reserve(objects_.size());
+        for (const auto& object : objects_) {
+            snapshot.push_back(object->snapshot());
         }
+        return snapshot;
     }
     
+    const Canvas& get_canvas() const { return canvas_; }
+    
     std::string get_ascii_frame() const {
         return canvas_.to_ascii();
     }
@@ -531,14 +1361,80 @@ private:
     std::chrono::high_resolution_clock::time_point last_frame_time_;
     double frame_rate_;
     int frame_count_;
+    std::unique_ptr<TiledRasterizer> rasterizer_;
+    bool pipelined_ = false;
+    // One long-lived thread for pipelined frames, separate from the
+    // rasterizer's pool whose parallel_for() the frame task calls.
+    std::unique_ptr<RenderWorkerPool> frame_worker_;
+    std::future<void> pending_raster_;
+    std::vector<std::unique_ptr<Drawable>> raster_snapshot_;
+    std::unique_ptr<Canvas> raster_target_;
+    std::unique_ptr<Canvas> presented_frame_;
+    
+    void rasterize_snapshot() {
+        std::vector<const Drawable*> objects;
+        objects.reserve(raster_snapshot_.size());
+        for (const auto& object : raster_snapshot_) {
+            objects.push_back(object.get());
+        }
+        
+        if (rasterizer_) {
+            rasterizer_->render(objects, *raster_target_);
+        } else {
+            raster_target_->clear();
+            for (const auto* object : objects) {
+                object->draw(*raster_target_);
+            }
+        }
+    }
+    
+    void finish_pending_raster() {
+        if (!pending_raster_.valid()) return;
+        pending_raster_.get();
+        std::swap(raster_target_, presented_frame_);
+    }
     
 public:
     GraphicsRenderer() : frame_rate_(0.0), frame_count_(0) {
         last_frame_time_ = std::chrono::high_resolution_clock::now();
     }
     
+    ~GraphicsRenderer() {
+        if (pending_raster_.valid()) {
+            pending_raster_.wait();
+        }
+    }
+    
+    void enable_tiled_rendering(int tile_size = 64, size_t threads = 0) {
+        finish_pending_raster();
+        rasterizer_ = std::make_unique<TiledRasterizer>(tile_size, threads);
+    }
+    
+    void disable_tiled_rendering() {
+        finish_pending_raster();
+        rasterizer_.reset();
+    }
+    
+    // In pipelined mode advance_frame() rasterizes a snapshot of frame N on
+    // a background thread while the scene and animations update to N+1.
+    void set_pipelined(bool pipelined) {
+        finish_pending_raster();
+        pipelined_ = pipelined;
+        if (pipelined_ && !frame_worker_) {
+            frame_worker_ = std::make_unique<RenderWorkerPool>(2);
+        }
+    }
+    
+    bool is_pipelined() const { return pipelined_; }
+    
     void set_scene(std::unique_ptr<Scene> scene) {
+        if (pending_raster_.valid()) {
+            pending_raster_.wait();
+            pending_raster_ = std::future<void>();
+        }
         current_scene_ = std::move(scene);
+        raster_target_.reset();
+        presented_frame_.reset();
     }
     
     void add_animation(Animation animation) {
@@ -573,14 +1469,49 @@ public:
     }
     
     void render() {
-        if (current_scene_) {
+        if (!current_scene_) return;
+        if (rasterizer_ && !current_scene_->is_incremental_rendering()) {
+            current_scene_->render(*rasterizer_);
+        } else {
             current_scene_->render();
         }
     }
     
+    void advance_frame() {
+        if (!pipelined_ || !current_scene_) {
+            update();
+            render();
+            return;
+        }
+        
+        finish_pending_raster();
+        
+        const Canvas& scene_canvas = current_scene_->get_canvas();
+        if (!raster_target_) {
+            raster_target_ = std::make_unique<Canvas>(scene_canvas.width(), scene_canvas.height(),
+                                                      scene_canvas.background());
+        }
+        raster_snapshot_ = current_scene_->snapshot_objects();
+        pending_raster_ = frame_worker_->submit([this] { rasterize_snapshot(); });
+        
+        update();
+    }
+    
+    // Waits for the in-flight pipelined frame, if any, and presents it.
+    void flush() {
+        finish_pending_raster();
+    }
+    
+    const Canvas* get_presented_canvas() const {
+        if (pipelined_ && presented_frame_) {
+            return presented_frame_.get();
+        }
+        return current_scene_ ? &current_scene_->get_canvas() : nullptr;
+    }
+    
     std::string get_frame() const {
-        if (current_scene_) {
-            return current_scene_->get_ascii_frame();
+        if (const Canvas* canvas = get_presented_canvas()) {
+            return canvas->to_ascii();
         }
         return "";
     }
@@ -736,6 +1667,256 @@ void demonstrateFullScene() {
     }
 }
 
+void demonstrateTiledRendering() {
+    using namespace GraphicsEngine;
+    using Clock = std::chrono::steady_clock;
+    
+    std::cout << "=== Tiled Rendering Demo ===\n";
+    
+    auto build_scene = []() {
+        auto scene = std::make_unique<Scene>("Tiled Stress", 1920, 1080);
+        std::mt19937 rng(31);
+        std::uniform_real_distribution<double> x_dist(0, 1920);
+        std::uniform_real_distribution<double> y_dist(0, 1080);
+        std::uniform_real_distribution<double> size_dist(4, 40);
+        std::uniform_real_distribution<double> vel_dist(-60, 60);
+        for (int i = 0; i < 2000; ++i) {
+            Point2D p(x_dist(rng), y_dist(rng));
+            if (i % 3 == 0) {
+                auto rect = std::make_unique<RectangleShape>(Rectangle(p, size_dist(rng), size_dist(rng)),
+                                                             Color(static_cast<uint8_t>(i), 60, 200));
+                rect->set_velocity(Point2D(vel_dist(rng), vel_dist(rng)));
+                scene->add_object(std::move(rect));
+            } else {
+                auto circle = std::make_unique<CircleShape>(p, size_dist(rng) / 2,
+                                                            Color(200, static_cast<uint8_t>(i), 80));
+                circle->set_velocity(Point2D(vel_dist(rng), vel_dist(rng)));
+                scene->add_object(std::move(circle));
+            }
+        }
+        return scene;
+    };
+    
+    auto same_pixels = [](const Canvas& a, const Canvas& b) {
+        for (int y = 0; y < a.height(); ++y) {
+            for (int x = 0; x < a.width(); ++x) {
+                Color p = a.get_pixel(x, y), q = b.get_pixel(x, y);
+                if (p.r != q.r || p.g != q.g || p.b != q.b || p.a != q.a) return false;
+            }
+        }
+        return true;
+    };
+    
+    auto reference = build_scene();
+    auto tiled = build_scene();
+    TiledRasterizer rasterizer(64);
+    
+    const int frames = 10;
+    double sequential_ms = 0.0, tiled_ms = 0.0;
+    bool identical = true;
+    for (int frame = 0; frame < frames; ++frame) {
+        reference->update(1.0 / 60.0);
+        tiled->update(1.0 / 60.0);
+        
+        auto start = Clock::now();
+        reference->render();
+        sequential_ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        
+        start = Clock::now();
+        tiled->render(rasterizer);
+        tiled_ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        
+        identical = identical && same_pixels(reference->get_canvas(), tiled->get_canvas());
+    }
+    
+    std::cout << std::fixed << std::setprecision(2)
+              << "sequential render: " << sequential_ms / frames << " ms/frame\n"
+              << "tiled render (" << rasterizer.thread_count() << " threads, " << rasterizer.tile_size()
+              << "px tiles): " << tiled_ms / frames << " ms/frame\n"
+              << "Tiled output identical: " << (identical ? "Yes" : "No") << "\n";
+    
+    GraphicsRenderer engine;
+    engine.set_scene(build_scene());
+    engine.enable_tiled_rendering(64);
+    engine.set_pipelined(true);
+    
+    auto start = Clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        engine.advance_frame();
+    }
+    engine.flush();
+    double pipelined_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << "pipelined update+render: " << pipelined_ms / frames << " ms/frame\n\n";
+}
+
+void demonstrateIncrementalRendering() {
+    using namespace GraphicsEngine;
+    using Clock = std::chrono::steady_clock;
+    
+    std::cout << "=== Incremental Rendering Demo ===\n";
+    
+    auto build_scene = [](bool incremental) {
+        auto scene = std::make_unique<Scene>("Mostly Static", 1280, 720);
+        scene->set_incremental_rendering(incremental);
+        std::mt19937 rng(41);
+        std::uniform_real_distribution<double> x_dist(0, 1280);
+        std::uniform_real_distribution<double> y_dist(0, 720);
+        std::uniform_real_distribution<double> size_dist(6, 60);
+        for (int i = 0; i < 3000; ++i) {
+            scene->add_object(std::make_unique<RectangleShape>(
+                Rectangle(Point2D(x_dist(rng), y_dist(rng)), size_dist(rng), size_dist(rng)),
+                Color(static_cast<uint8_t>(i), 120, 180)));
+        }
+        for (int i = 0; i < 8; ++i) {
+            auto circle = std::make_unique<CircleShape>(Point2D(100 + i * 140, 360), 12, Color::Black());
+            circle->set_velocity(Point2D(30, 20 - i * 5));
+            scene->add_object(std::move(circle));
+        }
+        return scene;
+    };
+    
+    auto full = build_scene(false);
+    auto incremental = build_scene(true);
+    
+    const int frames = 30;
+    double full_ms = 0.0, incremental_ms = 0.0;
+    size_t redrawn_pixels = 0;
+    bool identical = true;
+    for (int frame = 0; frame < frames; ++frame) {
+        full->update(1.0 / 60.0);
+        incremental->update(1.0 / 60.0);
+        
+        auto start = Clock::now();
+        full->render();
+        full_ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        
+        start = Clock::now();
+        incremental->render();
+        incremental_ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (frame > 0) {
+            redrawn_pixels += incremental->get_last_redrawn_pixels();
+        }
+        
+        const Canvas& a = full->get_canvas();
+        const Canvas& b = incremental->get_canvas();
+        for (int y = 0; y < a.height() && identical; ++y) {
+            identical = std::memcmp(static_cast<const void*>(a.row(y)), static_cast<const void*>(b.row(y)),
+                                    a.width() * sizeof(Color)) == 0;
+        }
+    }
+    
+    double canvas_pixels = 1280.0 * 720.0;
+    std::cout << std::fixed << std::setprecision(2)
+              << "full redraw: " << full_ms / frames << " ms/frame\n"
+              << "dirty regions: " << incremental_ms / frames << " ms/frame, "
+              << 100.0 * redrawn_pixels / (canvas_pixels * (frames - 1)) << "% of pixels redrawn\n"
+              << "Incremental output identical: " << (identical ? "Yes" : "No") << "\n";
+    
+    const Canvas& canvas = incremental->get_canvas();
+    std::string ascii;
+    std::vector<uint8_t> ppm;
+    auto start = Clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        canvas.to_ascii(ascii);
+    }
+    double ascii_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+    
+    start = Clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        canvas.export_ppm(ppm);
+    }
+    double ppm_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+    
+    std::cout << "ASCII export: " << ascii_ms << " ms/frame (" << ascii.size() << " bytes)\n"
+              << "PPM export: " << ppm_ms << " ms/frame (" << ppm.size() << " bytes)\n\n";
+}
+
+void demonstrateCollisionBroadPhase() {
+    using namespace GraphicsEngine;
+    using Clock = std::chrono::steady_clock;
+    
+    std::cout << "=== Collision Broad Phase Demo ===\n";
+    
+    Scene scene("Collision Stress", 2000, 2000);
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<double> pos_dist(0, 2000);
+    std::uniform_real_distribution<double> vel_dist(-40, 40);
+    
+    const int circle_count = 5000;
+    for (int i = 0; i < circle_count; ++i) {
+        auto circle = std::make_unique<CircleShape>(Point2D(pos_dist(rng), pos_dist(rng)), 4);
+        circle->set_velocity(Point2D(vel_dist(rng), vel_dist(rng)));
+        scene.add_object(std::move(circle));
+    }
+    
+    const int frames = 30;
+    size_t collisions = 0;
+    auto start = Clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        scene.update(1.0 / 60.0);
+        collisions += scene.get_last_collision_count();
+    }
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    
+    std::cout << circle_count << " circles, " << frames << " frames: " << collisions
+              << " collisions resolved, " << std::fixed << std::setprecision(3) << ms / frames
+              << " ms/frame\n\n";
+}
+
+void demonstrateParticleThroughput() {
+    using namespace GraphicsEngine;
+    using Clock = std::chrono::steady_clock;
+    
+    std::cout << "=== Particle Throughput Demo ===\n";
+    
+    const size_t cap = 1000000;
+    ParticleSystem particles(Point2D(500, 500), 2.0e6, cap);
+    
+    const int frames = 30;
+    const double delta_time = 1.0 / 60.0;
+    size_t peak = 0;
+    auto start = Clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        particles.update(delta_time);
+        peak = std::max(peak, particles.get_particle_count());
+    }
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    
+    std::cout << frames << " updates, peak " << peak << " particles (cap " << particles.get_max_particles()
+              << "): " << std::fixed << std::setprecision(2) << ms / frames << " ms/update\n\n";
+}
+
+void demonstrateRasterThroughput() {
+    using namespace GraphicsEngine;
+    using Clock = std::chrono::steady_clock;
+    
+    std::cout << "=== Raster Throughput Demo ===\n";
+    
+    Canvas canvas(1920, 1080);
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> x_dist(-50, 1970);
+    std::uniform_real_distribution<double> y_dist(-50, 1130);
+    std::uniform_real_distribution<double> size_dist(5, 120);
+    
+    const int frames = 20;
+    const int primitives = 500;
+    auto start = Clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        canvas.clear();
+        for (int i = 0; i < primitives; ++i) {
+            Point2D p(x_dist(rng), y_dist(rng));
+            canvas.draw_circle(p, size_dist(rng), Color::Blue());
+            canvas.draw_rectangle(Rectangle(p, size_dist(rng), size_dist(rng)), Color::Red());
+            canvas.draw_line(p, Point2D(x_dist(rng), y_dist(rng)), Color::Black());
+        }
+    }
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    
+    std::cout << frames << " frames of " << canvas.width() << "x" << canvas.height()
+              << " (stride " << canvas.stride() << ") with " << primitives * 3 << " primitives each: "
+              << std::fixed << std::setprecision(2) << ms / frames << " ms/frame\n\n";
+}
+
 int main() {
     std::cout << "2D Graphics Rendering Engine Demo\n";
     std::cout << "==================================\n\n";
@@ -745,6 +1926,11 @@ int main() {
     demonstrateParticleSystem();
     demonstrateAnimationSystem();
     demonstrateFullScene();
+    demonstrateRasterThroughput();
+    demonstrateParticleThroughput();
+    demonstrateCollisionBroadPhase();
+    demonstrateTiledRendering();
+    demonstrateIncrementalRendering();
     
     std::cout << "\n=== Graphics Engine Demo Complete ===\n";
     return 0;
@@ -13,6 +13,21 @@
 #include <fstream>
 #include <random>
 #include <map>
+#include <iomanip>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <deque>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <cstddef>
 
 
 #ifdef _WIN32
@@ -27,11 +42,22 @@
     #include <arpa/inet.h>
     #include <unistd.h>
     #include <netdb.h>
+    #include <netinet/tcp.h>
+    #include <sys/time.h>
+    #include <fcntl.h>
+    #ifdef __linux__
+        #include <sys/epoll.h>
+        #include <sys/eventfd.h>
+    #endif
     using socket_t = int;
     #define INVALID_SOCKET -1
     #define CLOSE_SOCKET close
 #endif
 
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0
+#endif
+
 namespace NetworkLib {
 
 
@@ -84,29 +110,45 @@ public:
     Socket(const Socket&) = delete;
     Socket& operator=(const Socket&) = delete;
     
+    // getaddrinfo rather than gethostbyname, which is not thread-safe.
+    static bool resolve(const std::string& host, int port, sockaddr_in& server_addr) {
+        server_addr = sockaddr_in{};
+        server_addr.sin_family = AF_INET;
+        server_addr.sin_port = htons(static_cast<uint16_t>(port));
+        
+        if (inet_pton(AF_INET, host.c_str(), &server_addr.sin_addr) == 1) {
+            return true;
+        }
+        
+        struct addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        struct addrinfo* result = nullptr;
+        if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) {
+            return false;
+        }
+        server_addr.sin_addr = reinterpret_cast<sockaddr_in*>(result->ai_addr)->sin_addr;
+        freeaddrinfo(result);
+        return true;
+    }
+    
     bool connect(const std::string& host, int port) {
         if (connected_) {
             disconnect();
         }
         
-        socket_ = socket(AF_INET, SOCK_STREAM, 0);
-        if (socket_ == INVALID_SOCKET) {
+        struct sockaddr_in server_addr{};
+        if (!resolve(host, port, server_addr)) {
             return false;
         }
         
-        struct sockaddr_in server_addr{};
-        server_addr.sin_family = AF_INET;
-        server_addr.sin_port = htons(static_cast<uint16_t>(port));
-        
-        
-        struct hostent* host_entry = gethostbyname(host.c_str());
-        if (!host_entry) {
-            inet_pton(AF_INET, host.c_str(), &server_addr.sin_addr);
-        } else {
-            memcpy(&server_addr.sin_addr, host_entry->h_addr_list[0], host_entry->h_length);
+        socket_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (socket_ == INVALID_SOCKET) {
+            return false;
         }
         
         if (::connect(socket_, reinterpret_cast<struct sockaddr*>(&server_addr), sizeof(server_addr)) == 0) {
+            set_no_delay();
             connected_ = true;
             host_ = host;
             port_ = port;
@@ -118,6 +160,63 @@ public:
         return false;
     }
     
+#ifndef _WIN32
+    // Starts a non-blocking connect. The socket is writable once the
+    // handshake finishes; finish_connect() then reports the outcome.
+    bool connect_async(const sockaddr_in& server_addr, const std::string& host, int port) {
+        disconnect();
+        
+        socket_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (socket_ == INVALID_SOCKET || !set_non_blocking(true)) {
+            disconnect();
+            return false;
+        }
+        host_ = host;
+        port_ = port;
+        
+        if (::connect(socket_, reinterpret_cast<const struct sockaddr*>(&server_addr), sizeof(server_addr)) == 0 ||
+            errno == EINPROGRESS) {
+            return true;
+        }
+        disconnect();
+        return false;
+    }
+    
+    enum class ConnectStatus { PENDING, CONNECTED, FAILED };
+    
+    // Reading SO_ERROR clears it, so the outcome is checked exactly once.
+    ConnectStatus finish_connect() {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (socket_ == INVALID_SOCKET ||
+            getsockopt(socket_, SOL_SOCKET, SO_ERROR, &error, &length) != 0 || error != 0) {
+            return ConnectStatus::FAILED;
+        }
+        
+        sockaddr_in peer{};
+        socklen_t peer_length = sizeof(peer);
+        if (getpeername(socket_, reinterpret_cast<sockaddr*>(&peer), &peer_length) != 0) {
+            return errno == ENOTCONN ? ConnectStatus::PENDING : ConnectStatus::FAILED;
+        }
+        set_no_delay();
+        connected_ = true;
+        return ConnectStatus::CONNECTED;
+    }
+    
+    bool set_non_blocking(bool enabled) {
+        int flags = fcntl(socket_, F_GETFL, 0);
+        if (flags < 0) return false;
+        flags = enabled ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+        return fcntl(socket_, F_SETFL, flags) == 0;
+    }
+#endif
+    
+    // Requests are small and latency bound; don't wait on Nagle.
+    void set_no_delay() {
+        int no_delay = 1;
+        setsockopt(socket_, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&no_delay), sizeof(no_delay));
+    }
+    
     void disconnect() {
         if (socket_ != INVALID_SOCKET) {
             CLOSE_SOCKET(socket_);
@@ -145,348 +244,2031 @@ public:
         return "";
     }
     
+    // Sends the whole buffer, continuing after partial writes.
+    bool send_all(const std::string& data) {
+        if (!connected_) return false;
+        
+        const char* cursor = data.data();
+        size_t remaining = data.length();
+        while (remaining > 0) {
+            ssize_t sent = ::send(socket_, cursor, remaining, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                return false;
+            }
+            cursor += sent;
+            remaining -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+    
+    ssize_t send_some(const char* data, size_t length) {
+        if (!connected_) return -1;
+        return ::send(socket_, data, length, MSG_NOSIGNAL);
+    }
+    
+    ssize_t receive_some(char* buffer, size_t max_size) {
+        if (!connected_) return -1;
+        return recv(socket_, buffer, max_size, 0);
+    }
+    
+    void set_timeout(std::chrono::milliseconds timeout) {
+        if (socket_ == INVALID_SOCKET) return;
+#ifdef _WIN32
+        DWORD value = static_cast<DWORD>(timeout.count());
+        setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&value), sizeof(value));
+        setsockopt(socket_, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&value), sizeof(value));
+#else
+        struct timeval value{};
+        value.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+        value.tv_usec = static_cast<suseconds_t>((timeout.count() % 1000) * 1000);
+        setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &value, sizeof(value));
+        setsockopt(socket_, SOL_SOCKET, SO_SNDTIMEO, &value, sizeof(value));
+#endif
+    }
+    
+    // An idle keep-alive connection is reusable while the peer has neither
+    // closed it nor sent anything unsolicited.
+    bool is_reusable() const {
+        if (!connected_) return false;
+#ifdef _WIN32
+        return true;
+#else
+        char byte;
+        ssize_t result = recv(socket_, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+        return result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+#endif
+    }
+    
     bool is_connected() const { return connected_; }
+    socket_t native_handle() const { return socket_; }
     const std::string& get_host() const { return host_; }
     int get_port() const { return port_; }
 };
 
 
-class HttpClient {
-private:
-    Socket socket_;
-    std::chrono::seconds timeout_;
-    std::map<std::string, std::string> default_headers_;
+struct HttpResponse {
+    int status_code;
+    std::string status_message;
+    std::map<std::string, std::string> headers;
+    std::string body;
+    bool keep_alive = false;
     
-    struct HttpResponse {
-        int status_code;
-        std::string status_message;
-        std::map<std::string, std::string> headers;
-        std::string body;
-        
-        bool is_success() const { return status_code >= 200 && status_code < 300; }
+    bool is_success() const { return status_code >= 200 && status_code < 300; }
+};
+
+// Receives body bytes of a successful response as they arrive, instead of
+// collecting them in HttpResponse::body. Returning false aborts the read.
+using BodySink = std::function<bool(const char* data, size_t size)>;
+
+
+inline bool header_equals(const std::string& a, const std::string& b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+inline bool header_contains(const std::string& haystack, const std::string& needle) {
+    auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(),
+                          [](char x, char y) {
+                              return std::tolower(static_cast<unsigned char>(x)) ==
+                                     std::tolower(static_cast<unsigned char>(y));
+                          });
+    return it != haystack.end();
+}
+
+inline const std::string* find_header(const std::map<std::string, std::string>& headers,
+                                      const std::string& name) {
+    for (const auto& [key, value] : headers) {
+        if (header_equals(key, name)) {
+            return &value;
+        }
+    }
+    return nullptr;
+}
+
+
+// Thrown by ResponseParser when the peer's bytes are not valid HTTP/1.1.
+class HttpProtocolError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+
+// Incremental HTTP/1.1 response parser. Bytes can arrive in any split, so
+// the same parser serves blocking reads and the event loop. Bodies are
+// framed by chunked encoding, Content-Length, or connection close, in that
+// order of precedence (RFC 7230 3.3.3).
+class ResponseParser {
+private:
+    enum class State {
+        STATUS_LINE, HEADERS, BODY_LENGTH, BODY_EOF,
+        CHUNK_SIZE, CHUNK_DATA, CHUNK_DATA_END, TRAILERS, DONE
     };
     
-    std::string build_request(const std::string& method, const std::string& path,
-                            const std::map<std::string, std::string>& headers,
-                            const std::string& body = "") {
-        std::ostringstream request;
-        request << method << " " << path << " HTTP/1.1\r\n";
-        
+    static constexpr size_t kMaxLineLength = 64 * 1024;
+    
+    State state_ = State::STATUS_LINE;
+    bool head_request_;
+    const BodySink* body_sink_;
+    HttpResponse response_{};
+    std::string http_version_;
+    std::string line_;
+    size_t remaining_ = 0;
+    bool started_ = false;
+    
+    // Digits only: no sign, whitespace or trailing junk, and no wrap on
+    // overflow.
+    static size_t parse_size(const std::string& text, int base, const char* what) {
+        size_t value = 0;
+        const char* end = text.data() + text.size();
+        auto result = std::from_chars(text.data(), end, value, base);
+        if (text.empty() || result.ec != std::errc() || result.ptr != end) {
+            throw HttpProtocolError(std::string("Invalid ") + what);
+        }
+        return value;
+    }
+    
+    void end_of_headers() {
+        const std::string* connection = find_header(response_.headers, "Connection");
+        response_.keep_alive = http_version_ == "HTTP/1.1"
+            ? !(connection && header_contains(*connection, "close"))
+            : (connection && header_contains(*connection, "keep-alive"));
         
-        for (const auto& [key, value] : default_headers_) {
-            request << key << ": " << value << "\r\n";
+        if (response_.status_code >= 100 && response_.status_code < 200) {
+            response_ = HttpResponse{};
+            state_ = State::STATUS_LINE;
+            return;
+        }
+        if (head_request_ || response_.status_code == 204 || response_.status_code == 304) {
+            state_ = State::DONE;
+            return;
         }
         
+        const std::string* transfer_encoding = find_header(response_.headers, "Transfer-Encoding");
+        const std::string* content_length = find_header(response_.headers, "Content-Length");
         
-        for (const auto& [key, value] : headers) {
-            request << key << ": " << value << "\r\n";
+        if (transfer_encoding && header_contains(*transfer_encoding, "chunked")) {
+            state_ = State::CHUNK_SIZE;
+        } else if (content_length) {
+            remaining_ = parse_size(*content_length, 10, "Content-Length");
+            if (!streaming()) {
+                response_.body.reserve(std::min<size_t>(remaining_, 64 * 1024 * 1024));
+            }
+            state_ = remaining_ > 0 ? State::BODY_LENGTH : State::DONE;
+        } else {
+            response_.keep_alive = false;
+            state_ = State::BODY_EOF;
         }
-        
-        if (!body.empty()) {
-            request << "Content-Length: " << body.length() << "\r\n";
+    }
+    
+    bool streaming() const { return body_sink_ && response_.is_success(); }
+    
+    void emit_body(const char* data, size_t size) {
+        if (!streaming()) {
+            response_.body.append(data, size);
+        } else if (size > 0 && !(*body_sink_)(data, size)) {
+            throw std::runtime_error("Body sink rejected data");
+        }
+    }
+    
+    void handle_line() {
+        switch (state_) {
+            case State::STATUS_LINE: {
+                if (line_.empty()) return;
+                auto version_end = line_.find(' ');
+                if (version_end == std::string::npos || line_.compare(0, 5, "HTTP/") != 0) {
+                    throw HttpProtocolError("Malformed status line");
+                }
+                http_version_ = line_.substr(0, version_end);
+                response_.status_code = std::atoi(line_.c_str() + version_end + 1);
+                auto message_pos = line_.find(' ', version_end + 1);
+                if (message_pos != std::string::npos) {
+                    response_.status_message = line_.substr(message_pos + 1);
+                }
+                state_ = State::HEADERS;
+                break;
+            }
+            case State::HEADERS: {
+                if (line_.empty()) {
+                    end_of_headers();
+                    return;
+                }
+                auto colon_pos = line_.find(':');
+                if (colon_pos != std::string::npos) {
+                    auto value_pos = line_.find_first_not_of(" \t", colon_pos + 1);
+                    response_.headers[line_.substr(0, colon_pos)] =
+                        value_pos == std::string::npos ? "" : line_.substr(value_pos);
+                }
+                break;
+            }
+            case State::CHUNK_SIZE: {
+                std::string size_field = line_.substr(0, line_.find(';'));
+                size_field.erase(size_field.find_last_not_of(" \t") + 1);
+                remaining_ = parse_size(size_field, 16, "chunk size");
+                state_ = remaining_ > 0 ? State::CHUNK_DATA : State::TRAILERS;
+                break;
+            }
+            case State::CHUNK_DATA_END:
+                state_ = State::CHUNK_SIZE;
+                break;
+            case State::TRAILERS:
+                if (line_.empty()) state_ = State::DONE;
+                break;
+            default:
+                break;
         }
-        
-        request << "\r\n" << body;
-        return request.str();
     }
     
-    HttpResponse parse_response(const std::string& response_data) {
-        HttpResponse response{};
-        std::istringstream stream(response_data);
-        std::string line;
+public:
+    explicit ResponseParser(bool head_request = false, const BodySink* body_sink = nullptr)
+        : head_request_(head_request), body_sink_(body_sink) {}
+    
+    // Consumes up to `size` bytes and returns how many were used. Parsing
+    // stops at the end of the message, so bytes belonging to a following
+    // pipelined response are left to the caller.
+    size_t feed(const char* data, size_t size) {
+        size_t used = 0;
+        started_ = started_ || size > 0;
         
+        while (used < size && state_ != State::DONE) {
+            if (state_ == State::BODY_LENGTH || state_ == State::CHUNK_DATA) {
+                size_t take = std::min(remaining_, size - used);
+                emit_body(data + used, take);
+                used += take;
+                remaining_ -= take;
+                if (remaining_ == 0) {
+                    state_ = state_ == State::BODY_LENGTH ? State::DONE : State::CHUNK_DATA_END;
+                }
+                continue;
+            }
+            if (state_ == State::BODY_EOF) {
+                emit_body(data + used, size - used);
+                return size;
+            }
+            
+            const char* start = data + used;
+            const char* newline = static_cast<const char*>(std::memchr(start, '\n', size - used));
+            if (!newline) {
+                line_.append(start, size - used);
+                if (line_.size() > kMaxLineLength) {
+                    throw HttpProtocolError("Response line too long");
+                }
+                return size;
+            }
+            
+            line_.append(start, static_cast<size_t>(newline - start));
+            used += static_cast<size_t>(newline - start) + 1;
+            if (!line_.empty() && line_.back() == '\r') {
+                line_.pop_back();
+            }
+            handle_line();
+            line_.clear();
+        }
+        return used;
+    }
+    
+    // Call when the peer closes the connection.
+    void finish() {
+        if (state_ == State::BODY_EOF) {
+            state_ = State::DONE;
+        } else if (state_ != State::DONE) {
+            throw std::runtime_error(started_ ? "Truncated response" : "No response received");
+        }
+    }
+    
+    bool done() const { return state_ == State::DONE; }
+    HttpResponse take() { return std::move(response_); }
+};
+
+
+// Blocking reader over one connection. Bytes past the end of a response
+// stay buffered, which is what lets pipelined responses be read back to
+// back.
+class ResponseReader {
+private:
+    Socket& socket_;
+    char buffer_[16384];
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    size_t bytes_received_ = 0;
+    
+public:
+    explicit ResponseReader(Socket& socket) : socket_(socket) {}
+    
+    HttpResponse read(bool head_request, const BodySink* body_sink = nullptr) {
+        ResponseParser parser(head_request, body_sink);
+        for (;;) {
+            if (begin_ < end_) {
+                begin_ += parser.feed(buffer_ + begin_, end_ - begin_);
+                if (parser.done()) {
+                    return parser.take();
+                }
+            }
+            
+            begin_ = end_ = 0;
+            ssize_t received = socket_.receive_some(buffer_, sizeof(buffer_));
+            if (received <= 0) {
+                parser.finish();
+                return parser.take();
+            }
+            end_ = static_cast<size_t>(received);
+            bytes_received_ += end_;
+        }
+    }
+    
+    bool has_buffered_data() const { return begin_ < end_; }
+    size_t bytes_received() const { return bytes_received_; }
+};
+
+
+class ConnectionPool {
+public:
+    struct HostLimits {
+        size_t max_connections = 0;   // idle plus checked out; 0 = unlimited
+        size_t max_idle = 32;
+        size_t min_idle = 0;          // kept through idle expiry
+    };
+    
+    enum class Checkout { IDLE, OPEN_NEW, AT_LIMIT };
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    static constexpr size_t kShardCount = 16;
+    static constexpr size_t kWheelSlots = 64;
+    
+    struct IdleConnection {
+        std::unique_ptr<Socket> socket;
+        Clock::time_point last_used;
+    };
+    
+    // Idle connections sit in a LIFO stack: checkout pops the warmest one,
+    // and the oldest, which expire first, are at the front.
+    struct HostBucket {
+        std::deque<IdleConnection> idle;
+        size_t checked_out = 0;
+        HostLimits limits;
+        uint64_t scheduled_tick = 0;  // pending wheel entry; 0 = none
+        // Waiters in get_connection() for this host only, so a return
+        // never wakes a waiter for another host in the same shard.
+        std::condition_variable returned;
         
-        if (std::getline(stream, line)) {
-            std::istringstream status_stream(line);
-            std::string http_version;
-            status_stream >> http_version >> response.status_code;
-            std::getline(status_stream, response.status_message);
+        bool at_limit() const {
+            return limits.max_connections != 0 && idle.size() + checked_out >= limits.max_connections;
+        }
+    };
+    
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, HostBucket> buckets;
+    };
+    
+    // Buckets are never erased, so an entry can point at its bucket.
+    struct WheelEntry {
+        size_t shard;
+        HostBucket* bucket;
+        uint64_t tick;
+    };
+    
+    Shard shards_[kShardCount];
+    std::chrono::seconds max_idle_time_;
+    Clock::duration tick_;
+    Clock::time_point epoch_;
+    std::mutex wheel_mutex_;
+    std::vector<WheelEntry> wheel_[kWheelSlots];
+    uint64_t current_tick_ = 0;
+    std::mutex limits_mutex_;
+    HostLimits default_limits_;
+    std::atomic<std::chrono::milliseconds> acquire_timeout_{std::chrono::milliseconds(30000)};
+    std::atomic<bool> cleanup_running_;
+    std::mutex cleanup_mutex_;
+    std::condition_variable cleanup_cv_;
+    std::thread cleanup_thread_;
+    std::atomic<size_t> opened_{0};
+    std::atomic<size_t> reused_{0};
+    
+    static std::string host_key(const std::string& host, int port) {
+        return host + ":" + std::to_string(port);
+    }
+    
+    static size_t shard_of(const std::string& key) {
+        return std::hash<std::string>{}(key) % kShardCount;
+    }
+    
+    HostBucket& bucket_locked(Shard& shard, const std::string& key) {
+        auto it = shard.buckets.find(key);
+        if (it == shard.buckets.end()) {
+            std::lock_guard<std::mutex> lock(limits_mutex_);
+            it = shard.buckets.try_emplace(key).first;
+            it->second.limits = default_limits_;
+        }
+        return it->second;
+    }
+    
+    uint64_t tick_of(Clock::time_point time) const {
+        return static_cast<uint64_t>((time - epoch_) / tick_);
+    }
+    
+    // A host with idle connections has at most one wheel entry, booked
+    // for the expiry tick of its oldest idle connection; a tick then only
+    // visits hosts that may have expired connections rather than scanning
+    // the whole pool. Caller holds the shard lock.
+    void schedule_expiry_locked(size_t shard, HostBucket& bucket, Clock::time_point last_used) {
+        uint64_t tick = tick_of(last_used + max_idle_time_) + 1;
+        std::lock_guard<std::mutex> lock(wheel_mutex_);
+        tick = std::max(tick, current_tick_ + 1);
+        if (bucket.scheduled_tick != 0 && bucket.scheduled_tick <= tick) {
+            return;
+        }
+        bucket.scheduled_tick = tick;
+        wheel_[tick % kWheelSlots].push_back({shard, &bucket, tick});
+    }
+    
+    void expire_slot(std::vector<WheelEntry>& entries) {
+        std::vector<std::unique_ptr<Socket>> expired;
+        for (const auto& entry : entries) {
+            Shard& shard = shards_[entry.shard];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            HostBucket& bucket = *entry.bucket;
+            if (bucket.scheduled_tick != entry.tick) continue;  // superseded by an earlier entry
+            bucket.scheduled_tick = 0;
+            
+            auto cutoff = Clock::now() - max_idle_time_;
+            size_t before = expired.size();
+            while (bucket.idle.size() > bucket.limits.min_idle && bucket.idle.front().last_used <= cutoff) {
+                expired.push_back(std::move(bucket.idle.front().socket));
+                bucket.idle.pop_front();
+            }
+            if (expired.size() != before) {
+                bucket.returned.notify_all();
+            }
+            if (bucket.idle.size() > bucket.limits.min_idle) {
+                schedule_expiry_locked(entry.shard, bucket, bucket.idle.front().last_used);
+            }
+        }
+        // Sockets close here, outside the shard locks.
+    }
+    
+    void cleanup_expired_connections() {
+        auto next = epoch_ + tick_;
+        while (cleanup_running_) {
+            {
+                std::unique_lock<std::mutex> lock(cleanup_mutex_);
+                cleanup_cv_.wait_until(lock, next, [this] { return !cleanup_running_; });
+            }
+            if (!cleanup_running_) break;
+            
+            std::vector<WheelEntry> due;
+            {
+                std::lock_guard<std::mutex> lock(wheel_mutex_);
+                uint64_t now_tick = tick_of(Clock::now());
+                while (current_tick_ < now_tick) {
+                    ++current_tick_;
+                    auto& slot = wheel_[current_tick_ % kWheelSlots];
+                    due.insert(due.end(), std::make_move_iterator(slot.begin()), std::make_move_iterator(slot.end()));
+                    slot.clear();
+                }
+                next = epoch_ + tick_ * static_cast<Clock::rep>(current_tick_ + 1);
+            }
+            expire_slot(due);
+        }
+    }
+    
+public:
+    ConnectionPool(std::chrono::seconds max_idle = std::chrono::seconds(300)) 
+        : max_idle_time_(max_idle),
+          tick_(std::max<Clock::duration>(std::chrono::seconds(1),
+                                          std::chrono::duration_cast<Clock::duration>(max_idle) / (kWheelSlots - 4))),
+          epoch_(Clock::now()), cleanup_running_(true) {
+        cleanup_thread_ = std::thread(&ConnectionPool::cleanup_expired_connections, this);
+    }
+    
+    ~ConnectionPool() {
+        {
+            std::lock_guard<std::mutex> lock(cleanup_mutex_);
+            cleanup_running_ = false;
+        }
+        cleanup_cv_.notify_all();
+        if (cleanup_thread_.joinable()) {
+            cleanup_thread_.join();
         }
+    }
+    
+    void set_default_limits(const HostLimits& limits) {
+        std::lock_guard<std::mutex> lock(limits_mutex_);
+        default_limits_ = limits;
+    }
+    
+    void set_host_limits(const std::string& host, int port, const HostLimits& limits) {
+        std::string key = host_key(host, port);
+        Shard& shard = shards_[shard_of(key)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        HostBucket& bucket = bucket_locked(shard, key);
+        bucket.limits = limits;
+        bucket.returned.notify_all();
+    }
+    
+    // How long get_connection() waits when a host is at max_connections.
+    void set_acquire_timeout(std::chrono::milliseconds timeout) { acquire_timeout_.store(timeout); }
+    
+    // Non-blocking checkout. IDLE hands over a live pooled connection;
+    // OPEN_NEW reserves a slot the caller must fill with a new connection
+    // and later give back through return_connection() or release_slot().
+    Checkout try_checkout(const std::string& host, int port, std::unique_ptr<Socket>& socket,
+                          bool allow_idle = true) {
+        std::string key = host_key(host, port);
+        Shard& shard = shards_[shard_of(key)];
         
+        for (;;) {
+            std::unique_ptr<Socket> candidate;
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                HostBucket& bucket = bucket_locked(shard, key);
+                if (!allow_idle || bucket.idle.empty()) {
+                    if (bucket.at_limit()) {
+                        return Checkout::AT_LIMIT;
+                    }
+                    bucket.checked_out++;
+                    return Checkout::OPEN_NEW;
+                }
+                candidate = std::move(bucket.idle.back().socket);
+                bucket.idle.pop_back();
+                bucket.checked_out++;
+            }
+            
+            if (candidate->is_reusable()) {
+                ++reused_;
+                socket = std::move(candidate);
+                return Checkout::IDLE;
+            }
+            
+            // Dead connection: close it outside the lock and try the next.
+            candidate.reset();
+            release_slot(host, port);
+        }
+    }
+    
+    // Hands out an idle connection to host:port when one is still alive,
+    // otherwise opens a new one. `reused` tells the caller which happened.
+    // At max_connections this waits for a return, up to the acquire timeout.
+    std::unique_ptr<Socket> get_connection(const std::string& host, int port, bool* reused = nullptr) {
+        std::string key = host_key(host, port);
+        Shard& shard = shards_[shard_of(key)];
+        auto deadline = Clock::now() + acquire_timeout_.load();
         
-        while (std::getline(stream, line) && line != "\r") {
-            auto colon_pos = line.find(':');
-            if (colon_pos != std::string::npos) {
-                std::string key = line.substr(0, colon_pos);
-                std::string value = line.substr(colon_pos + 2); 
-                value.pop_back(); 
-                response.headers[key] = value;
+        for (;;) {
+            std::unique_ptr<Socket> socket;
+            Checkout result = try_checkout(host, port, socket);
+            if (result == Checkout::IDLE) {
+                if (reused) *reused = true;
+                return socket;
+            }
+            
+            if (result == Checkout::OPEN_NEW) {
+                socket = std::make_unique<Socket>();
+                if (socket->connect(host, port)) {
+                    ++opened_;
+                    if (reused) *reused = false;
+                    return socket;
+                }
+                release_slot(host, port);
+                return nullptr;
+            }
+            
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            HostBucket& bucket = bucket_locked(shard, key);
+            if (!bucket.returned.wait_until(lock, deadline, [&bucket] {
+                    return !bucket.idle.empty() || !bucket.at_limit();
+                })) {
+                return nullptr;
             }
         }
-        
-        
-        std::ostringstream body_stream;
-        while (std::getline(stream, line)) {
-            body_stream << line << "\n";
+    }
+    
+    void record_opened() { ++opened_; }
+    
+    // Gives back a slot from try_checkout() whose connection never opened.
+    void release_slot(const std::string& host, int port) {
+        std::string key = host_key(host, port);
+        Shard& shard = shards_[shard_of(key)];
+        HostBucket* bucket;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            bucket = &bucket_locked(shard, key);
+            if (bucket->checked_out > 0) bucket->checked_out--;
+        }
+        bucket->returned.notify_one();
+    }
+    
+    // Every checked-out socket must come back here, reusable or not, so
+    // the per-host counts stay right; HttpClient's ConnectionLease does this
+    // on every exit path. Disconnected sockets only free the slot.
+    void return_connection(std::unique_ptr<Socket> socket) {
+        if (!socket) return;
+        
+        std::string key = host_key(socket->get_host(), socket->get_port());
+        size_t shard_index = shard_of(key);
+        Shard& shard = shards_[shard_index];
+        auto now = Clock::now();
+        HostBucket* bucket;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            bucket = &bucket_locked(shard, key);
+            if (bucket->checked_out > 0) bucket->checked_out--;
+            
+            if (socket->is_connected() && bucket->idle.size() < bucket->limits.max_idle) {
+                bucket->idle.push_back({std::move(socket), now});
+                schedule_expiry_locked(shard_index, *bucket, bucket->idle.front().last_used);
+            }
+        }
+        bucket->returned.notify_one();
+    }
+    
+    // Opens connections until host:port has min_idle idle ones.
+    size_t prewarm(const std::string& host, int port) {
+        size_t opened = 0;
+        for (;;) {
+            std::string key = host_key(host, port);
+            Shard& shard = shards_[shard_of(key)];
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                HostBucket& bucket = bucket_locked(shard, key);
+                if (bucket.idle.size() >= bucket.limits.min_idle || bucket.at_limit()) {
+                    return opened;
+                }
+                bucket.checked_out++;
+            }
+            
+            auto socket = std::make_unique<Socket>();
+            if (!socket->connect(host, port)) {
+                release_slot(host, port);
+                return opened;
+            }
+            ++opened_;
+            ++opened;
+            return_connection(std::move(socket));
+        }
+    }
+    
+    size_t size() const {
+        size_t total = 0;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const auto& [key, bucket] : shard.buckets) {
+                total += bucket.idle.size();
+            }
+        }
+        return total;
+    }
+    
+    size_t checked_out(const std::string& host, int port) {
+        std::string key = host_key(host, port);
+        Shard& shard = shards_[shard_of(key)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return bucket_locked(shard, key).checked_out;
+    }
+    
+    size_t connections_opened() const { return opened_; }
+    size_t connections_reused() const { return reused_; }
+};
+
+
+#ifdef __linux__
+// Single-threaded reactor that multiplexes many non-blocking HTTP exchanges
+// over epoll, so an in-flight request costs a socket rather than a thread.
+// Requests arrive through a locked queue and an eventfd wakeup; everything
+// else runs on the loop thread.
+class AsyncHttpEngine {
+public:
+    struct Request {
+        std::string host;
+        int port = 80;
+        std::string payload;
+        bool head_request = false;
+        bool idempotent = true;
+        std::chrono::milliseconds timeout{30000};
+    };
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    enum class Phase { CONNECTING, SENDING, RECEIVING };
+    
+    struct Operation {
+        Request request;
+        sockaddr_in address{};
+        std::promise<HttpResponse> promise;
+        std::unique_ptr<Socket> socket;
+        ResponseParser parser;
+        Phase phase = Phase::CONNECTING;
+        size_t bytes_sent = 0;
+        size_t bytes_received = 0;
+        bool reused = false;
+        int attempt = 0;
+        Clock::time_point deadline;
+        std::multimap<Clock::time_point, Operation*>::iterator timer;
+    };
+    
+    std::shared_ptr<ConnectionPool> pool_;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::mutex submit_mutex_;
+    std::vector<std::unique_ptr<Operation>> submitted_;
+    std::unordered_map<int, std::unique_ptr<Operation>> active_;
+    std::multimap<Clock::time_point, Operation*> timers_;
+    std::vector<std::unique_ptr<Operation>> parked_;
+    std::mutex resolve_mutex_;
+    std::unordered_map<std::string, sockaddr_in> resolved_;
+    std::atomic<bool> running_{true};
+    std::atomic<size_t> in_flight_{0};
+    std::thread loop_thread_;
+    char read_buffer_[65536];
+    
+    // Resolution is blocking, so it runs on the submitting thread and is
+    // cached; the loop thread never waits on DNS.
+    bool resolve_cached(const std::string& host, int port, sockaddr_in& address) {
+        std::string key = host + ":" + std::to_string(port);
+        {
+            std::lock_guard<std::mutex> lock(resolve_mutex_);
+            auto it = resolved_.find(key);
+            if (it != resolved_.end()) {
+                address = it->second;
+                return true;
+            }
+        }
+        if (!Socket::resolve(host, port, address)) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(resolve_mutex_);
+        resolved_[key] = address;
+        return true;
+    }
+    
+    void wake() {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+    
+    void watch(Operation& op, uint32_t events) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = op.socket->native_handle();
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, event.data.fd, &event);
+    }
+    
+    std::unique_ptr<Operation> detach(Operation& op) {
+        int fd = op.socket->native_handle();
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        timers_.erase(op.timer);
+        auto it = active_.find(fd);
+        auto owned = std::move(it->second);
+        active_.erase(it);
+        return owned;
+    }
+    
+    void reject(std::unique_ptr<Operation> op, const std::string& message) {
+        if (op->socket) {
+            op->socket->disconnect();
+            pool_->return_connection(std::move(op->socket));
+        }
+        op->promise.set_exception(std::make_exception_ptr(std::runtime_error(message)));
+        --in_flight_;
+    }
+    
+    void start(std::unique_ptr<Operation> op) {
+        const Request& request = op->request;
+        
+        std::unique_ptr<Socket> idle;
+        ConnectionPool::Checkout checkout = pool_->try_checkout(request.host, request.port, idle, op->attempt == 0);
+        if (checkout == ConnectionPool::Checkout::AT_LIMIT) {
+            parked_.push_back(std::move(op));
+            return;
+        }
+        
+        if (checkout == ConnectionPool::Checkout::IDLE) {
+            op->socket = std::move(idle);
+            op->reused = true;
+            op->phase = Phase::SENDING;
+            if (!op->socket->set_non_blocking(true)) {
+                reject(std::move(op), "Failed to configure socket");
+                return;
+            }
+        } else {
+            op->reused = false;
+            op->socket = std::make_unique<Socket>();
+            if (!op->socket->connect_async(op->address, request.host, request.port)) {
+                pool_->release_slot(request.host, request.port);
+                op->socket.reset();
+                reject(std::move(op), "Failed to connect to " + request.host + ":" + std::to_string(request.port));
+                return;
+            }
+            pool_->record_opened();
+            op->phase = Phase::CONNECTING;
+        }
+        
+        int fd = op->socket->native_handle();
+        epoll_event event{};
+        event.events = EPOLLOUT;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            reject(std::move(op), "Failed to register socket");
+            return;
+        }
+        op->timer = timers_.emplace(op->deadline, op.get());
+        active_[fd] = std::move(op);
+    }
+    
+    void fail(Operation& op, const std::string& message, bool allow_retry = true) {
+        auto owned = detach(op);
+        
+        // The server may close an idle pooled connection at any time; if
+        // nothing came back yet, an idempotent request is safe to resend.
+        if (allow_retry && owned->reused && owned->request.idempotent &&
+            owned->attempt == 0 && owned->bytes_received == 0) {
+            owned->socket->disconnect();
+            pool_->return_connection(std::move(owned->socket));
+            owned->attempt++;
+            owned->bytes_sent = 0;
+            owned->parser = ResponseParser(owned->request.head_request);
+            start(std::move(owned));
+            return;
+        }
+        reject(std::move(owned), message);
+    }
+    
+    void complete(Operation& op, bool trailing_data) {
+        auto owned = detach(op);
+        HttpResponse response = owned->parser.take();
+        
+        if (!response.keep_alive || trailing_data || !owned->socket->set_non_blocking(false)) {
+            owned->socket->disconnect();
+        }
+        pool_->return_connection(std::move(owned->socket));
+        owned->promise.set_value(std::move(response));
+        --in_flight_;
+    }
+    
+    // Returns true once the whole request is written.
+    bool send_pending(Operation& op) {
+        const std::string& payload = op.request.payload;
+        while (op.bytes_sent < payload.size()) {
+            ssize_t sent = op.socket->send_some(payload.data() + op.bytes_sent, payload.size() - op.bytes_sent);
+            if (sent > 0) {
+                op.bytes_sent += static_cast<size_t>(sent);
+                continue;
+            }
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                watch(op, EPOLLOUT);
+                return false;
+            }
+            fail(op, "Failed to send request");
+            return false;
+        }
+        op.phase = Phase::RECEIVING;
+        watch(op, EPOLLIN);
+        return true;
+    }
+    
+    void receive_available(Operation& op) {
+        for (;;) {
+            ssize_t received = op.socket->receive_some(read_buffer_, sizeof(read_buffer_));
+            if (received > 0) {
+                size_t length = static_cast<size_t>(received);
+                op.bytes_received += length;
+                size_t used = op.parser.feed(read_buffer_, length);
+                if (op.parser.done()) {
+                    complete(op, used < length);
+                    return;
+                }
+                continue;
+            }
+            if (received == 0) {
+                op.parser.finish();
+                complete(op, false);
+                return;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                fail(op, "Connection error while receiving");
+            }
+            return;
+        }
+    }
+    
+    void on_ready(Operation& op, uint32_t events) {
+        try {
+            if (op.phase == Phase::CONNECTING) {
+                Socket::ConnectStatus status = op.socket->finish_connect();
+                if (status == Socket::ConnectStatus::PENDING) {
+                    return;
+                }
+                if (status == Socket::ConnectStatus::FAILED) {
+                    fail(op, "Failed to connect to " + op.request.host + ":" + std::to_string(op.request.port));
+                    return;
+                }
+                op.phase = Phase::SENDING;
+            }
+            if (op.phase == Phase::SENDING) {
+                send_pending(op);
+                return;
+            }
+            if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                receive_available(op);
+            }
+        } catch (const std::exception& e) {
+            fail(op, e.what());
+        }
+    }
+    
+    void accept_submissions() {
+        std::vector<std::unique_ptr<Operation>> batch;
+        {
+            std::lock_guard<std::mutex> lock(submit_mutex_);
+            batch.swap(submitted_);
+        }
+        for (auto& op : batch) {
+            start(std::move(op));
+        }
+    }
+    
+    void expire_timers() {
+        auto now = Clock::now();
+        while (!timers_.empty() && timers_.begin()->first <= now) {
+            fail(*timers_.begin()->second, "Request timed out", false);
+        }
+    }
+    
+    // Requests parked because their host is at max_connections are retried
+    // on a short poll, since the pool has no way to wake the loop.
+    static constexpr int kParkedPollMs = 5;
+    
+    void retry_parked() {
+        if (parked_.empty()) return;
+        std::vector<std::unique_ptr<Operation>> parked;
+        parked.swap(parked_);
+        auto now = Clock::now();
+        for (auto& op : parked) {
+            if (op->deadline <= now) {
+                reject(std::move(op), "Request timed out");
+            } else {
+                start(std::move(op));
+            }
+        }
+    }
+    
+    int next_timeout_ms() const {
+        if (!parked_.empty()) return kParkedPollMs;
+        if (timers_.empty()) return -1;
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(timers_.begin()->first - Clock::now());
+        return static_cast<int>(std::max<std::chrono::milliseconds::rep>(0, wait.count() + 1));
+    }
+    
+    void run() {
+        epoll_event events[128];
+        while (running_) {
+            int ready = epoll_wait(epoll_fd_, events, 128, next_timeout_ms());
+            for (int i = 0; i < ready; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == wake_fd_) {
+                    uint64_t count;
+                    ssize_t ignored = ::read(wake_fd_, &count, sizeof(count));
+                    (void)ignored;
+                    accept_submissions();
+                    continue;
+                }
+                auto it = active_.find(fd);
+                if (it != active_.end()) {
+                    on_ready(*it->second, events[i].events);
+                }
+            }
+            expire_timers();
+            retry_parked();
+        }
+        
+        accept_submissions();
+        for (auto& op : parked_) {
+            reject(std::move(op), "Async engine stopped");
+        }
+        parked_.clear();
+        while (!active_.empty()) {
+            fail(*active_.begin()->second, "Async engine stopped", false);
+        }
+    }
+    
+public:
+    explicit AsyncHttpEngine(std::shared_ptr<ConnectionPool> pool) : pool_(std::move(pool)) {
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epoll_fd_ < 0 || wake_fd_ < 0) {
+            if (epoll_fd_ >= 0) close(epoll_fd_);
+            if (wake_fd_ >= 0) close(wake_fd_);
+            throw std::runtime_error("Failed to create event loop");
+        }
+        
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = wake_fd_;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+        loop_thread_ = std::thread(&AsyncHttpEngine::run, this);
+    }
+    
+    ~AsyncHttpEngine() {
+        running_ = false;
+        wake();
+        if (loop_thread_.joinable()) {
+            loop_thread_.join();
+        }
+        close(wake_fd_);
+        close(epoll_fd_);
+    }
+    
+    AsyncHttpEngine(const AsyncHttpEngine&) = delete;
+    AsyncHttpEngine& operator=(const AsyncHttpEngine&) = delete;
+    
+    std::future<HttpResponse> submit(Request request) {
+        auto op = std::make_unique<Operation>();
+        auto future = op->promise.get_future();
+        
+        if (!running_ || !resolve_cached(request.host, request.port, op->address)) {
+            op->promise.set_exception(std::make_exception_ptr(
+                std::runtime_error(running_ ? "Failed to resolve " + request.host : "Async engine stopped")));
+            return future;
+        }
+        
+        op->parser = ResponseParser(request.head_request);
+        op->deadline = Clock::now() + request.timeout;
+        op->request = std::move(request);
+        ++in_flight_;
+        {
+            std::lock_guard<std::mutex> lock(submit_mutex_);
+            submitted_.push_back(std::move(op));
+        }
+        wake();
+        return future;
+    }
+    
+    size_t in_flight() const { return in_flight_; }
+};
+#endif
+
+
+class HttpClient {
+private:
+    std::shared_ptr<ConnectionPool> pool_;
+    std::chrono::seconds timeout_;
+    std::map<std::string, std::string> default_headers_;
+#ifdef __linux__
+    std::once_flag engine_once_;
+    std::unique_ptr<AsyncHttpEngine> engine_;
+    
+    AsyncHttpEngine& engine() {
+        std::call_once(engine_once_, [this] { engine_ = std::make_unique<AsyncHttpEngine>(pool_); });
+        return *engine_;
+    }
+#endif
+    
+    struct Endpoint {
+        std::string host;
+        int port = 80;
+        std::string path;
+    };
+    
+    static Endpoint parse_url(const std::string& url) {
+        Endpoint endpoint;
+        
+        if (url.substr(0, 7) == "http://") {
+            auto url_part = url.substr(7);
+            auto path_pos = url_part.find('/');
+            if (path_pos != std::string::npos) {
+                endpoint.host = url_part.substr(0, path_pos);
+                endpoint.path = url_part.substr(path_pos);
+            } else {
+                endpoint.host = url_part;
+                endpoint.path = "/";
+            }
+            
+            auto port_pos = endpoint.host.find(':');
+            if (port_pos != std::string::npos) {
+                endpoint.port = std::stoi(endpoint.host.substr(port_pos + 1));
+                endpoint.host = endpoint.host.substr(0, port_pos);
+            }
+        }
+        
+        if (endpoint.host.empty()) {
+            throw std::invalid_argument("Invalid URL format");
+        }
+        return endpoint;
+    }
+    
+    std::string build_request(const std::string& method, const std::string& path,
+                            const std::map<std::string, std::string>& headers,
+                            const std::string& body = "") {
+        std::ostringstream request;
+        request << method << " " << path << " HTTP/1.1\r\n";
+        
+        
+        for (const auto& [key, value] : default_headers_) {
+            if (!find_header(headers, key)) {
+                request << key << ": " << value << "\r\n";
+            }
+        }
+        
+        
+        for (const auto& [key, value] : headers) {
+            request << key << ": " << value << "\r\n";
+        }
+        
+        if (!body.empty()) {
+            request << "Content-Length: " << body.length() << "\r\n";
+        }
+        
+        request << "\r\n" << body;
+        return request.str();
+    }
+    
+    std::map<std::string, std::string> with_host(const std::map<std::string, std::string>& headers,
+                                                 const Endpoint& endpoint) const {
+        auto updated_headers = headers;
+        updated_headers["Host"] = endpoint.port == 80
+            ? endpoint.host
+            : endpoint.host + ":" + std::to_string(endpoint.port);
+        return updated_headers;
+    }
+    
+    static bool is_idempotent(const std::string& method) {
+        return method != "POST" && method != "PATCH";
+    }
+    
+    // A checked-out socket for one exchange. Whichever way the scope is
+    // left, the socket goes back to the pool, so an exception cannot leak
+    // the host's checked-out slot; a lease never released is discarded.
+    class ConnectionLease {
+    private:
+        ConnectionPool& pool_;
+        std::unique_ptr<Socket> socket_;
+        
+    public:
+        ConnectionLease(ConnectionPool& pool, std::unique_ptr<Socket> socket)
+            : pool_(pool), socket_(std::move(socket)) {}
+        ~ConnectionLease() { release(false); }
+        
+        ConnectionLease(const ConnectionLease&) = delete;
+        ConnectionLease& operator=(const ConnectionLease&) = delete;
+        
+        Socket& operator*() const { return *socket_; }
+        Socket* operator->() const { return socket_.get(); }
+        
+        void release(bool reusable) {
+            if (!socket_) return;
+            if (!reusable) {
+                socket_->disconnect();
+            }
+            pool_.return_connection(std::move(socket_));
+        }
+    };
+    
+    ConnectionLease checkout(const Endpoint& endpoint, bool& reused) {
+        auto socket = pool_->get_connection(endpoint.host, endpoint.port, &reused);
+        if (!socket) {
+            throw std::runtime_error("Failed to connect to " + endpoint.host + ":" + std::to_string(endpoint.port));
+        }
+        socket->set_timeout(timeout_);
+        return ConnectionLease(*pool_, std::move(socket));
+    }
+    
+public:
+    HttpClient() : HttpClient(std::make_shared<ConnectionPool>()) {}
+    
+    explicit HttpClient(std::shared_ptr<ConnectionPool> pool)
+        : pool_(std::move(pool)), timeout_(std::chrono::seconds(30)) {
+        default_headers_["User-Agent"] = "CustomHttpClient/1.0";
+        default_headers_["Connection"] = "keep-alive";
+    }
+    
+    void set_timeout(std::chrono::seconds timeout) {
+        timeout_ = timeout;
+    }
+    
+    void set_default_header(const std::string& key, const std::string& value) {
+        default_headers_[key] = value;
+    }
+    
+    ConnectionPool& get_pool() { return *pool_; }
+    
+    std::future<HttpResponse> get_async(const std::string& url) {
+        return request_async("GET", url, {});
+    }
+    
+    // On Linux the request runs on the client's epoll loop; elsewhere it
+    // falls back to a thread per request.
+    std::future<HttpResponse> request_async(const std::string& method, const std::string& url,
+                                            const std::map<std::string, std::string>& headers,
+                                            const std::string& body = "") {
+#ifdef __linux__
+        Endpoint endpoint = parse_url(url);
+        AsyncHttpEngine::Request request;
+        request.host = endpoint.host;
+        request.port = endpoint.port;
+        request.payload = build_request(method, endpoint.path, with_host(headers, endpoint), body);
+        request.head_request = method == "HEAD";
+        request.idempotent = is_idempotent(method);
+        request.timeout = timeout_;
+        return engine().submit(std::move(request));
+#else
+        return std::async(std::launch::async, [this, method, url, headers, body]() {
+            return this->request(method, url, headers, body);
+        });
+#endif
+    }
+    
+    HttpResponse get(const std::string& url) {
+        return request("GET", url, {});
+    }
+    
+    HttpResponse post(const std::string& url, const std::string& data, 
+                     const std::string& content_type = "application/json") {
+        std::map<std::string, std::string> headers;
+        headers["Content-Type"] = content_type;
+        return request("POST", url, headers, data);
+    }
+    
+    HttpResponse request(const std::string& method, const std::string& url,
+                        const std::map<std::string, std::string>& headers,
+                        const std::string& body = "") {
+        return execute(method, url, headers, body, nullptr);
+    }
+    
+    // Like request(), but a successful response body goes to `sink` as it
+    // is received rather than into HttpResponse::body.
+    HttpResponse stream(const std::string& method, const std::string& url,
+                        const std::map<std::string, std::string>& headers, const BodySink& sink) {
+        return execute(method, url, headers, "", &sink);
+    }
+    
+private:
+    HttpResponse execute(const std::string& method, const std::string& url,
+                         const std::map<std::string, std::string>& headers,
+                         const std::string& body, const BodySink* sink) {
+        Endpoint endpoint = parse_url(url);
+        std::string request_str = build_request(method, endpoint.path, with_host(headers, endpoint), body);
+        bool idempotent = is_idempotent(method);
+        
+        for (int attempt = 0; ; ++attempt) {
+            bool reused = false;
+            auto socket = checkout(endpoint, reused);
+            
+            // A pooled connection may have been closed by the server after
+            // the liveness check; such a request is retried once on a fresh
+            // connection if nothing came back yet.
+            bool can_retry = reused && idempotent && attempt == 0;
+            
+            if (!socket->send_all(request_str)) {
+                socket.release(false);
+                if (can_retry) continue;
+                throw std::runtime_error("Failed to send request");
+            }
+            
+            ResponseReader reader(*socket);
+            try {
+                HttpResponse response = reader.read(method == "HEAD", sink);
+                socket.release(response.keep_alive && !reader.has_buffered_data());
+                return response;
+            } catch (const std::runtime_error&) {
+                socket.release(false);
+                if (can_retry && reader.bytes_received() == 0) continue;
+                throw;
+            }
+        }
+    }
+    
+public:
+    // Sends every GET on one connection before reading any response. All
+    // URLs must share host and port. If the server closes the connection
+    // part way, the remaining requests are issued one at a time.
+    std::vector<HttpResponse> pipeline(const std::vector<std::string>& urls) {
+        std::vector<HttpResponse> responses;
+        if (urls.empty()) return responses;
+        
+        Endpoint endpoint = parse_url(urls.front());
+        std::string batch;
+        for (const auto& url : urls) {
+            Endpoint next = parse_url(url);
+            if (next.host != endpoint.host || next.port != endpoint.port) {
+                throw std::invalid_argument("Pipelined requests must share one host");
+            }
+            batch += build_request("GET", next.path, with_host({}, next));
+        }
+        
+        bool reused = false;
+        auto socket = checkout(endpoint, reused);
+        responses.reserve(urls.size());
+        
+        if (socket->send_all(batch)) {
+            ResponseReader reader(*socket);
+            bool keep_alive = true;
+            try {
+                while (responses.size() < urls.size() && keep_alive) {
+                    responses.push_back(reader.read(false));
+                    keep_alive = responses.back().keep_alive;
+                }
+                socket.release(keep_alive && !reader.has_buffered_data());
+            } catch (const std::runtime_error&) {
+                socket.release(false);
+            }
+        } else {
+            socket.release(false);
+        }
+        
+        for (size_t i = responses.size(); i < urls.size(); ++i) {
+            responses.push_back(get(urls[i]));
+        }
+        return responses;
+    }
+};
+
+
+enum class TaskPriority { HIGH = 0, NORMAL = 1 };
+
+
+// Type-erased callable with inline storage, so a typical task is a single
+// recycled node instead of a std::function plus its heap block. Callables
+// that do not fit fall back to a heap copy.
+class TaskNode {
+public:
+    static constexpr size_t kInlineSize = 48;
+    
+private:
+    alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+    void (*invoke_)(TaskNode&) = nullptr;
+    void (*destroy_)(TaskNode&) = nullptr;
+    
+    struct Cache {
+        static constexpr size_t kMaxCached = 1024;
+        std::vector<TaskNode*> free;
+        
+        ~Cache() {
+            for (TaskNode* node : free) {
+                delete node;
+            }
+        }
+    };
+    
+    static Cache& cache() {
+        thread_local Cache local;
+        return local;
+    }
+    
+    template<typename Fn>
+    void emplace(Fn&& fn) {
+        using F = std::decay_t<Fn>;
+        if constexpr (sizeof(F) <= kInlineSize && alignof(F) <= alignof(std::max_align_t)) {
+            new (storage_) F(std::forward<Fn>(fn));
+            invoke_ = [](TaskNode& node) { (*std::launder(reinterpret_cast<F*>(node.storage_)))(); };
+            destroy_ = [](TaskNode& node) { std::launder(reinterpret_cast<F*>(node.storage_))->~F(); };
+        } else {
+            F* heap = new F(std::forward<Fn>(fn));
+            new (storage_) F*(heap);
+            invoke_ = [](TaskNode& node) { (**std::launder(reinterpret_cast<F**>(node.storage_)))(); };
+            destroy_ = [](TaskNode& node) { delete *std::launder(reinterpret_cast<F**>(node.storage_)); };
+        }
+    }
+    
+public:
+    template<typename Fn>
+    static TaskNode* create(Fn&& fn) {
+        Cache& local = cache();
+        TaskNode* node;
+        if (local.free.empty()) {
+            node = new TaskNode;
+        } else {
+            node = local.free.back();
+            local.free.pop_back();
+        }
+        
+        try {
+            node->emplace(std::forward<Fn>(fn));
+        } catch (...) {
+            local.free.push_back(node);
+            throw;
+        }
+        return node;
+    }
+    
+    void run() { invoke_(*this); }
+    
+    // Destroys the callable and keeps the node for this thread's next task.
+    static void recycle(TaskNode* node) {
+        node->destroy_(*node);
+        Cache& local = cache();
+        if (local.free.size() < Cache::kMaxCached) {
+            local.free.push_back(node);
+        } else {
+            delete node;
+        }
+    }
+};
+
+
+// Chase-Lev work-stealing deque (Le et al., "Correct and Efficient
+// Work-Stealing for Weak Memory Models"). Only the owner pushes and pops
+// at the bottom; any thread may steal from the top without a lock.
+class WorkStealingDeque {
+private:
+    struct Ring {
+        int64_t capacity;
+        std::unique_ptr<std::atomic<TaskNode*>[]> slots;
+        
+        explicit Ring(int64_t size) : capacity(size), slots(new std::atomic<TaskNode*>[static_cast<size_t>(size)]) {}
+        
+        TaskNode* get(int64_t index) const {
+            return slots[static_cast<size_t>(index & (capacity - 1))].load(std::memory_order_acquire);
+        }
+        
+        void put(int64_t index, TaskNode* task) {
+            slots[static_cast<size_t>(index & (capacity - 1))].store(task, std::memory_order_release);
+        }
+    };
+    
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    std::atomic<Ring*> ring_;
+    // Thieves may still read a ring that was just replaced, so old rings
+    // live until the deque is destroyed.
+    std::vector<std::unique_ptr<Ring>> rings_;
+    
+    Ring* grow(Ring* old, int64_t top, int64_t bottom) {
+        auto bigger = std::make_unique<Ring>(old->capacity * 2);
+        for (int64_t i = top; i < bottom; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        Ring* raw = bigger.get();
+        rings_.push_back(std::move(bigger));
+        ring_.store(raw, std::memory_order_release);
+        return raw;
+    }
+    
+public:
+    explicit WorkStealingDeque(int64_t capacity = 256) {
+        rings_.push_back(std::make_unique<Ring>(capacity));
+        ring_.store(rings_.back().get(), std::memory_order_relaxed);
+    }
+    
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+    
+    void push(TaskNode* task) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_acquire);
+        Ring* ring = ring_.load(std::memory_order_relaxed);
+        if (bottom - top > ring->capacity - 1) {
+            ring = grow(ring, top, bottom);
+        }
+        ring->put(bottom, task);
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+    
+    TaskNode* pop() {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        Ring* ring = ring_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_seq_cst);
+        
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        
+        TaskNode* task = ring->get(bottom);
+        if (top == bottom) {
+            // Last element: race the thieves for it.
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                task = nullptr;
+            }
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+    
+    TaskNode* steal() {
+        int64_t top = top_.load(std::memory_order_seq_cst);
+        int64_t bottom = bottom_.load(std::memory_order_seq_cst);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        
+        Ring* ring = ring_.load(std::memory_order_acquire);
+        TaskNode* task = ring->get(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return task;
+    }
+    
+    bool empty() const {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+};
+
+
+// Work-stealing thread pool. Tasks posted from a worker go to that
+// worker's own deque; tasks from other threads go through a locked
+// injection queue. Idle workers steal from the top of busy workers'
+// deques. HIGH priority work is always looked for first.
+class WorkStealingPool {
+private:
+    static constexpr size_t kPriorityLevels = 2;
+    
+    struct Worker {
+        WorkStealingDeque deques[kPriorityLevels];
+        std::thread thread;
+    };
+    
+    struct CurrentWorker {
+        const WorkStealingPool* pool = nullptr;
+        size_t index = 0;
+    };
+    
+    static CurrentWorker& current() {
+        thread_local CurrentWorker worker;
+        return worker;
+    }
+    
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex injector_mutex_;
+    std::deque<TaskNode*> injector_[kPriorityLevels];
+    std::atomic<size_t> injector_size_[kPriorityLevels];
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> executed_{0};
+    std::atomic<size_t> stolen_{0};
+    std::atomic<size_t> failed_{0};
+    std::atomic<uint64_t> epoch_{0};
+    std::atomic<size_t> sleepers_{0};
+    std::atomic<bool> stopping_{false};
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    
+    bool is_own_worker() const { return current().pool == this; }
+    
+    TaskNode* pop_injector(size_t level) {
+        if (injector_size_[level].load(std::memory_order_relaxed) == 0) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(injector_mutex_);
+        if (injector_[level].empty()) {
+            return nullptr;
         }
-        response.body = body_stream.str();
-        
-        return response;
+        TaskNode* task = injector_[level].front();
+        injector_[level].pop_front();
+        injector_size_[level].fetch_sub(1, std::memory_order_relaxed);
+        return task;
     }
     
-public:
-    HttpClient() : timeout_(std::chrono::seconds(30)) {
-        default_headers_["User-Agent"] = "CustomHttpClient/1.0";
-        default_headers_["Connection"] = "close";
+    TaskNode* find_task(size_t self) {
+        for (size_t level = 0; level < kPriorityLevels; ++level) {
+            if (TaskNode* task = workers_[self]->deques[level].pop()) {
+                return task;
+            }
+            if (TaskNode* task = pop_injector(level)) {
+                return task;
+            }
+            for (size_t offset = 1; offset < workers_.size(); ++offset) {
+                size_t victim = (self + offset) % workers_.size();
+                if (TaskNode* task = workers_[victim]->deques[level].steal()) {
+                    stolen_.fetch_add(1, std::memory_order_relaxed);
+                    return task;
+                }
+            }
+        }
+        return nullptr;
     }
     
-    void set_timeout(std::chrono::seconds timeout) {
-        timeout_ = timeout;
+    void execute(TaskNode* task) {
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        try {
+            task->run();
+        } catch (...) {
+            failed_.fetch_add(1, std::memory_order_relaxed);
+        }
+        TaskNode::recycle(task);
+        executed_.fetch_add(1, std::memory_order_relaxed);
     }
     
-    void set_default_header(const std::string& key, const std::string& value) {
-        default_headers_[key] = value;
+    // Sleepers re-check the epoch after registering, so either the worker
+    // sees the new epoch or the submitter sees the sleeper (both seq_cst).
+    void wake(size_t count) {
+        epoch_.fetch_add(1);
+        if (sleepers_.load() > 0) {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            if (count == 1) {
+                sleep_cv_.notify_one();
+            } else {
+                sleep_cv_.notify_all();
+            }
+        }
     }
     
-    std::future<HttpResponse> get_async(const std::string& url) {
-        return std::async(std::launch::async, [this, url]() {
-            return this->get(url);
-        });
+    void worker_loop(size_t index) {
+        current() = {this, index};
+        while (!stopping_) {
+            uint64_t epoch = epoch_.load();
+            if (TaskNode* task = find_task(index)) {
+                execute(task);
+                continue;
+            }
+            
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleepers_.fetch_add(1);
+            sleep_cv_.wait(lock, [this, epoch] { return stopping_ || epoch_.load() != epoch; });
+            sleepers_.fetch_sub(1);
+        }
+        current() = {};
     }
     
-    HttpResponse get(const std::string& url) {
-        return request("GET", url, {});
+    void enqueue(TaskNode* task, TaskPriority priority) {
+        size_t level = static_cast<size_t>(priority);
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        if (is_own_worker()) {
+            workers_[current().index]->deques[level].push(task);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(injector_mutex_);
+        injector_[level].push_back(task);
+        injector_size_[level].fetch_add(1, std::memory_order_relaxed);
     }
     
-    HttpResponse post(const std::string& url, const std::string& data, 
-                     const std::string& content_type = "application/json") {
-        std::map<std::string, std::string> headers;
-        headers["Content-Type"] = content_type;
-        return request("POST", url, headers, data);
+public:
+    explicit WorkStealingPool(size_t num_threads = std::thread::hardware_concurrency()) {
+        num_threads = std::max<size_t>(1, num_threads);
+        for (auto& size : injector_size_) {
+            size.store(0);
+        }
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_[i]->thread = std::thread(&WorkStealingPool::worker_loop, this, i);
+        }
     }
     
-    HttpResponse request(const std::string& method, const std::string& url,
-                        const std::map<std::string, std::string>& headers,
-                        const std::string& body = "") {
-        
-        std::string host, path;
-        int port = 80;
-        
-        if (url.substr(0, 7) == "http://") {
-            auto url_part = url.substr(7);
-            auto path_pos = url_part.find('/');
-            if (path_pos != std::string::npos) {
-                host = url_part.substr(0, path_pos);
-                path = url_part.substr(path_pos);
-            } else {
-                host = url_part;
-                path = "/";
-            }
-            
-            auto port_pos = host.find(':');
-            if (port_pos != std::string::npos) {
-                port = std::stoi(host.substr(port_pos + 1));
-                host = host.substr(0, port_pos);
+    // Workers stop after their current task; queued tasks are destroyed
+    // without running.
+    ~WorkStealingPool() {
+        stopping_ = true;
+        wake(workers_.size());
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            sleep_cv_.notify_all();
+        }
+        for (auto& worker : workers_) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
             }
         }
         
-        if (host.empty()) {
-            throw std::invalid_argument("Invalid URL format");
+        for (auto& worker : workers_) {
+            for (auto& deque : worker->deques) {
+                while (TaskNode* task = deque.steal()) {
+                    TaskNode::recycle(task);
+                }
+            }
         }
-        
-        
-        if (!socket_.connect(host, port)) {
-            throw std::runtime_error("Failed to connect to " + host + ":" + std::to_string(port));
+        for (auto& queue : injector_) {
+            for (TaskNode* task : queue) {
+                TaskNode::recycle(task);
+            }
         }
-        
-        auto updated_headers = headers;
-        updated_headers["Host"] = host;
-        
-        std::string request_str = build_request(method, path, updated_headers, body);
-        
-        if (socket_.send(request_str) <= 0) {
-            throw std::runtime_error("Failed to send request");
+    }
+    
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    
+    template<typename Fn>
+    void post(Fn&& fn, TaskPriority priority = TaskPriority::NORMAL) {
+        enqueue(TaskNode::create(std::forward<Fn>(fn)), priority);
+        wake(1);
+    }
+    
+    // Enqueues a range of callables with one injector lock and one wakeup.
+    template<typename It>
+    void post_batch(It first, It last, TaskPriority priority = TaskPriority::NORMAL) {
+        size_t level = static_cast<size_t>(priority);
+        size_t count = 0;
+        if (is_own_worker()) {
+            for (; first != last; ++first, ++count) {
+                workers_[current().index]->deques[level].push(TaskNode::create(std::move(*first)));
+            }
+            pending_.fetch_add(count, std::memory_order_relaxed);
+        } else {
+            std::vector<TaskNode*> tasks;
+            for (; first != last; ++first) {
+                tasks.push_back(TaskNode::create(std::move(*first)));
+            }
+            count = tasks.size();
+            pending_.fetch_add(count, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(injector_mutex_);
+            injector_[level].insert(injector_[level].end(), tasks.begin(), tasks.end());
+            injector_size_[level].fetch_add(count, std::memory_order_relaxed);
         }
-        
-        
-        std::string response_data = socket_.receive(8192);
-        socket_.disconnect();
-        
-        if (response_data.empty()) {
-            throw std::runtime_error("No response received");
+        if (count > 0) {
+            wake(count);
         }
-        
-        return parse_response(response_data);
     }
+    
+    template<typename Fn>
+    auto submit(Fn&& fn, TaskPriority priority = TaskPriority::NORMAL)
+        -> std::future<std::invoke_result_t<std::decay_t<Fn>&>> {
+        using Result = std::invoke_result_t<std::decay_t<Fn>&>;
+        auto promise = std::make_shared<std::promise<Result>>();
+        auto future = promise->get_future();
+        post([promise, fn = std::forward<Fn>(fn)]() mutable {
+            try {
+                if constexpr (std::is_void_v<Result>) {
+                    fn();
+                    promise->set_value();
+                } else {
+                    promise->set_value(fn());
+                }
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        }, priority);
+        return future;
+    }
+    
+    size_t thread_count() const { return workers_.size(); }
+    size_t pending() const { return pending_.load(std::memory_order_relaxed); }
+    size_t executed() const { return executed_.load(std::memory_order_relaxed); }
+    size_t stolen() const { return stolen_.load(std::memory_order_relaxed); }
+    size_t failed() const { return failed_.load(std::memory_order_relaxed); }
 };
 
 
-class ConnectionPool {
+// File written by offset, so ranged parts can land in parallel without a
+// shared seek position.
+class OutputFile {
 private:
-    struct PooledConnection {
-        std::unique_ptr<Socket> socket;
-        std::chrono::steady_clock::time_point last_used;
-        std::string host;
-        int port;
-    };
-    
-    std::vector<PooledConnection> pool_;
-    mutable std::mutex pool_mutex_;
-    std::chrono::seconds max_idle_time_;
-    std::atomic<bool> cleanup_running_;
-    std::thread cleanup_thread_;
+#ifdef _WIN32
+    FILE* file_;
+    std::mutex file_mutex_;
+#else
+    int fd_;
+#endif
     
-    void cleanup_expired_connections() {
-        while (cleanup_running_) {
-            {
-                std::lock_guard<std::mutex> lock(pool_mutex_);
-                auto now = std::chrono::steady_clock::now();
-                
-                pool_.erase(
-                    std::remove_if(pool_.begin(), pool_.end(),
-                        [this, now](const PooledConnection& conn) {
-                            return now - conn.last_used > max_idle_time_;
-                        }),
-                    pool_.end()
-                );
-            }
-            
-            std::this_thread::sleep_for(std::chrono::seconds(10));
+public:
+    explicit OutputFile(const std::string& path) {
+#ifdef _WIN32
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) {
+#else
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+#endif
+            throw std::runtime_error("Failed to open " + path);
         }
     }
     
-public:
-    ConnectionPool(std::chrono::seconds max_idle = std::chrono::seconds(300)) 
-        : max_idle_time_(max_idle), cleanup_running_(true) {
-        cleanup_thread_ = std::thread(&ConnectionPool::cleanup_expired_connections, this);
+    ~OutputFile() {
+#ifdef _WIN32
+        std::fclose(file_);
+#else
+        ::close(fd_);
+#endif
     }
     
-    ~ConnectionPool() {
-        cleanup_running_ = false;
-        if (cleanup_thread_.joinable()) {
-            cleanup_thread_.join();
-        }
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+    
+    bool resize(uint64_t size) {
+#ifdef _WIN32
+        (void)size;
+        return true;
+#else
+        return ::ftruncate(fd_, static_cast<off_t>(size)) == 0;
+#endif
     }
     
-    std::unique_ptr<Socket> get_connection(const std::string& host, int port) {
-        {
-            std::lock_guard<std::mutex> lock(pool_mutex_);
-            
-            auto it = std::find_if(pool_.begin(), pool_.end(),
-                [&host, port](const PooledConnection& conn) {
-                    return conn.host == host && conn.port == port && conn.socket->is_connected();
-                });
-            
-            if (it != pool_.end()) {
-                auto socket = std::move(it->socket);
-                pool_.erase(it);
-                return socket;
-            }
-        }
-        
-        
-        auto socket = std::make_unique<Socket>();
-        if (socket->connect(host, port)) {
-            return socket;
+    bool write_at(uint64_t offset, const char* data, size_t size) {
+#ifdef _WIN32
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        return _fseeki64(file_, static_cast<long long>(offset), SEEK_SET) == 0 &&
+               std::fwrite(data, 1, size, file_) == size;
+#else
+        while (size > 0) {
+            ssize_t written = ::pwrite(fd_, data, size, static_cast<off_t>(offset));
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return false;
+            data += written;
+            size -= static_cast<size_t>(written);
+            offset += static_cast<uint64_t>(written);
         }
-        
-        return nullptr;
+        return true;
+#endif
     }
+};
+
+
+struct DownloadProgress {
+    using Clock = std::chrono::steady_clock;
     
-    void return_connection(std::unique_ptr<Socket> socket) {
-        if (socket && socket->is_connected()) {
-            std::lock_guard<std::mutex> lock(pool_mutex_);
-            
-            PooledConnection conn;
-            conn.socket = std::move(socket);
-            conn.last_used = std::chrono::steady_clock::now();
-            conn.host = conn.socket->get_host();
-            conn.port = conn.socket->get_port();
-            
-            pool_.push_back(std::move(conn));
+    std::string url;
+    std::string filename;
+    std::atomic<uint64_t> total_bytes{0};
+    std::atomic<uint64_t> received_bytes{0};
+    std::atomic<size_t> parts{1};
+    std::atomic<size_t> parts_done{0};
+    std::atomic<bool> finished{false};
+    std::atomic<bool> succeeded{false};
+    Clock::time_point started = Clock::now();
+    std::atomic<int64_t> finished_after_us{0};
+    
+    double elapsed_seconds() const {
+        if (finished) {
+            return finished_after_us / 1e6;
         }
+        return std::chrono::duration<double>(Clock::now() - started).count();
     }
     
-    size_t size() const {
-        std::lock_guard<std::mutex> lock(pool_mutex_);
-        return pool_.size();
+    double bytes_per_second() const {
+        double seconds = elapsed_seconds();
+        return seconds > 0 ? received_bytes / seconds : 0.0;
+    }
+    
+    void finish(bool success) {
+        finished_after_us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count();
+        succeeded = success;
+        finished = true;
     }
 };
 
 
 class DownloadManager {
+public:
+    // Files at least this large are split into Range requests when the
+    // server advertises byte ranges.
+    static constexpr uint64_t kRangedThreshold = 4 * 1024 * 1024;
+    static constexpr uint64_t kMinPartSize = 1024 * 1024;
+    
+    struct DownloadHandle {
+        std::future<bool> result;
+        std::shared_ptr<const DownloadProgress> progress;
+    };
+    
 private:
-    std::unique_ptr<ConnectionPool> pool_;
-    std::vector<std::thread> worker_threads_;
-    std::queue<std::function<void()>> task_queue_;
-    mutable std::mutex queue_mutex_;
-    std::condition_variable queue_cv_;
-    std::atomic<bool> shutdown_;
-    
-    void worker_loop() {
-        while (!shutdown_) {
-            std::function<void()> task;
-            
-            {
-                std::unique_lock<std::mutex> lock(queue_mutex_);
-                queue_cv_.wait(lock, [this] { return !task_queue_.empty() || shutdown_; });
-                
-                if (shutdown_) break;
-                
-                task = std::move(task_queue_.front());
-                task_queue_.pop();
+    // Shared by the parts of one download; the last part to finish
+    // publishes the result.
+    struct Transfer {
+        std::string url;
+        std::string filename;
+        std::shared_ptr<DownloadProgress> progress;
+        std::promise<bool> promise;
+        std::unique_ptr<OutputFile> file;
+        std::atomic<size_t> pending{1};
+        std::atomic<bool> failed{false};
+        
+        void finish_part(bool ok) {
+            if (!ok) failed = true;
+            progress->parts_done++;
+            if (--pending == 0) {
+                file.reset();
+                bool success = !failed;
+                if (!success) {
+                    std::remove(filename.c_str());
+                }
+                progress->finish(success);
+                promise.set_value(success);
             }
-            
-            try {
-                task();
-            } catch (const std::exception& e) {
-                std::cout << "Worker thread error: " << e.what() << "\n";
+        }
+    };
+    
+    std::shared_ptr<ConnectionPool> pool_;
+    HttpClient client_;
+    mutable std::mutex downloads_mutex_;
+    std::vector<std::shared_ptr<DownloadProgress>> downloads_;
+    // Declared last so workers stop before the client and pool go away.
+    std::shared_ptr<WorkStealingPool> scheduler_;
+    
+    // Streams one part straight from the socket buffer into the file.
+    // `last` is inclusive; a non-ranged part takes the whole body.
+    void fetch_part(const std::shared_ptr<Transfer>& transfer, uint64_t first, uint64_t last, bool ranged) {
+        bool ok = false;
+        try {
+            std::map<std::string, std::string> headers;
+            if (ranged) {
+                headers["Range"] = "bytes=" + std::to_string(first) + "-" + std::to_string(last);
             }
+            
+            uint64_t offset = first;
+            DownloadProgress& progress = *transfer->progress;
+            auto response = client_.stream("GET", transfer->url, headers,
+                [&](const char* data, size_t size) {
+                    if (ranged && offset + size > last + 1) {
+                        return false;
+                    }
+                    if (!transfer->file->write_at(offset, data, size)) {
+                        return false;
+                    }
+                    offset += size;
+                    progress.received_bytes += size;
+                    return true;
+                });
+            
+            ok = ranged ? response.status_code == 206 && offset == last + 1 : response.is_success();
+        } catch (const std::exception&) {
+            ok = false;
         }
+        transfer->finish_part(ok);
     }
     
-public:
-    DownloadManager(size_t num_threads = std::thread::hardware_concurrency()) 
-        : pool_(std::make_unique<ConnectionPool>()), shutdown_(false) {
+    void start_transfer(const std::shared_ptr<Transfer>& transfer) {
+        uint64_t size = 0;
+        bool ranged = false;
+        try {
+            auto head = client_.request("HEAD", transfer->url, {});
+            const std::string* length = find_header(head.headers, "Content-Length");
+            const std::string* ranges = find_header(head.headers, "Accept-Ranges");
+            if (head.is_success() && length) {
+                size = std::stoull(*length);
+                ranged = ranges && header_contains(*ranges, "bytes") && size >= kRangedThreshold;
+            }
+        } catch (const std::exception&) {
+            // Fall through to a single streamed GET.
+        }
         
-        for (size_t i = 0; i < num_threads; ++i) {
-            worker_threads_.emplace_back(&DownloadManager::worker_loop, this);
+        try {
+            transfer->file = std::make_unique<OutputFile>(transfer->filename);
+        } catch (const std::exception&) {
+            transfer->finish_part(false);
+            return;
         }
-    }
-    
-    ~DownloadManager() {
-        shutdown_ = true;
-        queue_cv_.notify_all();
+        transfer->progress->total_bytes = size;
         
-        for (auto& thread : worker_threads_) {
-            if (thread.joinable()) {
-                thread.join();
-            }
+        if (!ranged || !transfer->file->resize(size)) {
+            fetch_part(transfer, 0, 0, false);
+            return;
+        }
+        
+        uint64_t part_count = std::max<uint64_t>(1, std::min<uint64_t>(scheduler_->thread_count(), size / kMinPartSize));
+        uint64_t part_size = (size + part_count - 1) / part_count;
+        transfer->progress->parts = part_count;
+        transfer->pending = part_count;
+        
+        // Parts of a download already under way go ahead of new downloads.
+        std::vector<std::function<void()>> parts;
+        for (uint64_t part = 1; part < part_count; ++part) {
+            uint64_t first = part * part_size;
+            uint64_t last = std::min(size, first + part_size) - 1;
+            parts.push_back([this, transfer, first, last]() { fetch_part(transfer, first, last, true); });
         }
+        scheduler_->post_batch(parts.begin(), parts.end(), TaskPriority::HIGH);
+        fetch_part(transfer, 0, std::min(size, part_size) - 1, true);
     }
     
-    std::future<bool> download_file_async(const std::string& url, const std::string& filename) {
-        auto promise = std::make_shared<std::promise<bool>>();
-        auto future = promise->get_future();
+public:
+    DownloadManager(size_t num_threads = std::thread::hardware_concurrency()) 
+        : DownloadManager(std::make_shared<WorkStealingPool>(num_threads)) {}
+    
+    // Several managers, or other subsystems, can run on one scheduler.
+    // Tasks already queued still reference this manager, so a shared
+    // scheduler must be idle before the manager is destroyed.
+    explicit DownloadManager(std::shared_ptr<WorkStealingPool> scheduler,
+                             std::shared_ptr<ConnectionPool> pool = std::make_shared<ConnectionPool>())
+        : pool_(std::move(pool)), client_(pool_), scheduler_(std::move(scheduler)) {}
+    
+    DownloadHandle start_download(const std::string& url, const std::string& filename,
+                                  TaskPriority priority = TaskPriority::NORMAL) {
+        auto transfer = std::make_shared<Transfer>();
+        transfer->url = url;
+        transfer->filename = filename;
+        transfer->progress = std::make_shared<DownloadProgress>();
+        transfer->progress->url = url;
+        transfer->progress->filename = filename;
         
+        DownloadHandle handle{transfer->promise.get_future(), transfer->progress};
         {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            task_queue_.push([this, url, filename, promise]() {
-                try {
-                    HttpClient client;
-                    auto response = client.get(url);
-                    
-                    if (response.is_success()) {
-                        std::ofstream file(filename, std::ios::binary);
-                        file << response.body;
-                        promise->set_value(true);
-                    } else {
-                        promise->set_value(false);
-                    }
-                } catch (...) {
-                    promise->set_value(false);
-                }
-            });
+            std::lock_guard<std::mutex> lock(downloads_mutex_);
+            downloads_.push_back(transfer->progress);
         }
         
-        queue_cv_.notify_one();
-        return future;
+        scheduler_->post([this, transfer]() { start_transfer(transfer); }, priority);
+        return handle;
+    }
+    
+    std::future<bool> download_file_async(const std::string& url, const std::string& filename,
+                                          TaskPriority priority = TaskPriority::NORMAL) {
+        return start_download(url, filename, priority).result;
+    }
+    
+    std::vector<std::shared_ptr<const DownloadProgress>> get_downloads() const {
+        std::lock_guard<std::mutex> lock(downloads_mutex_);
+        return {downloads_.begin(), downloads_.end()};
     }
     
     size_t get_queue_size() const {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        return task_queue_.size();
+        return scheduler_->pending();
     }
+    
+    WorkStealingPool& get_scheduler() { return *scheduler_; }
 };
 
 } 
@@ -543,6 +2325,75 @@ void demonstrateHttpClient() {
     }
 }
 
+void demonstrateKeepAlive() {
+    using namespace NetworkLib;
+    
+    std::cout << "\n=== Keep-Alive Demo ===\n";
+    
+    try {
+        HttpClient client;
+        
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 5; ++i) {
+            auto response = client.get("http://httpbin.org/get");
+            std::cout << "Request " << i + 1 << ": " << response.status_code
+                      << " (" << response.body.size() << " bytes)\n";
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        std::cout << "5 sequential requests took " << elapsed.count() << "ms\n";
+        
+        auto responses = client.pipeline({"http://httpbin.org/json", "http://httpbin.org/xml",
+                                           "http://httpbin.org/html"});
+        std::cout << "Pipelined " << responses.size() << " requests: ";
+        for (const auto& response : responses) {
+            std::cout << response.status_code << " ";
+        }
+        std::cout << "\n";
+        
+        std::cout << "Connections opened: " << client.get_pool().connections_opened()
+                  << ", reused: " << client.get_pool().connections_reused() << "\n";
+    } catch (const std::exception& e) {
+        std::cout << "Keep-alive error: " << e.what() << "\n";
+    }
+}
+
+void demonstrateConcurrentFetches() {
+    using namespace NetworkLib;
+    
+    std::cout << "\n=== Concurrent Async Fetch Demo ===\n";
+    
+    try {
+        HttpClient client;
+        client.set_timeout(std::chrono::seconds(10));
+        
+        const int request_count = 50;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::future<HttpResponse>> responses;
+        for (int i = 0; i < request_count; ++i) {
+            responses.push_back(client.get_async("http://httpbin.org/get?id=" + std::to_string(i)));
+        }
+        
+        int successful = 0, failed = 0;
+        for (auto& response : responses) {
+            try {
+                if (response.get().is_success()) {
+                    successful++;
+                }
+            } catch (const std::exception&) {
+                failed++;
+            }
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        
+        std::cout << request_count << " requests on one event loop: " << successful << " succeeded, "
+                  << failed << " failed in " << elapsed.count() << "ms\n";
+    } catch (const std::exception& e) {
+        std::cout << "Async fetch error: " << e.what() << "\n";
+    }
+}
+
 void demonstrateDownloadManager() {
     using namespace NetworkLib;
     
@@ -571,11 +2422,63 @@ void demonstrateDownloadManager() {
         
         std::cout << "Completed " << successful << "/" << downloads.size() << " downloads successfully\n";
         
+        for (const auto& progress : manager.get_downloads()) {
+            std::cout << "  " << progress->filename << ": " << progress->received_bytes << " bytes in "
+                      << progress->parts << " part(s), " << static_cast<uint64_t>(progress->bytes_per_second())
+                      << " B/s\n";
+        }
+        
     } catch (const std::exception& e) {
         std::cout << "Download Manager error: " << e.what() << "\n";
     }
 }
 
+// Fork-join workload: every task spawns two children until the leaves,
+// so nearly all work is pushed to local deques and spread by stealing.
+void spawnTree(NetworkLib::WorkStealingPool& pool, std::atomic<size_t>& remaining, int depth) {
+    if (depth > 0) {
+        pool.post([&pool, &remaining, depth]() { spawnTree(pool, remaining, depth - 1); });
+        pool.post([&pool, &remaining, depth]() { spawnTree(pool, remaining, depth - 1); });
+    }
+    remaining.fetch_sub(1);
+}
+
+
+void demonstrateWorkStealing() {
+    using namespace NetworkLib;
+    
+    std::cout << "\n=== Work-Stealing Scheduler Demo ===\n";
+    
+    WorkStealingPool pool(4);
+    constexpr int depth = 16;
+    std::atomic<size_t> remaining{(size_t(1) << (depth + 1)) - 1};
+    
+    auto start = std::chrono::steady_clock::now();
+    pool.post([&pool, &remaining]() { spawnTree(pool, remaining, depth); });
+    while (remaining.load() > 0) {
+        std::this_thread::yield();
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << pool.executed() << " tasks in " << std::fixed << std::setprecision(1) << elapsed << "ms on "
+              << pool.thread_count() << " workers, " << pool.stolen() << " stolen\n";
+    
+    std::vector<std::function<int()>> jobs;
+    for (int i = 1; i <= 4; ++i) {
+        jobs.push_back([i]() { return i * i; });
+    }
+    std::vector<std::future<int>> results;
+    for (auto& job : jobs) {
+        results.push_back(pool.submit(std::move(job), TaskPriority::HIGH));
+    }
+    int total = 0;
+    for (auto& result : results) {
+        total += result.get();
+    }
+    std::cout << "Sum of squares from submitted tasks: " << total << "\n";
+}
+
+
 void demonstrateConnectionPool() {
     using namespace NetworkLib;
     
@@ -603,14 +2506,85 @@ void demonstrateConnectionPool() {
     std::cout << "Pool size after returning connections: " << pool.size() << "\n";
 }
 
+#ifndef _WIN32
+void demonstratePoolContention() {
+    using namespace NetworkLib;
+    
+    std::cout << "\n=== Pool Contention Demo ===\n";
+    
+    // Local listeners stand in for remote hosts; the kernel completes the
+    // handshakes from the backlog, so nothing needs to accept().
+    const int host_count = 8;
+    std::vector<int> listeners;
+    std::vector<int> ports;
+    for (int i = 0; i < host_count; ++i) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(addr);
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 64) != 0 ||
+            getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) != 0) {
+            std::cout << "Could not open local listeners\n";
+            if (fd >= 0) close(fd);
+            for (int listener : listeners) close(listener);
+            return;
+        }
+        listeners.push_back(fd);
+        ports.push_back(ntohs(addr.sin_port));
+    }
+    
+    ConnectionPool pool;
+    ConnectionPool::HostLimits limits;
+    limits.max_connections = 4;
+    pool.set_default_limits(limits);
+    
+    const int thread_count = 8;
+    const int iterations = 20000;
+    std::atomic<int> failures{0};
+    auto start = std::chrono::steady_clock::now();
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < iterations; ++i) {
+                int port = ports[(t + i) % host_count];
+                auto socket = pool.get_connection("127.0.0.1", port);
+                if (!socket) {
+                    failures++;
+                    continue;
+                }
+                pool.return_connection(std::move(socket));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << thread_count * iterations << " checkouts in " << std::fixed << std::setprecision(1) << elapsed
+              << "ms, " << pool.connections_opened() << " connections opened, " << pool.size()
+              << " idle, " << failures << " failures\n";
+    
+    for (int listener : listeners) close(listener);
+}
+#endif
+
 int main() {
     std::cout << "Modern C++ Network Programming Demo\n";
     std::cout << "===================================\n\n";
     
     demonstrateBasicNetworking();
     demonstrateHttpClient();
+    demonstrateKeepAlive();
+    demonstrateConcurrentFetches();
     demonstrateDownloadManager();
+    demonstrateWorkStealing();
     demonstrateConnectionPool();
+#ifndef _WIN32
+    demonstratePoolContention();
+#endif
     
     std::cout << "\n=== Network Programming Demo Complete ===\n";
     return 0;
@@ -13,19 +13,51 @@
 #include <cstring>
 #include <cstdlib>
 #include <cctype>
+#include <cerrno>
+#include <atomic>
+#include <condition_variable>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <iterator>
+#include <deque>
+#include <functional>
+#include <future>
+#include <optional>
+#include <ctime>
+#include <array>
 #include <openssl/sha.h>
 #include <openssl/hmac.h>
 #include <openssl/rand.h>
+#include <openssl/evp.h>
+#include <openssl/crypto.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+#endif
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 
 const int PORT = 8080;
-const int MAX_CONNECTIONS = 10;
+const int MAX_CONNECTIONS = 1024;
+const int LISTEN_BACKLOG = 1024;
+const int IO_THREADS = 0;
+const size_t USER_SHARDS = 16;
+const size_t SESSION_SHARDS = 16;
+const size_t SESSION_WHEEL_SLOTS = 64;
+const size_t TOKEN_CACHE_SHARDS = 16;
+const size_t TOKEN_CACHE_SIZE = 65536;
+const int HASH_THREADS = 2;
+const size_t HASH_QUEUE_LIMIT = 256;
+const char* const TOKEN_SECRET = "secret_key";
 const int BUFFER_SIZE = 4096;
 const int MAX_FILE_SIZE = 10 * 1024 * 1024; 
 const int SESSION_TIMEOUT = 3600; 
@@ -33,6 +65,12 @@ const int MAX_LOGIN_ATTEMPTS = 5;
 const int LOCKOUT_DURATION = 900; 
 const std::string UPLOAD_DIR = "./uploads/";
 const std::string LOG_FILE = "./server.log";
+const size_t LOG_RING_SIZE = 4096;
+// Longest log record, newline included. A longer message is cut so the
+// record ends in LOG_TRUNCATION_MARK, which keeps the loss visible.
+const size_t LOG_RECORD_SIZE = 512;
+const char LOG_TRUNCATION_MARK[] = "...[truncated]";
+const int LOG_FLUSH_INTERVAL_MS = 50;
 
 
 const std::vector<std::string> ALLOWED_EXTENSIONS = {
@@ -73,131 +111,606 @@ struct FileInfo {
     std::chrono::system_clock::time_point uploaded_at;
 };
 
-class Logger {
+enum class LogLevel { DEBUG = 0, INFO = 1, WARN = 2, ERROR = 3 };
+
+// IMMEDIATE wakes the writer for every record; INTERVAL lets records
+// accumulate for up to the flush interval (errors still wake it).
+enum class FlushPolicy { IMMEDIATE, INTERVAL };
+
+// Process-wide log writer shared by every Logger. Producers format
+// straight into a slot of a bounded lock-free MPSC ring (Vyukov's
+// sequence-per-slot queue); one background thread drains it and issues
+// one write() per batch. A full ring only happens in bursts faster than
+// the disk; producers then yield until the writer frees a slot, so no
+// record is dropped. Records are cut at LOG_RECORD_SIZE.
+class LogWriter {
 private:
-    std::mutex log_mutex;
-    std::ofstream log_file;
+    struct Slot {
+        std::atomic<size_t> sequence;
+        uint16_t length;
+        uint16_t console_offset;
+        char text[LOG_RECORD_SIZE];
+    };
+
+    struct TimestampCache {
+        time_t second = -1;
+        char text[32];
+        size_t length = 0;
+    };
+
+    std::unique_ptr<Slot[]> ring;
+    alignas(64) std::atomic<size_t> enqueue_pos;
+    alignas(64) std::atomic<size_t> written_pos;
+    std::atomic<bool> writer_sleeping;
+    std::atomic<int> min_level;
+    std::atomic<int> flush_policy;
+    std::atomic<int64_t> flush_interval_ms;
+    std::atomic<bool> console_output;
+    int file_fd;
+    size_t dequeue_pos;
+    bool stopping;
+    std::mutex writer_mutex;
+    std::condition_variable writer_cv;
+    std::condition_variable flushed_cv;
+    std::thread writer;
+
+    LogWriter()
+        : ring(new Slot[LOG_RING_SIZE]), enqueue_pos(0), written_pos(0), writer_sleeping(false),
+          min_level(static_cast<int>(LogLevel::INFO)), flush_policy(static_cast<int>(FlushPolicy::INTERVAL)),
+          flush_interval_ms(LOG_FLUSH_INTERVAL_MS), console_output(true), dequeue_pos(0), stopping(false) {
+        for (size_t i = 0; i < LOG_RING_SIZE; i++) {
+            ring[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        file_fd = open(LOG_FILE.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        writer = std::thread(&LogWriter::writerLoop, this);
+    }
+
+    ~LogWriter() {
+        {
+            std::lock_guard<std::mutex> lock(writer_mutex);
+            stopping = true;
+        }
+        writer_cv.notify_all();
+        writer.join();
+        if (file_fd >= 0) {
+            close(file_fd);
+        }
+    }
+
+    // ctime()-style text, reformatted once per second per thread.
+    static const TimestampCache& timestamp(time_t now) {
+        thread_local TimestampCache cache;
+        if (cache.second != now) {
+            struct tm local;
+            localtime_r(&now, &local);
+            cache.length = strftime(cache.text, sizeof(cache.text), "%a %b %e %H:%M:%S %Y", &local);
+            cache.second = now;
+        }
+        return cache;
+    }
+
+    static size_t append(char* out, size_t used, const char* data, size_t length) {
+        size_t room = LOG_RECORD_SIZE - 1 - used;
+        length = std::min(length, room);
+        std::memcpy(out + used, data, length);
+        return used + length;
+    }
+
+    // Overwrites the end of a full record with LOG_TRUNCATION_MARK.
+    static size_t markTruncated(char* out) {
+        size_t length = sizeof(LOG_TRUNCATION_MARK) - 1;
+        std::memcpy(out + LOG_RECORD_SIZE - 1 - length, LOG_TRUNCATION_MARK, length);
+        return LOG_RECORD_SIZE - 1;
+    }
+
+    void wakeWriter() {
+        if (writer_sleeping.load()) {
+            std::lock_guard<std::mutex> lock(writer_mutex);
+            writer_cv.notify_one();
+        }
+    }
+
+    bool hasPending() const {
+        return ring[dequeue_pos & (LOG_RING_SIZE - 1)].sequence.load() == dequeue_pos + 1;
+    }
+
+    static void writeAll(int fd, const std::string& data) {
+        size_t offset = 0;
+        while (offset < data.size()) {
+            ssize_t written = ::write(fd, data.data() + offset, data.size() - offset);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return;
+            offset += written;
+        }
+    }
+
+    void writerLoop() {
+        std::string file_batch;
+        std::string console_batch;
+        file_batch.reserve(LOG_RING_SIZE * 64);
+        console_batch.reserve(LOG_RING_SIZE * 64);
+
+        while (true) {
+            file_batch.clear();
+            console_batch.clear();
+            bool console = console_output.load(std::memory_order_relaxed);
+
+            while (hasPending()) {
+                Slot& slot = ring[dequeue_pos & (LOG_RING_SIZE - 1)];
+                file_batch.append(slot.text, slot.length);
+                if (console) {
+                    console_batch.append(slot.text + slot.console_offset, slot.length - slot.console_offset);
+                }
+                slot.sequence.store(dequeue_pos + LOG_RING_SIZE, std::memory_order_release);
+                dequeue_pos++;
+            }
+
+            if (!file_batch.empty()) {
+                if (file_fd >= 0) {
+                    writeAll(file_fd, file_batch);
+                }
+                if (!console_batch.empty()) {
+                    writeAll(STDOUT_FILENO, console_batch);
+                }
+            }
+
+            std::unique_lock<std::mutex> lock(writer_mutex);
+            written_pos.store(dequeue_pos, std::memory_order_release);
+            flushed_cv.notify_all();
+            if (stopping && !hasPending()) {
+                break;
+            }
+            if (!file_batch.empty()) {
+                continue;
+            }
+
+            writer_sleeping.store(true);
+            if (!hasPending() && !stopping) {
+                writer_cv.wait_for(lock, std::chrono::milliseconds(flush_interval_ms.load(std::memory_order_relaxed)));
+            }
+            writer_sleeping.store(false);
+        }
+    }
 
 public:
-    Logger() {
-        log_file.open(LOG_FILE, std::ios::app);
+    static LogWriter& instance() {
+        static LogWriter writer;
+        return writer;
+    }
+
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= min_level.load(std::memory_order_relaxed);
     }
 
-    ~Logger() {
-        if (log_file.is_open()) {
-            log_file.close();
+    void submit(LogLevel level, const char* level_name, size_t name_length, const std::string& message) {
+        if (!isEnabled(level)) {
+            return;
+        }
+
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &ring[pos & (LOG_RING_SIZE - 1)];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                wakeWriter();
+                std::this_thread::yield();
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        const TimestampCache& stamp = timestamp(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
+        size_t used = append(slot->text, 0, "[", 1);
+        used = append(slot->text, used, stamp.text, stamp.length);
+        used = append(slot->text, used, "] ", 2);
+        slot->console_offset = static_cast<uint16_t>(used);
+        used = append(slot->text, used, "[", 1);
+        used = append(slot->text, used, level_name, name_length);
+        used = append(slot->text, used, "] ", 2);
+        size_t required = used + message.size();
+        used = append(slot->text, used, message.data(), message.size());
+        if (required > LOG_RECORD_SIZE - 1) {
+            used = markTruncated(slot->text);
+        }
+        slot->text[used++] = '\n';
+        slot->length = static_cast<uint16_t>(used);
+
+        // seq_cst pairs with the writer's writer_sleeping store so a
+        // record published just before it sleeps is never missed.
+        slot->sequence.store(pos + 1);
+
+        bool urgent = level == LogLevel::ERROR ||
+                      flush_policy.load(std::memory_order_relaxed) == static_cast<int>(FlushPolicy::IMMEDIATE) ||
+                      pos - written_pos.load(std::memory_order_relaxed) > LOG_RING_SIZE / 2;
+        if (urgent) {
+            wakeWriter();
         }
     }
 
+    // Blocks until every record submitted before the call is written.
+    void flush() {
+        size_t target = enqueue_pos.load();
+        std::unique_lock<std::mutex> lock(writer_mutex);
+        writer_cv.notify_one();
+        flushed_cv.wait(lock, [this, target] {
+            return written_pos.load(std::memory_order_acquire) >= target || stopping;
+        });
+    }
+
+    void setLevel(LogLevel level) {
+        min_level.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    void setFlushPolicy(FlushPolicy policy, std::chrono::milliseconds interval) {
+        flush_policy.store(static_cast<int>(policy), std::memory_order_relaxed);
+        flush_interval_ms.store(std::max<int64_t>(1, interval.count()), std::memory_order_relaxed);
+    }
+
+    void setConsoleOutput(bool enabled) {
+        console_output.store(enabled, std::memory_order_relaxed);
+    }
+};
+
+class Logger {
+private:
+    LogWriter& writer;
+
+    void write(LogLevel level, const char* name, const std::string& message) {
+        writer.submit(level, name, std::strlen(name), message);
+    }
+
+public:
+    Logger() : writer(LogWriter::instance()) {
+    }
+
     void log(const std::string& message, const std::string& level = "INFO") {
-        std::lock_guard<std::mutex> lock(log_mutex);
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        std::string timestamp = std::ctime(&time_t);
-        timestamp.pop_back(); 
+        LogLevel parsed = LogLevel::INFO;
+        if (level == "ERROR") parsed = LogLevel::ERROR;
+        else if (level == "WARN") parsed = LogLevel::WARN;
+        else if (level == "DEBUG") parsed = LogLevel::DEBUG;
+        writer.submit(parsed, level.data(), level.size(), message);
+    }
 
-        std::string log_entry = "[" + timestamp + "] [" + level + "] " + message + "\n";
-        
-        if (log_file.is_open()) {
-            log_file << log_entry;
-            log_file.flush();
-        }
-        
-        std::cout << "[" << level << "] " << message << std::endl;
+    void debug(const std::string& message) {
+        write(LogLevel::DEBUG, "DEBUG", message);
     }
 
     void error(const std::string& message) {
-        log(message, "ERROR");
+        write(LogLevel::ERROR, "ERROR", message);
     }
 
     void warn(const std::string& message) {
-        log(message, "WARN");
+        write(LogLevel::WARN, "WARN", message);
+    }
+
+    bool isEnabled(LogLevel level) const {
+        return writer.isEnabled(level);
+    }
+
+    void flush() {
+        writer.flush();
+    }
+
+    static void setLevel(LogLevel level) {
+        LogWriter::instance().setLevel(level);
+    }
+
+    static void setFlushPolicy(FlushPolicy policy,
+                               std::chrono::milliseconds interval = std::chrono::milliseconds(LOG_FLUSH_INTERVAL_MS)) {
+        LogWriter::instance().setFlushPolicy(policy, interval);
+    }
+
+    static void setConsoleOutput(bool enabled) {
+        LogWriter::instance().setConsoleOutput(enabled);
+    }
+};
+
+// Bounded pool for password hashing, separate from the I/O workers, so a
+// login storm queues here (or is refused) instead of occupying connection
+// threads. Queued work still runs at shutdown.
+class HashingPool {
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> workers;
+    bool stopping;
+
+    HashingPool() : stopping(false) {
+        for (int i = 0; i < HASH_THREADS; i++) {
+            workers.emplace_back(&HashingPool::workerLoop, this);
+        }
+    }
+
+    ~HashingPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+public:
+    static HashingPool& instance() {
+        static HashingPool pool;
+        return pool;
+    }
+
+    bool trySubmit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping || tasks.size() >= HASH_QUEUE_LIMIT) {
+                return false;
+            }
+            tasks.push_back(std::move(task));
+        }
+        cv.notify_one();
+        return true;
+    }
+
+    size_t queued() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return tasks.size();
     }
 };
 
 class SecurityUtils {
 private:
+    // A token's signature never changes, so a token that verified once is
+    // remembered and skips the HMAC next time. Each shard is simply
+    // cleared when full.
+    struct TokenCacheShard {
+        std::shared_mutex mutex;
+        std::unordered_set<std::string> tokens;
+    };
+
+    // Digest and HMAC contexts are created once per thread and only reset
+    // between calls.
+    struct DigestContexts {
+        EVP_MD_CTX* sha256 = nullptr;
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        EVP_MAC* mac = nullptr;
+        EVP_MAC_CTX* hmac = nullptr;
+#else
+        HMAC_CTX* hmac = nullptr;
+#endif
+
+        DigestContexts() {
+            sha256 = EVP_MD_CTX_new();
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+            mac = EVP_MAC_fetch(nullptr, "HMAC", nullptr);
+            hmac = mac ? EVP_MAC_CTX_new(mac) : nullptr;
+            char digest[] = "SHA256";
+            OSSL_PARAM params[] = {
+                OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digest, 0),
+                OSSL_PARAM_construct_end()
+            };
+            if (hmac && EVP_MAC_init(hmac, reinterpret_cast<const unsigned char*>(TOKEN_SECRET), std::strlen(TOKEN_SECRET), params) != 1) {
+                EVP_MAC_CTX_free(hmac);
+                hmac = nullptr;
+            }
+#else
+            hmac = HMAC_CTX_new();
+            if (hmac && HMAC_Init_ex(hmac, TOKEN_SECRET, std::strlen(TOKEN_SECRET), EVP_sha256(), nullptr) != 1) {
+                HMAC_CTX_free(hmac);
+                hmac = nullptr;
+            }
+#endif
+        }
+
+        ~DigestContexts() {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+            EVP_MAC_CTX_free(hmac);
+            EVP_MAC_free(mac);
+#else
+            HMAC_CTX_free(hmac);
+#endif
+            EVP_MD_CTX_free(sha256);
+        }
+    };
+
     Logger logger;
+    std::array<TokenCacheShard, TOKEN_CACHE_SHARDS> token_cache;
+
+    static DigestContexts& contexts() {
+        thread_local DigestContexts local;
+        return local;
+    }
+
+    // Signs payload with the token secret; out must hold HMAC_HEX_LENGTH chars.
+    static bool signPayload(const char* payload, size_t length, char* out) {
+        DigestContexts& ctx = contexts();
+        unsigned char mac[EVP_MAX_MD_SIZE];
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        size_t mac_len = 0;
+        if (!ctx.hmac || EVP_MAC_init(ctx.hmac, nullptr, 0, nullptr) != 1 ||
+            EVP_MAC_update(ctx.hmac, reinterpret_cast<const unsigned char*>(payload), length) != 1 ||
+            EVP_MAC_final(ctx.hmac, mac, &mac_len, sizeof(mac)) != 1) {
+            return false;
+        }
+#else
+        unsigned int mac_len = 0;
+        if (!ctx.hmac || HMAC_Init_ex(ctx.hmac, nullptr, 0, nullptr, nullptr) != 1 ||
+            HMAC_Update(ctx.hmac, reinterpret_cast<const unsigned char*>(payload), length) != 1 ||
+            HMAC_Final(ctx.hmac, mac, &mac_len) != 1) {
+            return false;
+        }
+#endif
+        hexEncode(mac, mac_len, out);
+        return true;
+    }
+
+    static std::string digestPassword(const std::string& password, const std::string& salt) {
+        DigestContexts& ctx = contexts();
+        unsigned char hash[SHA256_DIGEST_LENGTH];
+        unsigned int hash_len = 0;
+        if (!ctx.sha256 || EVP_DigestInit_ex(ctx.sha256, EVP_sha256(), nullptr) != 1 ||
+            EVP_DigestUpdate(ctx.sha256, password.data(), password.size()) != 1 ||
+            EVP_DigestUpdate(ctx.sha256, salt.data(), salt.size()) != 1 ||
+            EVP_DigestFinal_ex(ctx.sha256, hash, &hash_len) != 1) {
+            return "";
+        }
+        return toHex(hash, hash_len);
+    }
 
 public:
+    static constexpr size_t HMAC_HEX_LENGTH = SHA256_DIGEST_LENGTH * 2;
+
+    // out must have room for 2 * length chars; no terminator is written.
+    static void hexEncode(const unsigned char* data, size_t length, char* out) {
+        static const std::array<char, 512> table = [] {
+            const char* digits = "0123456789abcdef";
+            std::array<char, 512> pairs{};
+            for (int i = 0; i < 256; i++) {
+                pairs[i * 2] = digits[i >> 4];
+                pairs[i * 2 + 1] = digits[i & 15];
+            }
+            return pairs;
+        }();
+        for (size_t i = 0; i < length; i++) {
+            std::memcpy(out + i * 2, &table[data[i] * 2], 2);
+        }
+    }
+
+    static std::string toHex(const unsigned char* data, size_t length) {
+        std::string hex(length * 2, '\0');
+        hexEncode(data, length, &hex[0]);
+        return hex;
+    }
+
     std::string generateSalt(size_t length = 32) {
-        std::vector<unsigned char> salt_bytes(length);
-        if (RAND_bytes(salt_bytes.data(), length) != 1) {
+        unsigned char stack_bytes[64];
+        std::vector<unsigned char> heap_bytes;
+        unsigned char* salt_bytes = stack_bytes;
+        if (length > sizeof(stack_bytes)) {
+            heap_bytes.resize(length);
+            salt_bytes = heap_bytes.data();
+        }
+        if (RAND_bytes(salt_bytes, length) != 1) {
             logger.error("Failed to generate random salt");
             return "";
         }
         
-        std::stringstream ss;
-        for (unsigned char byte : salt_bytes) {
-            ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(byte);
-        }
-        return ss.str();
+        return toHex(salt_bytes, length);
     }
 
     std::string hashPassword(const std::string& password, const std::string& salt) {
-        unsigned char hash[SHA256_DIGEST_LENGTH];
-        std::string data = password + salt;
-        
-        SHA256_CTX sha256;
-        SHA256_Init(&sha256);
-        SHA256_Update(&sha256, data.c_str(), data.length());
-        SHA256_Final(hash, &sha256);
-        
-        std::stringstream ss;
-        for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
-            ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(hash[i]);
+        std::string hash = digestPassword(password, salt);
+        if (hash.empty()) {
+            logger.error("Failed to hash password");
         }
-        return ss.str();
+        return hash;
     }
 
     bool verifyPassword(const std::string& password, const std::string& hash, const std::string& salt) {
         std::string computed_hash = hashPassword(password, salt);
-        return hash == computed_hash;
+        return !computed_hash.empty() && hash.size() == computed_hash.size() &&
+               CRYPTO_memcmp(hash.data(), computed_hash.data(), hash.size()) == 0;
+    }
+
+    // `done` runs on the HashingPool. When its queue is full it runs
+    // immediately on the caller with an empty hash, like other hash failures.
+    void hashPasswordAsync(std::string password, std::string salt, std::function<void(std::string)> done) {
+        auto callback = std::make_shared<std::function<void(std::string)>>(std::move(done));
+        bool queued = HashingPool::instance().trySubmit(
+            [callback, password = std::move(password), salt = std::move(salt)]() {
+                (*callback)(digestPassword(password, salt));
+            });
+        if (!queued) {
+            logger.warn("Password hashing queue full");
+            (*callback)("");
+        }
+    }
+
+    // `done` gets nullopt when the password could not be checked (queue full
+    // or hash failure), so callers can tell overload from a wrong password.
+    void verifyPasswordAsync(std::string password, std::string hash, std::string salt,
+                             std::function<void(std::optional<bool>)> done) {
+        auto callback = std::make_shared<std::function<void(std::optional<bool>)>>(std::move(done));
+        bool queued = HashingPool::instance().trySubmit(
+            [callback, password = std::move(password), hash = std::move(hash), salt = std::move(salt)]() {
+                std::string computed = digestPassword(password, salt);
+                if (computed.empty()) {
+                    (*callback)(std::nullopt);
+                    return;
+                }
+                (*callback)(computed.size() == hash.size() &&
+                            CRYPTO_memcmp(computed.data(), hash.data(), hash.size()) == 0);
+            });
+        if (!queued) {
+            logger.warn("Password hashing queue full");
+            (*callback)(std::nullopt);
+        }
     }
 
     std::string generateToken(const std::string& user_id, const std::string& username, const std::string& role) {
         auto now = std::chrono::system_clock::now();
         auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
         
-        std::string payload = user_id + ":" + username + ":" + role + ":" + std::to_string(timestamp);
-        
-        unsigned char hmac[SHA256_DIGEST_LENGTH];
-        unsigned int hmac_len;
+        std::string token = user_id + ":" + username + ":" + role + ":" + std::to_string(timestamp);
+        size_t payload_length = token.size();
+        token.resize(payload_length + 1 + HMAC_HEX_LENGTH);
+        token[payload_length] = '.';
         
-        HMAC(EVP_sha256(), "secret_key", 10, 
-             reinterpret_cast<const unsigned char*>(payload.c_str()), payload.length(),
-             hmac, &hmac_len);
-        
-        std::stringstream ss;
-        for (unsigned int i = 0; i < hmac_len; i++) {
-            ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(hmac[i]);
+        if (!signPayload(token.data(), payload_length, &token[payload_length + 1])) {
+            logger.error("Failed to sign token");
+            return "";
         }
-        
-        return payload + "." + ss.str();
+        return token;
     }
 
     bool verifyToken(const std::string& token) {
+        TokenCacheShard& cache = token_cache[std::hash<std::string>{}(token) % TOKEN_CACHE_SHARDS];
+        {
+            std::shared_lock<std::shared_mutex> lock(cache.mutex);
+            if (cache.tokens.count(token)) {
+                return true;
+            }
+        }
+
         size_t dot_pos = token.find_last_of('.');
         if (dot_pos == std::string::npos) {
             return false;
         }
         
-        std::string payload = token.substr(0, dot_pos);
-        std::string signature = token.substr(dot_pos + 1);
-        
-        unsigned char hmac[SHA256_DIGEST_LENGTH];
-        unsigned int hmac_len;
-        
-        HMAC(EVP_sha256(), "secret_key", 10,
-             reinterpret_cast<const unsigned char*>(payload.c_str()), payload.length(),
-             hmac, &hmac_len);
-        
-        std::stringstream ss;
-        for (unsigned int i = 0; i < hmac_len; i++) {
-            ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(hmac[i]);
+        char expected[HMAC_HEX_LENGTH];
+        if (token.size() - dot_pos - 1 != HMAC_HEX_LENGTH || !signPayload(token.data(), dot_pos, expected) ||
+            CRYPTO_memcmp(expected, token.data() + dot_pos + 1, HMAC_HEX_LENGTH) != 0) {
+            return false;
         }
-        
-        return signature == ss.str();
+
+        std::unique_lock<std::shared_mutex> lock(cache.mutex);
+        if (cache.tokens.size() >= TOKEN_CACHE_SIZE / TOKEN_CACHE_SHARDS) {
+            cache.tokens.clear();
+        }
+        cache.tokens.insert(token);
+        return true;
     }
 
     std::string sanitizeInput(const std::string& input, const std::string& type = "text") {
@@ -269,56 +782,251 @@ public:
     }
 };
 
-class UserManager {
+// Sharded session table keyed by the token's hash, computed once per call.
+// Sessions expire in batches from a timer wheel swept by a background
+// thread, so lookups never compare timestamps. A session can outlive
+// SESSION_TIMEOUT by up to one wheel tick.
+class SessionStore {
 private:
-    std::map<std::string, User> users;
-    std::map<std::string, Session> sessions;
-    std::map<std::string, std::pair<int, std::chrono::system_clock::time_point>> failed_attempts;
-    std::mutex users_mutex;
-    std::mutex sessions_mutex;
-    Logger logger;
-    SecurityUtils security_utils;
+    struct Entry {
+        std::string token;
+        std::shared_ptr<const Session> session;
+        uint64_t expiry_tick;
+    };
+
+    struct IdentityHash {
+        size_t operator()(size_t hash) const { return hash; }
+    };
+
+    struct SessionShard {
+        mutable std::shared_mutex mutex;
+        std::unordered_multimap<size_t, Entry, IdentityHash> entries;
+    };
+
+    std::array<SessionShard, SESSION_SHARDS> shards;
+    std::array<std::vector<std::pair<size_t, uint64_t>>, SESSION_WHEEL_SLOTS> wheel;
+    std::mutex wheel_mutex;
+    std::condition_variable wheel_cv;
+    uint64_t swept_tick;
+    bool stopping;
+    std::chrono::steady_clock::time_point epoch;
+    std::chrono::seconds tick;
+    std::thread sweeper;
+
+    static size_t hashToken(const std::string& token) {
+        return std::hash<std::string>{}(token);
+    }
 
-public:
-    bool registerUser(const std::string& username, const std::string& email, 
-                     const std::string& password, const std::string& role = "user") {
-        std::lock_guard<std::mutex> lock(users_mutex);
-        
-        try {
-            
-            if (username.empty() || email.empty() || password.empty()) {
-                logger.warn("Registration failed: Missing required fields");
-                return false;
+    SessionShard& shardFor(size_t hash) {
+        return shards[(hash >> 32) % SESSION_SHARDS];
+    }
+
+    const SessionShard& shardFor(size_t hash) const {
+        return shards[(hash >> 32) % SESSION_SHARDS];
+    }
+
+    uint64_t currentTick() const {
+        return (std::chrono::steady_clock::now() - epoch) / tick;
+    }
+
+    // Slot T is swept once tick T begins, so the first tick boundary at or
+    // after the deadline is the earliest the session can expire.
+    uint64_t expiryTick() const {
+        auto deadline = std::chrono::steady_clock::now() - epoch + std::chrono::seconds(SESSION_TIMEOUT);
+        return (deadline + tick - std::chrono::steady_clock::duration(1)) / tick;
+    }
+
+    // Entries of a slot that are not yet due (possible only if a sweep was
+    // delayed past a full rotation) stay in the slot.
+    void sweepSlot(uint64_t due_tick) {
+        std::vector<std::pair<size_t, uint64_t>>& slot = wheel[due_tick % SESSION_WHEEL_SLOTS];
+        std::vector<std::pair<size_t, uint64_t>> due;
+        auto split = std::partition(slot.begin(), slot.end(),
+                                    [due_tick](const auto& item) { return item.second > due_tick; });
+        due.assign(split, slot.end());
+        slot.erase(split, slot.end());
+
+        for (const auto& item : due) {
+            SessionShard& shard = shardFor(item.first);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            auto range = shard.entries.equal_range(item.first);
+            for (auto it = range.first; it != range.second;) {
+                it = it->second.expiry_tick == item.second ? shard.entries.erase(it) : std::next(it);
             }
+        }
+    }
 
-            if (!security_utils.validateEmail(email)) {
-                logger.warn("Registration failed: Invalid email format");
-                return false;
+    void sweepLoop() {
+        std::unique_lock<std::mutex> lock(wheel_mutex);
+        while (!stopping) {
+            wheel_cv.wait_until(lock, epoch + tick * (swept_tick + 1), [this] {
+                return stopping || currentTick() > swept_tick;
+            });
+            uint64_t now_tick = currentTick();
+            while (!stopping && swept_tick < now_tick) {
+                sweepSlot(++swept_tick);
             }
+        }
+    }
 
-            if (!security_utils.validatePassword(password)) {
-                logger.warn("Registration failed: Password does not meet requirements");
-                return false;
+public:
+    SessionStore()
+        : swept_tick(0), stopping(false), epoch(std::chrono::steady_clock::now()),
+          tick(std::max<int>(1, (SESSION_TIMEOUT + SESSION_WHEEL_SLOTS - 3) / (SESSION_WHEEL_SLOTS - 2))) {
+        sweeper = std::thread(&SessionStore::sweepLoop, this);
+    }
+
+    ~SessionStore() {
+        {
+            std::lock_guard<std::mutex> lock(wheel_mutex);
+            stopping = true;
+        }
+        wheel_cv.notify_all();
+        sweeper.join();
+    }
+
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+    void create(const std::string& token, Session session) {
+        size_t hash = hashToken(token);
+        uint64_t expiry_tick = expiryTick();
+        auto shared_session = std::make_shared<const Session>(std::move(session));
+
+        {
+            SessionShard& shard = shardFor(hash);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            auto range = shard.entries.equal_range(hash);
+            auto it = std::find_if(range.first, range.second,
+                                   [&token](const auto& item) { return item.second.token == token; });
+            if (it != range.second) {
+                it->second.session = std::move(shared_session);
+                it->second.expiry_tick = expiry_tick;
+            } else {
+                shard.entries.emplace(hash, Entry{token, std::move(shared_session), expiry_tick});
             }
+        }
 
-            
-            for (const auto& pair : users) {
-                if (pair.second.username == username || pair.second.email == email) {
-                    logger.warn("Registration failed: User already exists");
-                    return false;
-                }
+        std::lock_guard<std::mutex> lock(wheel_mutex);
+        wheel[expiry_tick % SESSION_WHEEL_SLOTS].emplace_back(hash, expiry_tick);
+    }
+
+    std::shared_ptr<const Session> find(const std::string& token) const {
+        size_t hash = hashToken(token);
+        const SessionShard& shard = shardFor(hash);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto range = shard.entries.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.token == token) {
+                return it->second.session;
             }
+        }
+        return nullptr;
+    }
 
-            
-            std::string salt = security_utils.generateSalt();
-            std::string password_hash = security_utils.hashPassword(password, salt);
+    // The wheel keeps a stale reference, which its sweep ignores.
+    bool erase(const std::string& token) {
+        size_t hash = hashToken(token);
+        SessionShard& shard = shardFor(hash);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto range = shard.entries.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.token == token) {
+                shard.entries.erase(it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t size() const {
+        size_t count = 0;
+        for (const SessionShard& shard : shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            count += shard.entries.size();
+        }
+        return count;
+    }
+};
+
+class UserManager {
+private:
+    // Users live in the shard of their username; the email index lives in
+    // the shard of the email, so a registration locks at most two shards.
+    struct UserShard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, User> users;
+        std::unordered_map<std::string, std::string> usernames_by_email;
+        std::unordered_map<std::string, std::pair<int, std::chrono::system_clock::time_point>> failed_attempts;
+    };
+
+    std::array<UserShard, USER_SHARDS> user_shards;
+    std::atomic<uint64_t> next_user_id;
+    SessionStore sessions;
+    Logger logger;
+    SecurityUtils security_utils;
+
+    // Registrations and logins whose hashing continuation has not run yet.
+    std::mutex pending_mutex;
+    std::condition_variable pending_cv;
+    size_t pending_operations = 0;
+
+    size_t shardIndex(const std::string& key) const {
+        return std::hash<std::string>{}(key) % USER_SHARDS;
+    }
+
+    bool usernameTaken(const std::string& username) const {
+        const UserShard& shard = user_shards[shardIndex(username)];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.users.count(username) > 0;
+    }
+
+    bool emailTaken(const std::string& email) const {
+        const UserShard& shard = user_shards[shardIndex(email)];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.usernames_by_email.count(email) > 0;
+    }
+
+    // Caller holds the exclusive locks of both shards involved.
+    bool insertUser(User&& user) {
+        UserShard& name_shard = user_shards[shardIndex(user.username)];
+        UserShard& email_shard = user_shards[shardIndex(user.email)];
+        if (name_shard.users.count(user.username) || email_shard.usernames_by_email.count(user.email)) {
+            return false;
+        }
+        email_shard.usernames_by_email.emplace(user.email, user.username);
+        std::string username = user.username;
+        name_shard.users.emplace(std::move(username), std::move(user));
+        return true;
+    }
+
+    void beginOperation() {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        ++pending_operations;
+    }
+
+    void endOperation() {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        if (--pending_operations == 0) {
+            pending_cv.notify_all();
+        }
+    }
+
+    // Second half of registerUserAsync, on the HashingPool; an empty hash
+    // means the KDF failed or the pool refused the work.
+    bool finishRegistration(const std::string& username, const std::string& email, const std::string& salt,
+                            const std::string& role, const std::string& password_hash) {
+        try {
+            if (password_hash.empty()) {
+                logger.warn("Registration failed: Password could not be hashed");
+                return false;
+            }
 
             
             User user;
-            user.id = std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::system_clock::now().time_since_epoch()).count());
-            user.username = security_utils.sanitizeInput(username);
-            user.email = security_utils.sanitizeInput(email);
+            user.id = std::to_string(next_user_id.fetch_add(1));
+            user.username = username;
+            user.email = email;
             user.password_hash = password_hash;
             user.salt = salt;
             user.role = role;
@@ -326,7 +1034,18 @@ public:
             user.created_at = std::chrono::system_clock::now();
             user.failed_attempts = 0;
 
-            users[user.id] = user;
+            size_t name_index = shardIndex(username);
+            size_t email_index = shardIndex(email);
+            std::unique_lock<std::shared_mutex> first_lock(user_shards[std::min(name_index, email_index)].mutex);
+            std::unique_lock<std::shared_mutex> second_lock;
+            if (name_index != email_index) {
+                second_lock = std::unique_lock<std::shared_mutex>(user_shards[std::max(name_index, email_index)].mutex);
+            }
+
+            if (!insertUser(std::move(user))) {
+                logger.warn("Registration failed: User already exists");
+                return false;
+            }
             logger.log("User registered successfully: " + username);
             return true;
 
@@ -336,60 +1055,42 @@ public:
         }
     }
 
-    std::string authenticateUser(const std::string& username, const std::string& password) {
-        std::lock_guard<std::mutex> lock(users_mutex);
-        
+    // Second half of authenticateUserAsync, on the HashingPool. An
+    // overloaded pool is not the user's fault, so it does not count towards
+    // the lockout.
+    std::string finishAuthentication(const std::string& username, const std::string& user_id,
+                                     const std::string& role, std::optional<bool> verified) {
         try {
-            
-            User* user = nullptr;
-            for (auto& pair : users) {
-                if (pair.second.username == username) {
-                    user = &pair.second;
-                    break;
-                }
-            }
-
-            if (!user) {
-                recordFailedAttempt(username);
+            if (!verified) {
+                logger.warn("Authentication unavailable: " + username);
                 return "";
             }
-
-            
-            if (user->lockout_until > std::chrono::system_clock::now()) {
-                logger.warn("Account locked: " + username);
-                return "";
-            }
-
-            
-            if (!user->is_active) {
-                logger.warn("Account deactivated: " + username);
-                return "";
-            }
-
-            
-            if (!security_utils.verifyPassword(password, user->password_hash, user->salt)) {
+            if (!*verified) {
                 recordFailedAttempt(username);
                 return "";
             }
 
-            
-            user->failed_attempts = 0;
-            user->last_login = std::chrono::system_clock::now();
+            UserShard& shard = user_shards[shardIndex(username)];
+            {
+                std::unique_lock<std::shared_mutex> lock(shard.mutex);
+                auto it = shard.users.find(username);
+                if (it != shard.users.end()) {
+                    it->second.failed_attempts = 0;
+                    it->second.last_login = std::chrono::system_clock::now();
+                }
+            }
 
             
-            std::string token = security_utils.generateToken(user->id, user->username, user->role);
+            std::string token = security_utils.generateToken(user_id, username, role);
             
             
             Session session;
-            session.user_id = user->id;
-            session.username = user->username;
-            session.role = user->role;
+            session.user_id = user_id;
+            session.username = username;
+            session.role = role;
             session.created_at = std::chrono::system_clock::now();
 
-            {
-                std::lock_guard<std::mutex> session_lock(sessions_mutex);
-                sessions[token] = session;
-            }
+            sessions.create(token, std::move(session));
 
             logger.log("User authenticated successfully: " + username);
             return token;
@@ -400,50 +1101,221 @@ public:
         }
     }
 
-    void recordFailedAttempt(const std::string& username) {
-        auto now = std::chrono::system_clock::now();
-        
-        if (failed_attempts.find(username) == failed_attempts.end()) {
-            failed_attempts[username] = {0, now};
+public:
+    UserManager()
+        : next_user_id(std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::system_clock::now().time_since_epoch()).count()) {
+    }
+
+    // Hashing continuations refer to this object, so wait for them.
+    ~UserManager() {
+        waitIdle();
+    }
+
+    // Blocks until every registration and login started so far has called
+    // its callback.
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock(pending_mutex);
+        pending_cv.wait(lock, [this] { return pending_operations == 0; });
+    }
+
+    // Validates on the calling thread, then hashes on the HashingPool and
+    // inserts the user from there; `done` runs on whichever thread
+    // finishes, possibly before this returns.
+    void registerUserAsync(const std::string& username, const std::string& email, const std::string& password,
+                           const std::string& role, std::function<void(bool)> done) {
+        try {
+            
+            if (username.empty() || email.empty() || password.empty()) {
+                logger.warn("Registration failed: Missing required fields");
+                done(false);
+                return;
+            }
+
+            if (!security_utils.validateEmail(email)) {
+                logger.warn("Registration failed: Invalid email format");
+                done(false);
+                return;
+            }
+
+            if (!security_utils.validatePassword(password)) {
+                logger.warn("Registration failed: Password does not meet requirements");
+                done(false);
+                return;
+            }
+
+            std::string clean_username = security_utils.sanitizeInput(username);
+            std::string clean_email = security_utils.sanitizeInput(email);
+
+            // Cheap early rejection before hashing; re-checked under the
+            // exclusive locks when inserting.
+            if (usernameTaken(clean_username) || emailTaken(clean_email)) {
+                logger.warn("Registration failed: User already exists");
+                done(false);
+                return;
+            }
+
+            std::string salt = security_utils.generateSalt();
+            if (salt.empty()) {
+                logger.warn("Registration failed: Password could not be hashed");
+                done(false);
+                return;
+            }
+
+            beginOperation();
+            security_utils.hashPasswordAsync(password, salt,
+                [this, clean_username, clean_email, salt, role, done](std::string password_hash) {
+                    done(finishRegistration(clean_username, clean_email, salt, role, password_hash));
+                    endOperation();
+                });
+
+        } catch (const std::exception& e) {
+            logger.error("Registration failed: " + std::string(e.what()));
+            done(false);
         }
+    }
 
-        failed_attempts[username].first++;
+    // Blocking form for callers that are not on an I/O thread.
+    bool registerUser(const std::string& username, const std::string& email, 
+                     const std::string& password, const std::string& role = "user") {
+        auto result = std::make_shared<std::promise<bool>>();
+        std::future<bool> registered = result->get_future();
+        registerUserAsync(username, email, password, role, [result](bool ok) { result->set_value(ok); });
+        return registered.get();
+    }
 
-        if (failed_attempts[username].first >= MAX_LOGIN_ATTEMPTS) {
-            auto lockout_until = now + std::chrono::seconds(LOCKOUT_DURATION);
-            failed_attempts[username].second = lockout_until;
-            logger.warn("Account locked: " + username);
+    // Loads users that already carry their hash and salt, e.g. from a
+    // database dump at startup. Takes every shard lock once instead of two
+    // per user; returns the number inserted, skipping duplicates.
+    size_t importUsers(std::vector<User> new_users) {
+        std::array<size_t, USER_SHARDS> name_counts{};
+        std::array<size_t, USER_SHARDS> email_counts{};
+        for (User& user : new_users) {
+            if (user.id.empty()) {
+                user.id = std::to_string(next_user_id.fetch_add(1));
+            }
+            name_counts[shardIndex(user.username)]++;
+            email_counts[shardIndex(user.email)]++;
+        }
+
+        std::vector<std::unique_lock<std::shared_mutex>> locks;
+        locks.reserve(USER_SHARDS);
+        for (size_t i = 0; i < USER_SHARDS; i++) {
+            locks.emplace_back(user_shards[i].mutex);
+            user_shards[i].users.reserve(user_shards[i].users.size() + name_counts[i]);
+            user_shards[i].usernames_by_email.reserve(user_shards[i].usernames_by_email.size() + email_counts[i]);
+        }
+
+        size_t imported = 0;
+        for (User& user : new_users) {
+            if (user.username.empty() || user.email.empty()) {
+                continue;
+            }
+            if (insertUser(std::move(user))) {
+                imported++;
+            }
+        }
+        return imported;
+    }
+
+    size_t getUserCount() const {
+        size_t count = 0;
+        for (const UserShard& shard : user_shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            count += shard.users.size();
         }
+        return count;
     }
 
-    Session* validateSession(const std::string& token) {
-        std::lock_guard<std::mutex> lock(sessions_mutex);
+    // Looks the user up on the calling thread, then checks the password on
+    // the HashingPool; `done` receives the session token, or an empty string
+    // on failure, on whichever thread finishes.
+    void authenticateUserAsync(const std::string& username, const std::string& password,
+                               std::function<void(std::string)> done) {
+        UserShard& shard = user_shards[shardIndex(username)];
         
-        if (sessions.find(token) == sessions.end()) {
-            return nullptr;
+        try {
+            
+            std::string user_id, password_hash, salt, role;
+            {
+                std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                auto it = shard.users.find(username);
+                if (it != shard.users.end()) {
+                    const User& user = it->second;
+                    if (user.lockout_until > std::chrono::system_clock::now()) {
+                        logger.warn("Account locked: " + username);
+                        done("");
+                        return;
+                    }
+                    if (!user.is_active) {
+                        logger.warn("Account deactivated: " + username);
+                        done("");
+                        return;
+                    }
+                    user_id = user.id;
+                    password_hash = user.password_hash;
+                    salt = user.salt;
+                    role = user.role;
+                }
+            }
+
+            if (user_id.empty()) {
+                recordFailedAttempt(username);
+                done("");
+                return;
+            }
+
+            beginOperation();
+            security_utils.verifyPasswordAsync(password, password_hash, salt,
+                [this, username, user_id, role, done](std::optional<bool> verified) {
+                    done(finishAuthentication(username, user_id, role, verified));
+                    endOperation();
+                });
+
+        } catch (const std::exception& e) {
+            logger.error("Authentication failed: " + std::string(e.what()));
+            done("");
         }
+    }
+
+    // Blocking form for callers that are not on an I/O thread.
+    std::string authenticateUser(const std::string& username, const std::string& password) {
+        auto result = std::make_shared<std::promise<std::string>>();
+        std::future<std::string> token = result->get_future();
+        authenticateUserAsync(username, password, [result](std::string value) { result->set_value(std::move(value)); });
+        return token.get();
+    }
 
-        Session& session = sessions[token];
+    void recordFailedAttempt(const std::string& username) {
         auto now = std::chrono::system_clock::now();
+        UserShard& shard = user_shards[shardIndex(username)];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
         
-        if (now - session.created_at > std::chrono::seconds(SESSION_TIMEOUT)) {
-            sessions.erase(token);
-            return nullptr;
+        auto& attempts = shard.failed_attempts.try_emplace(username, 0, now).first->second;
+        attempts.first++;
+
+        if (attempts.first >= MAX_LOGIN_ATTEMPTS) {
+            auto lockout_until = now + std::chrono::seconds(LOCKOUT_DURATION);
+            attempts.second = lockout_until;
+            logger.warn("Account locked: " + username);
         }
+    }
 
-        return &session;
+    std::shared_ptr<const Session> validateSession(const std::string& token) const {
+        return sessions.find(token);
     }
 
     bool logout(const std::string& token) {
-        std::lock_guard<std::mutex> lock(sessions_mutex);
-        
-        if (sessions.find(token) != sessions.end()) {
-            sessions.erase(token);
+        if (sessions.erase(token)) {
             logger.log("User logged out successfully");
             return true;
         }
         return false;
     }
+
+    size_t getSessionCount() const {
+        return sessions.size();
+    }
 };
 
 class FileManager {
@@ -574,55 +1446,484 @@ public:
     }
 };
 
+// Per-connection state, recycled through the owning worker's free list so
+// steady-state accepts do not allocate.
+struct ClientConnection {
+    int fd = -1;
+    std::string request;
+    std::string response;
+    size_t sent = 0;
+    // Bumped on every reuse so a login or registration that finishes after
+    // the client went away does not answer the next owner of this slot.
+    uint64_t generation = 0;
+    ClientConnection* next_free = nullptr;
+
+    void reset() {
+        fd = -1;
+        request.clear();
+        response.clear();
+        sent = 0;
+        generation++;
+    }
+};
+
 class NetworkServer {
 private:
+    // A response produced off the I/O thread, waiting to be sent by the
+    // worker that owns the connection.
+    struct Completion {
+        ClientConnection* connection;
+        uint64_t generation;
+        std::string response;
+    };
+
+    struct IoWorker {
+        int epoll_fd = -1;
+        int wake_fd = -1;
+        int listen_fd = -1;
+        bool listen_paused = false;
+        size_t open_connections = 0;
+        std::thread thread;
+        std::mutex handoff_mutex;
+        std::vector<int> handoff;
+        std::vector<Completion> completions;
+        std::vector<std::unique_ptr<ClientConnection>> connections;
+        ClientConnection* free_list = nullptr;
+    };
+
     int server_socket;
     UserManager user_manager;
     FileManager file_manager;
     Logger logger;
-    bool running;
+    std::atomic<bool> running;
+    size_t io_threads;
+    bool reuse_port;
+    size_t per_worker_limit;
+    std::vector<std::unique_ptr<IoWorker>> workers;
+    std::atomic<int> active_connections;
+    std::mutex state_mutex;
+    std::condition_variable state_cv;
+
+    int createListener(bool non_blocking) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | (non_blocking ? SOCK_NONBLOCK : 0), 0);
+        if (fd < 0) {
+            logger.error("Failed to create socket");
+            return -1;
+        }
 
-public:
-    NetworkServer() : running(false) {
+        int opt = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+            (reuse_port && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)) {
+            logger.error("Failed to set socket options");
+            close(fd);
+            return -1;
+        }
+
+        struct sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = INADDR_ANY;
+        address.sin_port = htons(PORT);
+
+        if (bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+            logger.error("Failed to bind socket");
+            close(fd);
+            return -1;
+        }
+
+        if (listen(fd, LISTEN_BACKLOG) < 0) {
+            logger.error("Failed to listen on socket");
+            close(fd);
+            return -1;
+        }
+        return fd;
     }
 
-    ~NetworkServer() {
-        if (server_socket > 0) {
-            close(server_socket);
+    ClientConnection* acquireConnection(IoWorker& worker, int fd) {
+        ClientConnection* connection = worker.free_list;
+        if (connection) {
+            worker.free_list = connection->next_free;
+        } else {
+            worker.connections.push_back(std::make_unique<ClientConnection>());
+            connection = worker.connections.back().get();
         }
+        connection->fd = fd;
+        connection->next_free = nullptr;
+        return connection;
     }
 
-    bool start() {
-        try {
-            server_socket = socket(AF_INET, SOCK_STREAM, 0);
-            if (server_socket < 0) {
-                logger.error("Failed to create socket");
-                return false;
+    void adoptConnection(IoWorker& worker, int fd) {
+        ClientConnection* connection = acquireConnection(worker, fd);
+        int opt = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+
+        struct epoll_event event;
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.ptr = connection;
+        if (epoll_ctl(worker.epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            logger.error("Failed to register connection");
+            close(fd);
+            connection->reset();
+            connection->next_free = worker.free_list;
+            worker.free_list = connection;
+            releaseSlot();
+            return;
+        }
+        worker.open_connections++;
+    }
+
+    // Wakes the acceptor when a slot frees up after it hit the limit.
+    void releaseSlot() {
+        if (active_connections.fetch_sub(1) == MAX_CONNECTIONS) {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            state_cv.notify_all();
+        }
+    }
+
+    void closeConnection(IoWorker& worker, ClientConnection* connection) {
+        close(connection->fd);
+        connection->reset();
+        connection->next_free = worker.free_list;
+        worker.free_list = connection;
+        worker.open_connections--;
+        releaseSlot();
+
+        if (worker.listen_paused && worker.open_connections < per_worker_limit) {
+            struct epoll_event event;
+            event.events = EPOLLIN;
+            event.data.ptr = &worker;
+            epoll_ctl(worker.epoll_fd, EPOLL_CTL_MOD, worker.listen_fd, &event);
+            worker.listen_paused = false;
+        }
+    }
+
+    // SO_REUSEPORT mode: each worker accepts from its own listener and
+    // stops watching it while at its share of MAX_CONNECTIONS.
+    void acceptLocal(IoWorker& worker) {
+        while (worker.open_connections < per_worker_limit) {
+            int fd = accept4(worker.listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    logger.error("Failed to accept connection");
+                }
+                return;
             }
+            active_connections.fetch_add(1);
+            adoptConnection(worker, fd);
+        }
 
-            int opt = 1;
-            if (setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-                logger.error("Failed to set socket options");
-                return false;
+        struct epoll_event event;
+        event.events = 0;
+        event.data.ptr = &worker;
+        epoll_ctl(worker.epoll_fd, EPOLL_CTL_MOD, worker.listen_fd, &event);
+        worker.listen_paused = true;
+    }
+
+    void adoptHandoff(IoWorker& worker) {
+        uint64_t count;
+        while (read(worker.wake_fd, &count, sizeof(count)) > 0) {}
+
+        std::vector<int> pending;
+        std::vector<Completion> completed;
+        {
+            std::lock_guard<std::mutex> lock(worker.handoff_mutex);
+            pending.swap(worker.handoff);
+            completed.swap(worker.completions);
+        }
+        for (int fd : pending) {
+            adoptConnection(worker, fd);
+        }
+        for (Completion& completion : completed) {
+            ClientConnection* connection = completion.connection;
+            if (connection->fd < 0 || connection->generation != completion.generation) continue;
+            connection->response = std::move(completion.response);
+            flushResponse(worker, connection);
+        }
+    }
+
+    // Called from HashingPool threads; the owning worker sends the response.
+    void postCompletion(IoWorker& worker, ClientConnection* connection, uint64_t generation, std::string response) {
+        {
+            std::lock_guard<std::mutex> lock(worker.handoff_mutex);
+            worker.completions.push_back({connection, generation, std::move(response)});
+        }
+        uint64_t one = 1;
+        ssize_t ignored = write(worker.wake_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    // Headers plus any Content-Length body, capped at BUFFER_SIZE.
+    bool requestComplete(const std::string& request) const {
+        if (request.size() >= BUFFER_SIZE - 1) return true;
+        size_t header_end = request.find("\r\n\r\n");
+        if (header_end == std::string::npos) return false;
+
+        std::string headers = request.substr(0, header_end);
+        std::transform(headers.begin(), headers.end(), headers.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        size_t length_pos = headers.find("\r\ncontent-length:");
+        if (length_pos == std::string::npos) return true;
+        size_t body_length = std::strtoul(headers.c_str() + length_pos + 17, nullptr, 10);
+        return request.size() - (header_end + 4) >= body_length;
+    }
+
+    // Value of `name` in an application/x-www-form-urlencoded body.
+    static std::string formField(const std::string& body, const std::string& name) {
+        size_t pos = 0;
+        while (pos <= body.size()) {
+            size_t end = body.find('&', pos);
+            if (end == std::string::npos) end = body.size();
+            size_t eq = body.find('=', pos);
+            if (eq < end && eq - pos == name.size() && body.compare(pos, eq - pos, name) == 0) {
+                std::string value;
+                for (size_t i = eq + 1; i < end; i++) {
+                    if (body[i] == '+') {
+                        value += ' ';
+                    } else if (body[i] == '%' && i + 2 < end &&
+                               std::isxdigit(static_cast<unsigned char>(body[i + 1])) &&
+                               std::isxdigit(static_cast<unsigned char>(body[i + 2]))) {
+                        value += static_cast<char>(std::stoi(body.substr(i + 1, 2), nullptr, 16));
+                        i += 2;
+                    } else {
+                        value += body[i];
+                    }
+                }
+                return value;
             }
+            pos = end + 1;
+        }
+        return "";
+    }
 
-            struct sockaddr_in address;
-            address.sin_family = AF_INET;
-            address.sin_addr.s_addr = INADDR_ANY;
-            address.sin_port = htons(PORT);
+    static std::string makeResponse(const std::string& status, const std::string& body) {
+        std::string response = "HTTP/1.1 " + status + "\r\n";
+        response += "Content-Type: application/json\r\n";
+        response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+        response += "Connection: close\r\n\r\n";
+        response += body;
+        return response;
+    }
 
-            if (bind(server_socket, (struct sockaddr*)&address, sizeof(address)) < 0) {
-                logger.error("Failed to bind socket");
-                return false;
+    // POST /register and POST /login hash on the HashingPool; the
+    // connection stops polling until the continuation posts its response
+    // back, so the I/O thread never waits on the KDF.
+    bool dispatchAccountRequest(IoWorker& worker, ClientConnection* connection) {
+        const std::string& request = connection->request;
+        bool is_register = request.compare(0, 15, "POST /register ") == 0;
+        bool is_login = request.compare(0, 12, "POST /login ") == 0;
+        if (!is_register && !is_login) return false;
+
+        size_t header_end = request.find("\r\n\r\n");
+        std::string body = header_end == std::string::npos ? "" : request.substr(header_end + 4);
+
+        struct epoll_event event;
+        event.events = 0;
+        event.data.ptr = connection;
+        epoll_ctl(worker.epoll_fd, EPOLL_CTL_MOD, connection->fd, &event);
+
+        IoWorker* owner = &worker;
+        uint64_t generation = connection->generation;
+        if (is_register) {
+            user_manager.registerUserAsync(formField(body, "username"), formField(body, "email"),
+                                           formField(body, "password"), "user",
+                [this, owner, connection, generation](bool registered) {
+                    postCompletion(*owner, connection, generation, registered
+                        ? makeResponse("201 Created", "{\"status\": \"success\"}")
+                        : makeResponse("400 Bad Request", "{\"status\": \"error\"}"));
+                });
+        } else {
+            user_manager.authenticateUserAsync(formField(body, "username"), formField(body, "password"),
+                [this, owner, connection, generation](std::string token) {
+                    postCompletion(*owner, connection, generation, token.empty()
+                        ? makeResponse("401 Unauthorized", "{\"status\": \"error\"}")
+                        : makeResponse("200 OK", "{\"token\": \"" + token + "\"}"));
+                });
+        }
+        return true;
+    }
+
+    void flushResponse(IoWorker& worker, ClientConnection* connection) {
+        while (connection->sent < connection->response.size()) {
+            ssize_t bytes_sent = send(connection->fd, connection->response.data() + connection->sent,
+                                      connection->response.size() - connection->sent, MSG_NOSIGNAL);
+            if (bytes_sent > 0) {
+                connection->sent += bytes_sent;
+                continue;
+            }
+            if (bytes_sent < 0 && errno == EINTR) continue;
+            if (bytes_sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                struct epoll_event event;
+                event.events = EPOLLOUT | EPOLLRDHUP;
+                event.data.ptr = connection;
+                epoll_ctl(worker.epoll_fd, EPOLL_CTL_MOD, connection->fd, &event);
+                return;
+            }
+            break;
+        }
+        closeConnection(worker, connection);
+    }
+
+    void handleReadable(IoWorker& worker, ClientConnection* connection) {
+        char buffer[BUFFER_SIZE];
+        while (!requestComplete(connection->request)) {
+            ssize_t bytes_read = recv(connection->fd, buffer, sizeof(buffer), 0);
+            if (bytes_read > 0) {
+                connection->request.append(buffer, bytes_read);
+                continue;
+            }
+            if (bytes_read < 0 && errno == EINTR) continue;
+            if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            closeConnection(worker, connection);
+            return;
+        }
+
+        if (dispatchAccountRequest(worker, connection)) return;
+        connection->response = buildResponse(connection->request);
+        flushResponse(worker, connection);
+    }
+
+    void workerLoop(IoWorker& worker) {
+        struct epoll_event events[64];
+        while (running) {
+            int count = epoll_wait(worker.epoll_fd, events, 64, -1);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                logger.error("epoll_wait failed");
+                break;
             }
 
-            if (listen(server_socket, MAX_CONNECTIONS) < 0) {
-                logger.error("Failed to listen on socket");
+            for (int i = 0; i < count; i++) {
+                void* tag = events[i].data.ptr;
+                if (tag == nullptr) {
+                    adoptHandoff(worker);
+                } else if (tag == &worker) {
+                    acceptLocal(worker);
+                } else {
+                    auto* connection = static_cast<ClientConnection*>(tag);
+                    if (connection->fd < 0) continue;
+                    if (events[i].events & EPOLLOUT) {
+                        flushResponse(worker, connection);
+                    } else if (events[i].events & EPOLLIN) {
+                        handleReadable(worker, connection);
+                    } else {
+                        closeConnection(worker, connection);
+                    }
+                }
+            }
+        }
+
+        for (auto& connection : worker.connections) {
+            if (connection->fd >= 0) {
+                closeConnection(worker, connection.get());
+            }
+        }
+        std::lock_guard<std::mutex> lock(worker.handoff_mutex);
+        for (int fd : worker.handoff) {
+            close(fd);
+            releaseSlot();
+        }
+        worker.handoff.clear();
+    }
+
+    bool startWorkers() {
+        for (size_t i = 0; i < io_threads; i++) {
+            auto worker = std::make_unique<IoWorker>();
+            worker->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+            worker->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            IoWorker* raw = worker.get();
+            workers.push_back(std::move(worker));
+            if (raw->epoll_fd < 0 || raw->wake_fd < 0) {
+                logger.error("Failed to create I/O worker");
                 return false;
             }
 
+            struct epoll_event event;
+            event.events = EPOLLIN;
+            event.data.ptr = nullptr;
+            epoll_ctl(raw->epoll_fd, EPOLL_CTL_ADD, raw->wake_fd, &event);
+
+            if (reuse_port) {
+                raw->listen_fd = createListener(true);
+                if (raw->listen_fd < 0) {
+                    return false;
+                }
+                event.events = EPOLLIN;
+                event.data.ptr = raw;
+                epoll_ctl(raw->epoll_fd, EPOLL_CTL_ADD, raw->listen_fd, &event);
+            }
+        }
+
+        for (auto& worker : workers) {
+            IoWorker* raw = worker.get();
+            raw->thread = std::thread([this, raw]() { workerLoop(*raw); });
+        }
+        return true;
+    }
+
+    void wakeWorkers() {
+        uint64_t one = 1;
+        for (auto& worker : workers) {
+            if (worker->wake_fd >= 0) {
+                ssize_t ignored = write(worker->wake_fd, &one, sizeof(one));
+                (void)ignored;
+            }
+        }
+    }
+
+    // Only run() and the destructor join, so stop() never touches workers.
+    // Logins and registrations still hashing post to the wake fds, so those
+    // stay open until the UserManager is idle.
+    void joinWorkers() {
+        wakeWorkers();
+        for (auto& worker : workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+        user_manager.waitIdle();
+        for (auto& worker : workers) {
+            if (worker->listen_fd >= 0) close(worker->listen_fd);
+            if (worker->wake_fd >= 0) close(worker->wake_fd);
+            if (worker->epoll_fd >= 0) close(worker->epoll_fd);
+        }
+        workers.clear();
+    }
+
+public:
+    explicit NetworkServer(size_t io_threads = IO_THREADS, bool reuse_port = false)
+        : server_socket(-1), running(false),
+          io_threads(io_threads > 0 ? io_threads : std::max(1u, std::thread::hardware_concurrency())),
+          reuse_port(reuse_port), per_worker_limit(0), active_connections(0) {
+        per_worker_limit = (MAX_CONNECTIONS + this->io_threads - 1) / this->io_threads;
+    }
+
+    ~NetworkServer() {
+        running = false;
+        joinWorkers();
+        if (server_socket >= 0) {
+            close(server_socket);
+        }
+    }
+
+    bool start() {
+        try {
+            if (!reuse_port) {
+                server_socket = createListener(false);
+                if (server_socket < 0) {
+                    return false;
+                }
+            }
+
             running = true;
-            logger.log("Server started on port " + std::to_string(PORT));
+            if (!startWorkers()) {
+                running = false;
+                joinWorkers();
+                return false;
+            }
+
+            logger.log("Server started on port " + std::to_string(PORT) + " with " +
+                       std::to_string(io_threads) + " I/O workers");
             return true;
 
         } catch (const std::exception& e) {
@@ -631,43 +1932,74 @@ public:
         }
     }
 
+    // Accepts and hands sockets to the workers round-robin. At
+    // MAX_CONNECTIONS it stops accepting, leaving new clients in the
+    // kernel backlog until a slot frees up.
     void run() {
+        size_t next_worker = 0;
         while (running) {
-            struct sockaddr_in client_addr;
-            socklen_t client_len = sizeof(client_addr);
-            
-            int client_socket = accept(server_socket, (struct sockaddr*)&client_addr, &client_len);
+            if (reuse_port) {
+                std::unique_lock<std::mutex> lock(state_mutex);
+                state_cv.wait(lock, [this] { return !running; });
+                break;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(state_mutex);
+                state_cv.wait(lock, [this] { return !running || active_connections < MAX_CONNECTIONS; });
+            }
+            if (!running) break;
+
+            int client_socket = accept4(server_socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
             if (client_socket < 0) {
-                logger.error("Failed to accept connection");
+                if (!running) break;
+                if (errno == EMFILE || errno == ENFILE) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                if (errno != EINTR && errno != ECONNABORTED) {
+                    logger.error("Failed to accept connection");
+                }
                 continue;
             }
 
-            std::thread client_thread(&NetworkServer::handleClient, this, client_socket);
-            client_thread.detach();
+            active_connections.fetch_add(1);
+            IoWorker& worker = *workers[next_worker];
+            next_worker = (next_worker + 1) % workers.size();
+            {
+                std::lock_guard<std::mutex> lock(worker.handoff_mutex);
+                worker.handoff.push_back(client_socket);
+            }
+            uint64_t one = 1;
+            ssize_t ignored = write(worker.wake_fd, &one, sizeof(one));
+            (void)ignored;
         }
+        joinWorkers();
     }
 
-    void handleClient(int client_socket) {
-        char buffer[BUFFER_SIZE];
-        int bytes_read = recv(client_socket, buffer, BUFFER_SIZE - 1, 0);
-        
-        if (bytes_read > 0) {
-            buffer[bytes_read] = '\0';
-            std::string request(buffer);
-            
-            std::string response = "HTTP/1.1 200 OK\r\n";
-            response += "Content-Type: application/json\r\n";
-            response += "Content-Length: 25\r\n\r\n";
-            response += "{\"status\": \"success\"}";
-            
-            send(client_socket, response.c_str(), response.length(), 0);
-        }
-        
-        close(client_socket);
+    std::string buildResponse(const std::string& request) {
+        (void)request;
+        std::string body = "{\"status\": \"success\"}";
+        std::string response = "HTTP/1.1 200 OK\r\n";
+        response += "Content-Type: application/json\r\n";
+        response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+        response += "Connection: close\r\n\r\n";
+        response += body;
+        return response;
+    }
+
+    int getActiveConnections() const {
+        return active_connections.load();
     }
 
     void stop() {
         running = false;
+        if (server_socket >= 0) {
+            shutdown(server_socket, SHUT_RDWR);
+        }
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            state_cv.notify_all();
+        }
         logger.log("Server stopped");
     }
 };
@@ -13,94 +13,464 @@
 #include <thread>
 #include <chrono>
 #include <algorithm>
-#include <regex>
-#include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <shared_mutex>
 #include <atomic>
 #include <openssl/sha.h>
 #include <openssl/evp.h>
 #include <iomanip>
+#include <memory>
+#include <fcntl.h>
+#include <cerrno>
+#include <ctime>
+#include <string_view>
+#include <array>
+#include <charconv>
+#include <cctype>
+#include <list>
+#include <unordered_map>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <netinet/tcp.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
 
+// Token bucket per client, keyed by the packed 128-bit address (IPv4 is
+// stored as ::ffff:a.b.c.d). A bucket is one atomic word holding the token
+// count and the refill stamp, so the hot path takes only a shared shard lock
+// and a CAS. Shards are bounded; idle buckets are swept when one fills up.
 class RateLimiter {
+public:
+    struct ClientKey {
+        uint64_t high = 0;
+        uint64_t low = 0;
+        
+        bool operator==(const ClientKey& other) const {
+            return high == other.high && low == other.low;
+        }
+    };
+    
+    static ClientKey key_for(const in_addr& address) {
+        ClientKey key;
+        key.low = 0x0000ffff00000000ULL | ntohl(address.s_addr);
+        return key;
+    }
+    
+    static ClientKey key_for(const in6_addr& address) {
+        ClientKey key;
+        for (int i = 0; i < 8; i++) {
+            key.high = (key.high << 8) | address.s6_addr[i];
+            key.low = (key.low << 8) | address.s6_addr[i + 8];
+        }
+        return key;
+    }
+    
+    // Unparseable strings all share the zero key, i.e. one bucket.
+    static ClientKey key_for(const std::string& client_ip) {
+        in_addr v4;
+        if (inet_pton(AF_INET, client_ip.c_str(), &v4) == 1) {
+            return key_for(v4);
+        }
+        in6_addr v6;
+        if (inet_pton(AF_INET6, client_ip.c_str(), &v6) == 1) {
+            return key_for(v6);
+        }
+        return ClientKey();
+    }
+
 private:
-    struct ClientInfo {
-        std::queue<std::chrono::steady_clock::time_point> requests;
-        bool is_blocked;
-        std::chrono::steady_clock::time_point block_until;
+    static constexpr size_t shard_count = 16;
+    
+    struct KeyHash {
+        size_t operator()(const ClientKey& key) const {
+            uint64_t h = (key.high ^ (key.low * 0x9e3779b97f4a7c15ULL)) * 0xff51afd7ed558ccdULL;
+            return static_cast<size_t>(h ^ (h >> 32));
+        }
     };
     
-    std::map<std::string, ClientInfo> clients;
-    std::mutex mtx;
+    // state: tokens in the high 32 bits, refill stamp (ms since the limiter
+    // started) in the low 32. The stamp only advances by the time that was
+    // turned into whole tokens, so fractional refill is never lost.
+    struct Bucket {
+        std::atomic<uint64_t> state{0};
+        std::atomic<uint32_t> blocked_until{0};
+        std::atomic<uint32_t> last_seen{0};
+    };
+    
+    struct alignas(64) Shard {
+        std::shared_mutex mtx;
+        std::unordered_map<ClientKey, Bucket, KeyHash> buckets;
+        uint32_t next_sweep = 0;
+        std::atomic<uint64_t> allowed{0};
+        std::atomic<uint64_t> denied{0};
+    };
+    
+    std::array<Shard, shard_count> shards;
     const size_t max_requests;
-    const std::chrono::seconds window;
-    const std::chrono::minutes block_duration;
+    const uint64_t window_ms;
+    const uint32_t block_ms;
+    const size_t max_clients_per_shard;
+    const std::chrono::steady_clock::time_point epoch;
 
 public:
     RateLimiter(size_t max_req = 100, 
                 std::chrono::seconds win = std::chrono::seconds(60),
-                std::chrono::minutes block = std::chrono::minutes(10))
-        : max_requests(max_req), window(win), block_duration(block) {}
+                std::chrono::minutes block = std::chrono::minutes(10),
+                size_t max_clients = 65536)
+        : max_requests(std::min<size_t>(std::max<size_t>(max_req, 1), UINT32_MAX)),
+          window_ms(std::max<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(win).count(), 1)),
+          block_ms(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(block).count())),
+          max_clients_per_shard(std::max<size_t>(max_clients / shard_count, 1)),
+          epoch(std::chrono::steady_clock::now()) {}
     
     bool should_allow_request(const std::string& client_ip) {
-        std::lock_guard<std::mutex> lock(mtx);
-        auto now = std::chrono::steady_clock::now();
-        auto& client = clients[client_ip];
+        return should_allow_request(key_for(client_ip));
+    }
+    
+    bool should_allow_request(const ClientKey& key) {
+        size_t hash = KeyHash()(key);
+        Shard& shard = shards[(hash >> 8) % shard_count];
+        uint32_t now = now_ms();
         
-        if (client.is_blocked) {
-            if (now < client.block_until) {
-                return false;
+        bool allowed;
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mtx);
+            auto it = shard.buckets.find(key);
+            if (it != shard.buckets.end()) {
+                allowed = take_token(it->second, now);
+                count(shard, allowed);
+                return allowed;
             }
-            client.is_blocked = false;
-            client.requests = std::queue<std::chrono::steady_clock::time_point>();
         }
         
-        while (!client.requests.empty() && 
-               now - client.requests.front() > window) {
-            client.requests.pop();
+        std::unique_lock<std::shared_mutex> lock(shard.mtx);
+        if (shard.buckets.size() >= max_clients_per_shard || static_cast<int32_t>(now - shard.next_sweep) >= 0) {
+            evict_idle(shard, now);
         }
-        
-        if (client.requests.size() >= max_requests) {
-            client.is_blocked = true;
-            client.block_until = now + block_duration;
+        auto inserted = shard.buckets.try_emplace(key);
+        if (inserted.second) {
+            inserted.first->second.state.store(pack(max_requests, now), std::memory_order_relaxed);
+        }
+        allowed = take_token(inserted.first->second, now);
+        count(shard, allowed);
+        return allowed;
+    }
+    
+    uint64_t get_allowed_count() const {
+        uint64_t total = 0;
+        for (const auto& shard : shards) total += shard.allowed.load(std::memory_order_relaxed);
+        return total;
+    }
+    
+    uint64_t get_denied_count() const {
+        uint64_t total = 0;
+        for (const auto& shard : shards) total += shard.denied.load(std::memory_order_relaxed);
+        return total;
+    }
+    
+    size_t get_tracked_clients() {
+        size_t total = 0;
+        for (auto& shard : shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mtx);
+            total += shard.buckets.size();
+        }
+        return total;
+    }
+
+private:
+    static uint64_t pack(uint64_t tokens, uint32_t stamp) {
+        return (tokens << 32) | stamp;
+    }
+    
+    uint32_t now_ms() const {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - epoch).count());
+    }
+    
+    static void count(Shard& shard, bool allowed) {
+        (allowed ? shard.allowed : shard.denied).fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    bool take_token(Bucket& bucket, uint32_t now) {
+        bucket.last_seen.store(now, std::memory_order_relaxed);
+        uint32_t blocked_until = bucket.blocked_until.load(std::memory_order_relaxed);
+        if (blocked_until != 0 && static_cast<int32_t>(now - blocked_until) < 0) {
             return false;
         }
         
-        client.requests.push(now);
-        return true;
+        uint64_t state = bucket.state.load(std::memory_order_relaxed);
+        for (;;) {
+            uint64_t tokens = state >> 32;
+            uint32_t stamp = static_cast<uint32_t>(state);
+            uint64_t elapsed = std::min<uint64_t>(static_cast<uint32_t>(now - stamp), window_ms);
+            uint64_t refill = elapsed * max_requests / window_ms;
+            if (tokens + refill >= max_requests) {
+                tokens = max_requests;
+                stamp = now;
+            } else if (refill > 0) {
+                tokens += refill;
+                stamp += static_cast<uint32_t>(refill * window_ms / max_requests);
+            }
+            
+            if (tokens == 0) {
+                // Exhausting the bucket starts the block period, as before.
+                if (block_ms > 0) {
+                    bucket.blocked_until.store((now + block_ms) | 1, std::memory_order_relaxed);
+                }
+                return false;
+            }
+            if (bucket.state.compare_exchange_weak(state, pack(tokens - 1, stamp), std::memory_order_relaxed)) {
+                if (blocked_until != 0) {
+                    bucket.blocked_until.compare_exchange_strong(blocked_until, 0, std::memory_order_relaxed);
+                }
+                return true;
+            }
+        }
+    }
+    
+    // Caller holds the shard exclusively. A bucket idle for a full window is
+    // full again, so dropping it loses nothing unless it is still blocked. If
+    // that frees nothing, the least recently seen half goes, which keeps the
+    // amortized cost per insert constant under an address scan.
+    void evict_idle(Shard& shard, uint32_t now) {
+        shard.next_sweep = now + static_cast<uint32_t>(std::min<uint64_t>(window_ms, UINT32_MAX / 2));
+        for (auto it = shard.buckets.begin(); it != shard.buckets.end();) {
+            const Bucket& bucket = it->second;
+            uint32_t idle = now - bucket.last_seen.load(std::memory_order_relaxed);
+            uint32_t blocked_until = bucket.blocked_until.load(std::memory_order_relaxed);
+            bool blocked = blocked_until != 0 && static_cast<int32_t>(now - blocked_until) < 0;
+            if (idle >= window_ms && !blocked) {
+                it = shard.buckets.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (shard.buckets.size() < max_clients_per_shard) return;
+        
+        std::vector<uint32_t> idle_times;
+        idle_times.reserve(shard.buckets.size());
+        for (const auto& entry : shard.buckets) {
+            idle_times.push_back(now - entry.second.last_seen.load(std::memory_order_relaxed));
+        }
+        auto middle = idle_times.begin() + idle_times.size() / 2;
+        std::nth_element(idle_times.begin(), middle, idle_times.end(), std::greater<uint32_t>());
+        uint32_t threshold = *middle;
+        for (auto it = shard.buckets.begin(); it != shard.buckets.end();) {
+            if (now - it->second.last_seen.load(std::memory_order_relaxed) >= threshold) {
+                it = shard.buckets.erase(it);
+            } else {
+                ++it;
+            }
+        }
     }
 };
 
+// Request threads format their line straight into a slot of a bounded
+// lock-free ring; a background thread appends whole batches with one
+// write() each. The timestamp text is rebuilt at most once per second per
+// thread.
 class RequestLogger {
+public:
+    enum class FlushPolicy { IMMEDIATE, INTERVAL };
+
 private:
-    std::ofstream log_file;
+    static constexpr size_t ring_size = 4096;
+    // Longest line, newline included. Longer lines (long paths or user
+    // agents) are cut to end in truncation_mark.
+    static constexpr size_t record_size = 512;
+    static constexpr std::string_view truncation_mark = "...[truncated]";
+    
+    struct Slot {
+        std::atomic<size_t> sequence;
+        size_t length;
+        char text[record_size];
+    };
+    
+    std::unique_ptr<Slot[]> ring;
+    alignas(64) std::atomic<size_t> enqueue_pos{0};
+    alignas(64) std::atomic<size_t> written_pos{0};
+    std::atomic<bool> writer_sleeping{false};
+    std::atomic<bool> immediate{false};
+    std::chrono::milliseconds flush_interval;
+    size_t dequeue_pos = 0;
+    bool stopping = false;
+    int fd;
     std::mutex mtx;
+    std::condition_variable writer_cv;
+    std::condition_variable flushed_cv;
+    std::thread writer;
+    
+    static size_t format_time(char* out, size_t capacity) {
+        struct Cache {
+            time_t second = -1;
+            char text[32];
+            size_t length = 0;
+        };
+        thread_local Cache cache;
+        
+        time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        if (cache.second != now) {
+            struct tm local;
+            localtime_r(&now, &local);
+            cache.length = strftime(cache.text, sizeof(cache.text), "%a %b %e %H:%M:%S %Y", &local);
+            cache.second = now;
+        }
+        size_t length = std::min(cache.length, capacity);
+        memcpy(out, cache.text, length);
+        return length;
+    }
+    
+    static size_t append(char* out, size_t used, std::string_view field) {
+        size_t length = std::min(field.size(), record_size - 1 - used);
+        if (length > 0) {
+            memcpy(out + used, field.data(), length);
+        }
+        return used + length;
+    }
+    
+    bool has_pending() const {
+        return ring[dequeue_pos & (ring_size - 1)].sequence.load() == dequeue_pos + 1;
+    }
+    
+    void wake_writer() {
+        if (writer_sleeping.load()) {
+            std::lock_guard<std::mutex> lock(mtx);
+            writer_cv.notify_one();
+        }
+    }
+    
+    void writer_loop() {
+        std::string batch;
+        batch.reserve(ring_size * 128);
+        
+        while (true) {
+            batch.clear();
+            while (has_pending()) {
+                Slot& slot = ring[dequeue_pos & (ring_size - 1)];
+                batch.append(slot.text, slot.length);
+                slot.sequence.store(dequeue_pos + ring_size, std::memory_order_release);
+                dequeue_pos++;
+            }
+            
+            size_t offset = 0;
+            while (fd >= 0 && offset < batch.size()) {
+                ssize_t written = ::write(fd, batch.data() + offset, batch.size() - offset);
+                if (written < 0 && errno == EINTR) continue;
+                if (written <= 0) break;
+                offset += written;
+            }
+            
+            std::unique_lock<std::mutex> lock(mtx);
+            written_pos.store(dequeue_pos, std::memory_order_release);
+            flushed_cv.notify_all();
+            if (stopping && !has_pending()) {
+                break;
+            }
+            if (!batch.empty()) {
+                continue;
+            }
+            
+            writer_sleeping.store(true);
+            if (!has_pending() && !stopping) {
+                writer_cv.wait_for(lock, flush_interval);
+            }
+            writer_sleeping.store(false);
+        }
+    }
 
 public:
-    RequestLogger(const std::string& filename = "http_requests.log") {
-        log_file.open(filename, std::ios::app);
+    RequestLogger(const std::string& filename = "http_requests.log",
+                  FlushPolicy policy = FlushPolicy::INTERVAL,
+                  std::chrono::milliseconds interval = std::chrono::milliseconds(50))
+        : ring(new Slot[ring_size]), immediate(policy == FlushPolicy::IMMEDIATE), flush_interval(interval) {
+        for (size_t i = 0; i < ring_size; i++) {
+            ring[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        writer = std::thread(&RequestLogger::writer_loop, this);
     }
     
     ~RequestLogger() {
-        if (log_file.is_open()) {
-            log_file.close();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        writer_cv.notify_all();
+        writer.join();
+        if (fd >= 0) {
+            close(fd);
         }
     }
     
-    void log_request(const std::string& client_ip, 
-                    const std::string& method,
-                    const std::string& path,
+    RequestLogger(const RequestLogger&) = delete;
+    RequestLogger& operator=(const RequestLogger&) = delete;
+    
+    void log_request(std::string_view client_ip, 
+                    std::string_view method,
+                    std::string_view path,
                     int status_code,
-                    const std::string& user_agent) {
-        std::lock_guard<std::mutex> lock(mtx);
-        auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::system_clock::to_time_t(now);
-        log_file << std::ctime(&time) << " " 
-                << client_ip << " "
-                << method << " "
-                << path << " "
-                << status_code << " "
-                << user_agent << std::endl;
+                    std::string_view user_agent) {
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &ring[pos & (ring_size - 1)];
+            intptr_t diff = static_cast<intptr_t>(slot->sequence.load(std::memory_order_acquire)) -
+                            static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // Ring full: let the writer catch up instead of dropping.
+                wake_writer();
+                std::this_thread::yield();
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        
+        char status[16];
+        int status_length = snprintf(status, sizeof(status), " %d ", status_code);
+        
+        char* out = slot->text;
+        size_t used = format_time(out, record_size - 1);
+        size_t required = used + 3 + client_ip.size() + method.size() + path.size() + status_length + user_agent.size();
+        out[used++] = ' ';
+        used = append(out, used, client_ip);
+        used = append(out, used, " ");
+        used = append(out, used, method);
+        used = append(out, used, " ");
+        used = append(out, used, path);
+        used = append(out, used, std::string_view(status, status_length));
+        used = append(out, used, user_agent);
+        if (required > record_size - 1) {
+            used = record_size - 1 - truncation_mark.size();
+            used = append(out, used, truncation_mark);
+        }
+        out[used++] = '\n';
+        slot->length = used;
+        slot->sequence.store(pos + 1);
+        
+        if (immediate.load(std::memory_order_relaxed) || pos - written_pos.load(std::memory_order_relaxed) > ring_size / 2) {
+            wake_writer();
+        }
+    }
+    
+    // Blocks until every request logged before the call is on disk.
+    void flush() {
+        size_t target = enqueue_pos.load();
+        std::unique_lock<std::mutex> lock(mtx);
+        writer_cv.notify_one();
+        flushed_cv.wait(lock, [this, target]() {
+            return written_pos.load(std::memory_order_acquire) >= target || stopping;
+        });
+    }
+    
+    void set_flush_policy(FlushPolicy policy) {
+        immediate.store(policy == FlushPolicy::IMMEDIATE, std::memory_order_relaxed);
     }
 };
 
@@ -119,56 +489,462 @@ public:
     }
 };
 
+struct HeaderField {
+    std::string_view name;
+    std::string_view value;
+};
+
+// Views into the connection's receive buffer; valid until that buffer is
+// modified.
+struct HTTPRequest {
+    static constexpr size_t max_headers = 32;
+    
+    std::string_view method;
+    std::string_view path;
+    std::string_view version;
+    std::array<HeaderField, max_headers> headers;
+    size_t header_count = 0;
+    std::string_view body;
+    std::string_view client_ip;
+    
+    static bool iequals(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    std::string_view header(std::string_view name) const {
+        for (size_t i = 0; i < header_count; i++) {
+            if (iequals(headers[i].name, name)) {
+                return headers[i].value;
+            }
+        }
+        return {};
+    }
+};
+
+// Resumable request parser. Call parse() with the whole buffer received so
+// far each time more arrives; it picks up where it stopped and records
+// offsets only, so the buffer may grow (and move) between calls.
+class RequestParser {
+public:
+    enum class State { REQUEST_LINE, HEADERS, BODY, COMPLETE, ERROR };
+    
+    static constexpr size_t max_header_bytes = 16 * 1024;
+    static constexpr size_t max_body_bytes = 16 * 1024 * 1024;
+
+private:
+    struct Span {
+        size_t offset = 0;
+        size_t length = 0;
+    };
+    
+    State state = State::REQUEST_LINE;
+    size_t line_start = 0;
+    size_t search_pos = 0;
+    Span method;
+    Span path;
+    Span version;
+    std::array<std::pair<Span, Span>, HTTPRequest::max_headers> header_spans;
+    size_t header_count = 0;
+    size_t body_offset = 0;
+    size_t body_length = 0;
+    int error_status = 0;
+    
+    static std::string_view view(std::string_view buffer, Span span) {
+        return buffer.substr(span.offset, span.length);
+    }
+    
+    State fail(int status) {
+        state = State::ERROR;
+        error_status = status;
+        return state;
+    }
+    
+    static Span trim(std::string_view buffer, size_t begin, size_t end) {
+        while (begin < end && (buffer[begin] == ' ' || buffer[begin] == '\t')) begin++;
+        while (end > begin && (buffer[end - 1] == ' ' || buffer[end - 1] == '\t')) end--;
+        return {begin, end - begin};
+    }
+    
+    bool parse_request_line(std::string_view buffer, size_t begin, size_t end) {
+        std::string_view line = buffer.substr(begin, end - begin);
+        size_t first_space = line.find(' ');
+        if (first_space == std::string_view::npos || first_space == 0) return false;
+        size_t path_start = line.find_first_not_of(' ', first_space);
+        if (path_start == std::string_view::npos) return false;
+        size_t second_space = line.find(' ', path_start);
+        
+        method = {begin, first_space};
+        if (second_space == std::string_view::npos) {
+            path = {begin + path_start, line.size() - path_start};
+            version = {end, 0};
+        } else {
+            path = {begin + path_start, second_space - path_start};
+            version = trim(buffer, begin + second_space, end);
+        }
+        return true;
+    }
+    
+    // Lines without a colon are ignored, as before.
+    bool parse_header_line(std::string_view buffer, size_t begin, size_t end) {
+        size_t colon = buffer.find(':', begin);
+        if (colon == std::string_view::npos || colon >= end) return true;
+        if (header_count == header_spans.size()) return false;
+        header_spans[header_count++] = {trim(buffer, begin, colon), trim(buffer, colon + 1, end)};
+        return true;
+    }
+    
+    State finish_headers(std::string_view buffer, size_t next) {
+        body_offset = next;
+        for (size_t i = 0; i < header_count; i++) {
+            std::string_view name = view(buffer, header_spans[i].first);
+            std::string_view value = view(buffer, header_spans[i].second);
+            if (HTTPRequest::iequals(name, "Transfer-Encoding")) {
+                return fail(501);
+            }
+            if (HTTPRequest::iequals(name, "Content-Length")) {
+                size_t length = 0;
+                auto result = std::from_chars(value.data(), value.data() + value.size(), length);
+                if (result.ec != std::errc() || result.ptr != value.data() + value.size()) {
+                    return fail(400);
+                }
+                if (length > max_body_bytes) {
+                    return fail(413);
+                }
+                body_length = length;
+            }
+        }
+        state = body_length > 0 ? State::BODY : State::COMPLETE;
+        return state;
+    }
+
+public:
+    State parse(std::string_view buffer) {
+        while (state == State::REQUEST_LINE || state == State::HEADERS) {
+            size_t newline = buffer.find('\n', search_pos);
+            if (newline == std::string_view::npos) {
+                search_pos = buffer.size();
+                return buffer.size() > max_header_bytes ? fail(431) : state;
+            }
+            if (newline >= max_header_bytes) {
+                return fail(431);
+            }
+            
+            size_t end = newline;
+            if (end > line_start && buffer[end - 1] == '\r') end--;
+            
+            if (state == State::REQUEST_LINE) {
+                // Stray CRLFs before a request are allowed (RFC 7230 3.5).
+                if (end > line_start) {
+                    if (!parse_request_line(buffer, line_start, end)) return fail(400);
+                    state = State::HEADERS;
+                }
+            } else if (end == line_start) {
+                finish_headers(buffer, newline + 1);
+            } else if (!parse_header_line(buffer, line_start, end)) {
+                return fail(431);
+            }
+            line_start = search_pos = newline + 1;
+        }
+        
+        if (state == State::BODY && buffer.size() >= body_offset + body_length) {
+            state = State::COMPLETE;
+        }
+        return state;
+    }
+    
+    State get_state() const { return state; }
+    int get_error_status() const { return error_status; }
+    
+    // Bytes taken by the parsed request, including its body.
+    size_t consumed() const { return body_offset + body_length; }
+    
+    HTTPRequest request(std::string_view buffer) const {
+        HTTPRequest request;
+        request.method = view(buffer, method);
+        request.path = view(buffer, path);
+        request.version = view(buffer, version);
+        request.header_count = header_count;
+        for (size_t i = 0; i < header_count; i++) {
+            request.headers[i] = {view(buffer, header_spans[i].first), view(buffer, header_spans[i].second)};
+        }
+        request.body = buffer.substr(body_offset, body_length);
+        return request;
+    }
+    
+    void reset() {
+        *this = RequestParser();
+    }
+};
+
+// Open descriptors for served files, revalidated against stat() on every
+// lookup: a changed inode, size or mtime reopens the file. Entries are
+// shared, so a response being sendfile()d keeps its descriptor alive after
+// eviction.
+class FileCache {
+public:
+    struct Entry {
+        int fd = -1;
+        off_t size = 0;
+        ino_t inode = 0;
+        struct timespec mtime = {};
+        std::string etag;
+        
+        ~Entry() {
+            if (fd >= 0) close(fd);
+        }
+    };
+
+private:
+    std::unordered_map<std::string, std::shared_ptr<const Entry>> entries;
+    std::shared_mutex mtx;
+    const size_t max_entries;
+    
+    static bool matches(const Entry& entry, const struct stat& info) {
+        return entry.inode == info.st_ino && entry.size == info.st_size &&
+               entry.mtime.tv_sec == info.st_mtim.tv_sec && entry.mtime.tv_nsec == info.st_mtim.tv_nsec;
+    }
+    
+    static void append_hex(std::string& out, uint64_t value) {
+        char digits[16];
+        auto end = std::to_chars(digits, digits + sizeof(digits), value, 16).ptr;
+        out.append(digits, end - digits);
+    }
+
+public:
+    explicit FileCache(size_t max_entries = 256) : max_entries(max_entries) {}
+    
+    // Returns nullptr if the path is missing or not a regular file.
+    std::shared_ptr<const Entry> open_file(const std::string& path) {
+        struct stat info;
+        if (stat(path.c_str(), &info) < 0 || !S_ISREG(info.st_mode)) {
+            return nullptr;
+        }
+        
+        {
+            std::shared_lock<std::shared_mutex> lock(mtx);
+            auto it = entries.find(path);
+            if (it != entries.end() && matches(*it->second, info)) {
+                return it->second;
+            }
+        }
+        
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return nullptr;
+        auto entry = std::make_shared<Entry>();
+        entry->fd = fd;
+        if (fstat(fd, &info) < 0 || !S_ISREG(info.st_mode)) {
+            return nullptr;
+        }
+        entry->size = info.st_size;
+        entry->inode = info.st_ino;
+        entry->mtime = info.st_mtim;
+        entry->etag.push_back('"');
+        append_hex(entry->etag, entry->inode);
+        entry->etag.push_back('-');
+        append_hex(entry->etag, static_cast<uint64_t>(entry->size));
+        entry->etag.push_back('-');
+        append_hex(entry->etag, static_cast<uint64_t>(entry->mtime.tv_sec) * 1000000000ULL + entry->mtime.tv_nsec);
+        entry->etag.push_back('"');
+        
+        std::unique_lock<std::shared_mutex> lock(mtx);
+        auto it = entries.find(path);
+        if (it == entries.end() && entries.size() >= max_entries) {
+            entries.erase(entries.begin());
+        }
+        entries[path] = entry;
+        return entry;
+    }
+    
+    // Weak comparison, as If-None-Match requires.
+    static bool etag_matches(std::string_view if_none_match, std::string_view etag) {
+        while (!if_none_match.empty()) {
+            size_t comma = if_none_match.find(',');
+            std::string_view candidate = if_none_match.substr(0, comma);
+            if_none_match = comma == std::string_view::npos ? std::string_view() : if_none_match.substr(comma + 1);
+            
+            while (!candidate.empty() && (candidate.front() == ' ' || candidate.front() == '\t')) candidate.remove_prefix(1);
+            while (!candidate.empty() && (candidate.back() == ' ' || candidate.back() == '\t')) candidate.remove_suffix(1);
+            if (candidate == "*") return true;
+            if (candidate.substr(0, 2) == "W/") candidate.remove_prefix(2);
+            if (candidate == etag) return true;
+        }
+        return false;
+    }
+};
+
 class HTTPServer {
 private:
-    int server_socket;
+    // What add_route() can bind a path to; dispatch is one hash lookup on
+    // the first path segment.
+    enum class Route { INDEX, FILE, COMMAND, SEARCH, UPLOAD, LOGIN };
+    
     int port;
-    bool running;
-    std::map<std::string, std::string> routes;
+    std::atomic<bool> running;
+    std::unordered_map<std::string, Route> routes;
     std::map<std::string, std::string> headers;
+    FileCache file_cache;
     RateLimiter rate_limiter;
     RequestLogger request_logger;
     std::atomic<size_t> active_connections{0};
-    const size_t max_connections = 100;
-    std::condition_variable connection_cv;
-    std::mutex connection_mtx;
-    
-    struct HTTPRequest {
-        std::string method;
-        std::string path;
-        std::string version;
-        std::map<std::string, std::string> headers;
+    const size_t max_connections = 1024;
+    const std::chrono::seconds keep_alive_timeout{15};
+    const size_t max_pipelined_responses = 32;
+    size_t worker_count;
+    
+    // The body is either the string or, for files, sent with sendfile().
+    struct PendingOutput {
+        size_t head_offset;
+        size_t head_length;
         std::string body;
+        std::shared_ptr<const FileCache::Entry> file;
+        
+        size_t body_length() const {
+            return file ? static_cast<size_t>(file->size) : body.size();
+        }
+    };
+    
+    // Owned by one worker. Buffers keep their capacity across requests.
+    struct Connection {
+        int fd = -1;
         std::string client_ip;
+        RateLimiter::ClientKey client_key;
+        std::string input;
+        size_t input_offset = 0;
+        RequestParser parser;
+        std::string head_buffer;
+        std::vector<PendingOutput> outputs;
+        size_t output_sent = 0;
+        bool close_after_flush = false;
+        bool peer_closed = false;
+        std::chrono::steady_clock::time_point last_active;
+        std::list<Connection*>::iterator idle_position;
+    };
+    
+    struct Worker {
+        int epoll_fd = -1;
+        int listen_fd = -1;
+        int wake_fd = -1;
+        bool listen_paused = false;
+        size_t connection_limit = 0;
+        std::thread thread;
+        std::unordered_map<Connection*, std::unique_ptr<Connection>> connections;
+        std::vector<std::unique_ptr<Connection>> free_connections;
+        // Least recently active first, for idle keep-alive expiry.
+        std::list<Connection*> idle_order;
     };
     
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex workers_mtx;
+    
     struct HTTPResponse {
         int status_code;
         std::string status_text;
         std::map<std::string, std::string> headers;
         std::string body;
+        std::shared_ptr<const FileCache::Entry> file;
     };
 
 public:
-    HTTPServer(int port = 8080) : port(port), running(false) {
+    HTTPServer(int port = 8080, size_t worker_count = 0)
+        : port(port), running(false),
+          worker_count(worker_count > 0 ? worker_count : std::max(1u, std::thread::hardware_concurrency())) {
         headers = SecurityHeaders::get_default_security_headers();
     }
     
     ~HTTPServer() {
-        if (server_socket > 0) {
-            close(server_socket);
-        }
+        close_workers();
     }
     
+    // Runs one edge-triggered epoll loop per worker, each on its own
+    // SO_REUSEPORT listener so the kernel spreads new connections. The
+    // calling thread runs the first worker; returns after stop().
     bool start() {
-        server_socket = socket(AF_INET, SOCK_STREAM, 0);
-        if (server_socket < 0) {
+        for (size_t i = 0; i < worker_count; i++) {
+            auto worker = std::make_unique<Worker>();
+            worker->connection_limit = std::max<size_t>(1, max_connections / worker_count);
+            worker->listen_fd = create_listener();
+            worker->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+            worker->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            bool ok = worker->listen_fd >= 0 && worker->epoll_fd >= 0 && worker->wake_fd >= 0;
+            if (ok) {
+                struct epoll_event event;
+                event.events = EPOLLIN | EPOLLET;
+                event.data.ptr = worker.get();
+                ok = epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, worker->listen_fd, &event) == 0;
+                event.events = EPOLLIN;
+                event.data.ptr = nullptr;
+                ok = ok && epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, worker->wake_fd, &event) == 0;
+            }
+            {
+                std::lock_guard<std::mutex> lock(workers_mtx);
+                workers.push_back(std::move(worker));
+            }
+            if (!ok) {
+                close_workers();
+                return false;
+            }
+        }
+        
+        running = true;
+        std::cout << "Server listening on port " << port << " with " << worker_count << " workers" << std::endl;
+        
+        for (size_t i = 1; i < workers.size(); i++) {
+            Worker* worker = workers[i].get();
+            worker->thread = std::thread([this, worker]() { worker_loop(*worker); });
+        }
+        worker_loop(*workers[0]);
+        close_workers();
+        return true;
+    }
+    
+    void stop() {
+        running = false;
+        std::lock_guard<std::mutex> lock(workers_mtx);
+        uint64_t one = 1;
+        for (auto& worker : workers) {
+            if (worker->wake_fd >= 0) {
+                ssize_t ignored = write(worker->wake_fd, &one, sizeof(one));
+                (void)ignored;
+            }
+        }
+    }
+    
+    // Routes must be registered before start(); unknown handler names are
+    // ignored.
+    void add_route(const std::string& path, const std::string& handler) {
+        static const std::pair<const char*, Route> handlers[] = {
+            {"index", Route::INDEX},
+            {"file_handler", Route::FILE},
+            {"command_handler", Route::COMMAND},
+            {"search_handler", Route::SEARCH},
+            {"upload_handler", Route::UPLOAD},
+            {"login_handler", Route::LOGIN}
+        };
+        for (const auto& entry : handlers) {
+            if (handler == entry.first) {
+                routes[path] = entry.second;
+                return;
+            }
+        }
+    }
+
+private:
+    int create_listener() {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
             std::cerr << "Failed to create socket" << std::endl;
-            return false;
+            return -1;
         }
         
         int opt = 1;
-        setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
         
         struct sockaddr_in server_addr;
         memset(&server_addr, 0, sizeof(server_addr));
@@ -176,132 +952,282 @@ public:
         server_addr.sin_addr.s_addr = INADDR_ANY;
         server_addr.sin_port = htons(port);
         
-        if (bind(server_socket, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        if (bind(fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
             std::cerr << "Failed to bind socket" << std::endl;
-            return false;
+            close(fd);
+            return -1;
         }
         
-        if (listen(server_socket, 10) < 0) {
+        if (listen(fd, SOMAXCONN) < 0) {
             std::cerr << "Failed to listen on socket" << std::endl;
-            return false;
+            close(fd);
+            return -1;
         }
-        
-        running = true;
-        std::cout << "Server listening on port " << port << std::endl;
-        
+        return fd;
+    }
+    
+    // Called from start() once the first worker's loop returns, and from
+    // the destructor.
+    void close_workers() {
+        stop();
+        for (auto& worker : workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+        std::lock_guard<std::mutex> lock(workers_mtx);
+        for (auto& worker : workers) {
+            for (auto& entry : worker->connections) {
+                close(entry.second->fd);
+                active_connections--;
+            }
+            if (worker->listen_fd >= 0) close(worker->listen_fd);
+            if (worker->epoll_fd >= 0) close(worker->epoll_fd);
+            if (worker->wake_fd >= 0) close(worker->wake_fd);
+        }
+        workers.clear();
+    }
+    
+    void worker_loop(Worker& worker) {
+        struct epoll_event events[128];
         while (running) {
+            int count = epoll_wait(worker.epoll_fd, events, 128, 1000);
+            if (count < 0 && errno != EINTR) {
+                break;
+            }
+            
+            for (int i = 0; i < count; i++) {
+                void* tag = events[i].data.ptr;
+                if (tag == nullptr) {
+                    uint64_t value;
+                    while (read(worker.wake_fd, &value, sizeof(value)) > 0) {}
+                } else if (tag == &worker) {
+                    accept_connections(worker);
+                } else {
+                    Connection* connection = static_cast<Connection*>(tag);
+                    if (worker.connections.count(connection)) {
+                        handle_event(worker, *connection, events[i].events);
+                    }
+                }
+            }
+            expire_idle(worker);
+        }
+    }
+    
+    void accept_connections(Worker& worker) {
+        while (worker.connections.size() < worker.connection_limit) {
             struct sockaddr_in client_addr;
             socklen_t client_len = sizeof(client_addr);
-            int client_socket = accept(server_socket, (struct sockaddr*)&client_addr, &client_len);
-            
+            int client_socket = accept4(worker.listen_fd, (struct sockaddr*)&client_addr, &client_len,
+                                        SOCK_NONBLOCK | SOCK_CLOEXEC);
             if (client_socket < 0) {
-                continue;
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                return;
             }
             
-            std::string client_ip = inet_ntoa(client_addr.sin_addr);
+            std::unique_ptr<Connection> connection;
+            if (!worker.free_connections.empty()) {
+                connection = std::move(worker.free_connections.back());
+                worker.free_connections.pop_back();
+            } else {
+                connection = std::make_unique<Connection>();
+            }
             
-            if (!rate_limiter.should_allow_request(client_ip)) {
-                HTTPResponse response;
-                response.status_code = 429;
-                response.status_text = "Too Many Requests";
-                response.body = "Rate limit exceeded. Please try again later.";
-                send_response(client_socket, response);
+            char address[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &client_addr.sin_addr, address, sizeof(address));
+            connection->fd = client_socket;
+            connection->client_ip = address;
+            connection->client_key = RateLimiter::key_for(client_addr.sin_addr);
+            connection->last_active = std::chrono::steady_clock::now();
+            
+            int opt = 1;
+            setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+            
+            struct epoll_event event;
+            event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            event.data.ptr = connection.get();
+            if (epoll_ctl(worker.epoll_fd, EPOLL_CTL_ADD, client_socket, &event) < 0) {
                 close(client_socket);
                 continue;
             }
             
-            std::unique_lock<std::mutex> lock(connection_mtx);
-            if (active_connections >= max_connections) {
-                connection_cv.wait(lock, [this]() {
-                    return active_connections < max_connections;
-                });
-            }
+            Connection* raw = connection.get();
+            raw->idle_position = worker.idle_order.insert(worker.idle_order.end(), raw);
+            worker.connections.emplace(raw, std::move(connection));
             active_connections++;
-            lock.unlock();
-            
-            std::thread([this, client_socket, client_ip]() {
-                handle_client(client_socket, client_ip);
-                
-                std::lock_guard<std::mutex> lock(connection_mtx);
-                active_connections--;
-                connection_cv.notify_one();
-            }).detach();
         }
         
-        return true;
+        // At the limit: stop watching the listener until a slot frees up.
+        struct epoll_event event;
+        event.events = 0;
+        event.data.ptr = &worker;
+        epoll_ctl(worker.epoll_fd, EPOLL_CTL_MOD, worker.listen_fd, &event);
+        worker.listen_paused = true;
     }
     
-    void stop() {
-        running = false;
+    void close_connection(Worker& worker, Connection& connection) {
+        close(connection.fd);
+        worker.idle_order.erase(connection.idle_position);
+        
+        auto it = worker.connections.find(&connection);
+        std::unique_ptr<Connection> owned = std::move(it->second);
+        worker.connections.erase(it);
+        active_connections--;
+        
+        owned->fd = -1;
+        owned->input.clear();
+        owned->input_offset = 0;
+        owned->parser.reset();
+        owned->head_buffer.clear();
+        owned->outputs.clear();
+        owned->output_sent = 0;
+        owned->close_after_flush = false;
+        owned->peer_closed = false;
+        worker.free_connections.push_back(std::move(owned));
+        
+        if (worker.listen_paused) {
+            struct epoll_event event;
+            event.events = EPOLLIN | EPOLLET;
+            event.data.ptr = &worker;
+            epoll_ctl(worker.epoll_fd, EPOLL_CTL_MOD, worker.listen_fd, &event);
+            worker.listen_paused = false;
+        }
     }
     
-    void add_route(const std::string& path, const std::string& handler) {
-        routes[path] = handler;
+    void expire_idle(Worker& worker) {
+        auto deadline = std::chrono::steady_clock::now() - keep_alive_timeout;
+        while (!worker.idle_order.empty() && worker.idle_order.front()->last_active < deadline) {
+            close_connection(worker, *worker.idle_order.front());
+        }
     }
-
-private:
-    void handle_client(int client_socket, const std::string& client_ip) {
-        char buffer[4096];
-        int bytes_received = recv(client_socket, buffer, sizeof(buffer) - 1, 0);
+    
+    void handle_event(Worker& worker, Connection& connection, uint32_t events) {
+        connection.last_active = std::chrono::steady_clock::now();
+        worker.idle_order.splice(worker.idle_order.end(), worker.idle_order, connection.idle_position);
         
-        if (bytes_received <= 0) {
-            close(client_socket);
+        if (events & EPOLLERR) {
+            close_connection(worker, connection);
             return;
         }
         
-        buffer[bytes_received] = '\0';
-        
-        HTTPRequest request = parse_request(buffer);
-        request.client_ip = client_ip;
-        HTTPResponse response = process_request(request);
-        
-        request_logger.log_request(
-            client_ip,
-            request.method,
-            request.path,
-            response.status_code,
-            request.headers["User-Agent"]
-        );
+        // Edge-triggered: read until EAGAIN, handling requests as they
+        // complete. While responses are backed up or the connection is
+        // closing, reading stops and the socket is left unread; the EPOLLOUT
+        // edge after the flush resumes it. Buffered input therefore stays
+        // within one request plus one read, however much the client sends.
+        for (;;) {
+            // A full flush may unblock pipelined requests that were held
+            // back, and no further edge will arrive for bytes already
+            // buffered.
+            size_t processed;
+            do {
+                processed = process_input(connection);
+                if (!flush_output(connection)) {
+                    close_connection(worker, connection);
+                    return;
+                }
+            } while (processed > 0 && connection.outputs.empty());
+            
+            if (connection.peer_closed || !accepts_input(connection)) break;
+            
+            if (connection.input_offset > 0 &&
+                (connection.input_offset == connection.input.size() || connection.input_offset >= 64 * 1024)) {
+                connection.input.erase(0, connection.input_offset);
+                connection.input_offset = 0;
+            }
+            size_t used = connection.input.size();
+            connection.input.resize(std::max(connection.input.capacity(), used + 4096));
+            ssize_t bytes_received = recv(connection.fd, &connection.input[used], connection.input.size() - used, 0);
+            connection.input.resize(used + std::max<ssize_t>(bytes_received, 0));
+            
+            if (bytes_received > 0) continue;
+            if (bytes_received == 0) {
+                connection.peer_closed = true;
+                continue;
+            }
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                close_connection(worker, connection);
+                return;
+            }
+            break;
+        }
         
-        send_response(client_socket, response);
-        close(client_socket);
+        if (connection.outputs.empty() && (connection.close_after_flush || connection.peer_closed)) {
+            close_connection(worker, connection);
+        }
     }
     
-    HTTPRequest parse_request(const std::string& raw_request) {
-        HTTPRequest request;
-        std::istringstream stream(raw_request);
-        std::string line;
-        
-        if (std::getline(stream, line)) {
-            std::istringstream line_stream(line);
-            line_stream >> request.method >> request.path >> request.version;
-        }
-        
-        while (std::getline(stream, line) && line != "\r") {
-            if (line.empty() || line == "\r") break;
+    bool accepts_input(const Connection& connection) const {
+        return !connection.close_after_flush && connection.outputs.size() < max_pipelined_responses;
+    }
+    
+    // Handles every complete request in the buffer, up to the pipelining
+    // limit; returns how many were queued.
+    size_t process_input(Connection& connection) {
+        size_t processed = 0;
+        while (accepts_input(connection)) {
+            std::string_view pending = std::string_view(connection.input).substr(connection.input_offset);
+            RequestParser::State state = connection.parser.parse(pending);
             
-            size_t colon_pos = line.find(':');
-            if (colon_pos != std::string::npos) {
-                std::string key = line.substr(0, colon_pos);
-                std::string value = line.substr(colon_pos + 1);
-                
-                value.erase(0, value.find_first_not_of(" \t"));
-                
-                if (!value.empty() && value.back() == '\r') {
-                    value.pop_back();
-                }
-                
-                request.headers[key] = value;
+            if (state == RequestParser::State::ERROR) {
+                queue_response(connection, error_response(connection.parser.get_error_status()), false);
+                return processed + 1;
+            }
+            if (state != RequestParser::State::COMPLETE) {
+                return processed;
+            }
+            
+            HTTPRequest request = connection.parser.request(pending);
+            request.client_ip = connection.client_ip;
+            
+            bool keep_alive = wants_keep_alive(request);
+            HTTPResponse response;
+            if (!rate_limiter.should_allow_request(connection.client_key)) {
+                response.status_code = 429;
+                response.status_text = "Too Many Requests";
+                response.body = "Rate limit exceeded. Please try again later.";
+                keep_alive = false;
+            } else {
+                response = process_request(request);
             }
+            
+            request_logger.log_request(
+                connection.client_ip,
+                request.method,
+                request.path,
+                response.status_code,
+                request.header("User-Agent")
+            );
+            
+            connection.input_offset += connection.parser.consumed();
+            connection.parser.reset();
+            queue_response(connection, std::move(response), keep_alive);
+            processed++;
         }
-        
-        std::string body;
-        while (std::getline(stream, line)) {
-            body += line + "\n";
+        return processed;
+    }
+    
+    static bool wants_keep_alive(const HTTPRequest& request) {
+        std::string_view connection = request.header("Connection");
+        if (request.version == "HTTP/1.1") {
+            return !HTTPRequest::iequals(connection, "close");
         }
-        request.body = body;
-        
-        return request;
+        return HTTPRequest::iequals(connection, "keep-alive");
+    }
+    
+    HTTPResponse error_response(int status_code) {
+        HTTPResponse response;
+        response.status_code = status_code;
+        switch (status_code) {
+            case 413: response.status_text = "Payload Too Large"; break;
+            case 431: response.status_text = "Request Header Fields Too Large"; break;
+            case 501: response.status_text = "Not Implemented"; break;
+            default: response.status_text = "Bad Request"; break;
+        }
+        response.headers["Connection"] = "close";
+        response.body = response.status_text;
+        return response;
     }
     
     std::string hash_password(const std::string& password) {
@@ -325,21 +1251,35 @@ private:
         return true;
     }
     
+    // One pass over the command, rejecting what the old pattern list did:
+    // rm\s+[-rf]+, >> or >&, |, ;, `, $(, sudo and chmod.
     bool validate_command(const std::string& command) {
-        static const std::regex unsafe_patterns[] = {
-            std::regex("rm\\s+[-rf]+"),
-            std::regex(">[>&]"),
-            std::regex("\\|"),
-            std::regex(";"),
-            std::regex("`"),
-            std::regex("\\$\\("),
-            std::regex("sudo"),
-            std::regex("chmod")
-        };
-        
-        for (const auto& pattern : unsafe_patterns) {
-            if (std::regex_search(command, pattern)) {
-                return false;
+        std::string_view text = command;
+        for (size_t i = 0; i < text.size(); i++) {
+            switch (text[i]) {
+                case '|': case ';': case '`':
+                    return false;
+                case '>':
+                    if (i + 1 < text.size() && (text[i + 1] == '>' || text[i + 1] == '&')) return false;
+                    break;
+                case '$':
+                    if (i + 1 < text.size() && text[i + 1] == '(') return false;
+                    break;
+                case 's':
+                    if (text.compare(i, 4, "sudo") == 0) return false;
+                    break;
+                case 'c':
+                    if (text.compare(i, 5, "chmod") == 0) return false;
+                    break;
+                case 'r':
+                    if (text.compare(i, 2, "rm") == 0) {
+                        size_t j = i + 2;
+                        while (j < text.size() && std::isspace(static_cast<unsigned char>(text[j]))) j++;
+                        if (j > i + 2 && j < text.size() && (text[j] == '-' || text[j] == 'r' || text[j] == 'f')) {
+                            return false;
+                        }
+                    }
+                    break;
             }
         }
         return true;
@@ -352,67 +1292,96 @@ private:
         response.headers = SecurityHeaders::get_default_security_headers();
         response.headers["Content-Type"] = "text/html";
         
-        if (request.method == "GET") {
-            if (request.path == "/") {
-                response.status_code = 200;
-                response.status_text = "OK";
-                response.body = "<html><body><h1>Welcome to Vulnerable Server</h1></body></html>";
-            }
-            else if (request.path.find("/file/") == 0) {
-                std::string filename = request.path.substr(6);
-                if (!validate_file_path(filename)) {
-                    response.status_code = 403;
-                    response.status_text = "Forbidden";
-                    response.body = "Invalid file path";
-                } else {
-                    response = serve_file(filename);
+        std::string_view path = request.path;
+        size_t segment_end = path.find_first_of("/?", 1);
+        std::string_view rest = segment_end == std::string_view::npos ? std::string_view() : path.substr(segment_end);
+        auto route = routes.find(std::string(path.substr(0, segment_end)));
+        if (route == routes.end()) {
+            return response;
+        }
+        
+        bool is_get = request.method == "GET";
+        bool is_post = request.method == "POST";
+        switch (route->second) {
+            case Route::INDEX:
+                if (is_get && rest.empty()) {
+                    response.status_code = 200;
+                    response.status_text = "OK";
+                    response.body = "<html><body><h1>Welcome to Vulnerable Server</h1></body></html>";
                 }
-            }
-            else if (request.path.find("/exec/") == 0) {
-                std::string command = request.path.substr(6);
-                if (!validate_command(command)) {
-                    response.status_code = 403;
-                    response.status_text = "Forbidden";
-                    response.body = "Invalid command";
-                } else {
-                    response = execute_command(command);
+                break;
+            case Route::FILE:
+                if (is_get && !rest.empty() && rest[0] == '/') {
+                    std::string filename(rest.substr(1));
+                    if (!validate_file_path(filename)) {
+                        response.status_code = 403;
+                        response.status_text = "Forbidden";
+                        response.body = "Invalid file path";
+                    } else {
+                        response = serve_file(filename, request);
+                    }
                 }
-            }
-            else if (request.path.find("/search") == 0) {
-                size_t query_pos = request.path.find("?q=");
-                if (query_pos != std::string::npos) {
-                    std::string query = request.path.substr(query_pos + 3);
-                    response = search_files(query);
+                break;
+            case Route::COMMAND:
+                if (is_get && !rest.empty() && rest[0] == '/') {
+                    std::string command(rest.substr(1));
+                    if (!validate_command(command)) {
+                        response.status_code = 403;
+                        response.status_text = "Forbidden";
+                        response.body = "Invalid command";
+                    } else {
+                        response = execute_command(command);
+                    }
                 }
-            }
-        }
-        else if (request.method == "POST") {
-            if (request.path == "/upload") {
-                response = handle_file_upload(request);
-            }
-            else if (request.path == "/login") {
-                response = handle_login(request);
-            }
+                break;
+            case Route::SEARCH:
+                if (is_get) {
+                    size_t query_pos = path.find("?q=");
+                    if (query_pos != std::string::npos) {
+                        std::string query(path.substr(query_pos + 3));
+                        response = search_files(query);
+                    }
+                }
+                break;
+            case Route::UPLOAD:
+                if (is_post && rest.empty()) {
+                    response = handle_file_upload(request);
+                }
+                break;
+            case Route::LOGIN:
+                if (is_post && rest.empty()) {
+                    response = handle_login(request);
+                }
+                break;
         }
         
         return response;
     }
     
-    HTTPResponse serve_file(const std::string& filename) {
+    // The body goes out with sendfile() from a cached descriptor; a matching
+    // If-None-Match gets a bodiless 304.
+    HTTPResponse serve_file(const std::string& filename, const HTTPRequest& request) {
         HTTPResponse response;
         response.status_code = 200;
         response.status_text = "OK";
         response.headers["Content-Type"] = "text/plain";
         
-        std::ifstream file(filename);
-        if (file.is_open()) {
-            std::string content((std::istreambuf_iterator<char>(file)),
-                               std::istreambuf_iterator<char>());
-            response.body = content;
-        } else {
+        auto file = file_cache.open_file(filename);
+        if (!file) {
             response.status_code = 404;
             response.status_text = "File Not Found";
             response.body = "File not found: " + filename;
+            return response;
+        }
+        
+        response.headers["ETag"] = file->etag;
+        std::string_view if_none_match = request.header("If-None-Match");
+        if (!if_none_match.empty() && FileCache::etag_matches(if_none_match, file->etag)) {
+            response.status_code = 304;
+            response.status_text = "Not Modified";
+            response.headers.erase("Content-Type");
+        } else {
+            response.file = std::move(file);
         }
         
         return response;
@@ -501,13 +1470,13 @@ private:
         response.status_text = "OK";
         response.headers["Content-Type"] = "text/html";
         
-        std::string body = request.body;
+        std::string_view body = request.body;
         size_t user_pos = body.find("username=");
         size_t pass_pos = body.find("password=");
         
         if (user_pos != std::string::npos && pass_pos != std::string::npos) {
-            std::string username = body.substr(user_pos + 9, body.find('&', user_pos) - user_pos - 9);
-            std::string password = body.substr(pass_pos + 9);
+            std::string username(body.substr(user_pos + 9, body.find('&', user_pos) - user_pos - 9));
+            std::string password(body.substr(pass_pos + 9));
             std::string hashed_password = hash_password(password);
             
             if (username == "admin" && password == "admin123") {
@@ -523,19 +1492,126 @@ private:
         return response;
     }
     
-    void send_response(int client_socket, const HTTPResponse& response) {
-        std::string response_str = "HTTP/1.1 " + std::to_string(response.status_code) + 
-                                 " " + response.status_text + "\r\n";
+    // Serializes the status line and headers into the connection's reusable
+    // head buffer; the body is written from its own string by writev.
+    void queue_response(Connection& connection, HTTPResponse response, bool keep_alive) {
+        std::string& head = connection.head_buffer;
+        size_t head_offset = head.size();
+        
+        char number[24];
+        auto status_end = std::to_chars(number, number + sizeof(number), response.status_code).ptr;
+        head.append("HTTP/1.1 ");
+        head.append(number, status_end - number);
+        head.push_back(' ');
+        head.append(response.status_text);
+        head.append("\r\n");
         
         for (const auto& header : response.headers) {
-            response_str += header.first + ": " + header.second + "\r\n";
+            if (header.first == "Connection") continue;
+            head.append(header.first);
+            head.append(": ");
+            head.append(header.second);
+            head.append("\r\n");
         }
         
-        response_str += "Content-Length: " + std::to_string(response.body.length()) + "\r\n";
-        response_str += "\r\n";
-        response_str += response.body;
+        // A 304 describes the entity it stands in for, so it carries no length.
+        if (response.status_code != 304) {
+            size_t content_length = response.file ? static_cast<size_t>(response.file->size) : response.body.length();
+            auto length_end = std::to_chars(number, number + sizeof(number), content_length).ptr;
+            head.append("Content-Length: ");
+            head.append(number, length_end - number);
+            head.append("\r\n");
+        }
+        head.append(keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
         
-        send(client_socket, response_str.c_str(), response_str.length(), 0);
+        connection.outputs.push_back({head_offset, head.size() - head_offset, std::move(response.body), std::move(response.file)});
+        if (!keep_alive) {
+            connection.close_after_flush = true;
+        }
+    }
+    
+    // Writes every queued response with as few writev calls as the socket
+    // allows; file bodies go out with sendfile() once everything before them
+    // has been written. Returns false on a write error.
+    // Drops the heads of responses already sent. A keep-alive client that
+    // always has a request in flight never empties outputs, so without this
+    // head_buffer would grow with every response on the connection.
+    static void trim_heads(Connection& connection) {
+        if (connection.outputs.empty()) return;
+        size_t sent = connection.outputs.front().head_offset;
+        if (sent == 0) return;
+        connection.head_buffer.erase(0, sent);
+        for (auto& output : connection.outputs) {
+            output.head_offset -= sent;
+        }
+    }
+    
+    bool flush_output(Connection& connection) {
+        while (!connection.outputs.empty()) {
+            struct iovec iov[64];
+            int iov_count = 0;
+            size_t skip = connection.output_sent;
+            const FileCache::Entry* file = nullptr;
+            for (const auto& output : connection.outputs) {
+                if (skip >= output.head_length) {
+                    skip -= output.head_length;
+                } else {
+                    iov[iov_count].iov_base = const_cast<char*>(connection.head_buffer.data() + output.head_offset + skip);
+                    iov[iov_count].iov_len = output.head_length - skip;
+                    iov_count++;
+                    skip = 0;
+                    if (iov_count == 64) break;
+                }
+                
+                size_t body_length = output.body_length();
+                if (skip >= body_length) {
+                    skip -= body_length;
+                    continue;
+                }
+                if (output.file) {
+                    // skip is now the offset into the file.
+                    if (iov_count == 0) file = output.file.get();
+                    break;
+                }
+                iov[iov_count].iov_base = const_cast<char*>(output.body.data() + skip);
+                iov[iov_count].iov_len = body_length - skip;
+                iov_count++;
+                skip = 0;
+                if (iov_count == 64) break;
+            }
+            
+            ssize_t written;
+            if (file) {
+                off_t offset = static_cast<off_t>(skip);
+                written = sendfile(connection.fd, file->fd, &offset, static_cast<size_t>(file->size) - skip);
+                // The file shrank underneath us; the promised length can't be met.
+                if (written == 0) return false;
+            } else {
+                written = writev(connection.fd, iov, iov_count);
+            }
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            connection.output_sent += written;
+            
+            size_t done = 0;
+            size_t consumed = connection.output_sent;
+            for (const auto& output : connection.outputs) {
+                size_t total = output.head_length + output.body_length();
+                if (consumed < total) break;
+                consumed -= total;
+                done++;
+            }
+            if (done > 0) {
+                connection.outputs.erase(connection.outputs.begin(), connection.outputs.begin() + done);
+                connection.output_sent = consumed;
+                trim_heads(connection);
+            }
+        }
+        connection.head_buffer.clear();
+        connection.output_sent = 0;
+        return true;
     }
 };
 
@@ -8,7 +8,6 @@
 #include <cstdlib>
 #include <memory>
 #include <algorithm>
-#include <regex>
 #include <chrono>
 #include <thread>
 #include <mutex>
@@ -18,11 +17,20 @@
 #include <set>
 #include <optional>
 #include <variant>
+#include <string_view>
+#include <unordered_map>
+#include <cstdint>
+#include <charconv>
+#include <exception>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 class XMLValidator {
 private:
-    std::set<std::string> allowed_tags;
-    std::set<std::string> allowed_attributes;
+    std::set<std::string, std::less<>> allowed_tags;
+    std::set<std::string, std::less<>> allowed_attributes;
     size_t max_depth;
     size_t max_children;
     size_t max_attributes;
@@ -44,11 +52,11 @@ public:
         allowed_attributes.insert(attr);
     }
     
-    bool is_tag_allowed(const std::string& tag) const {
+    bool is_tag_allowed(std::string_view tag) const {
         return allowed_tags.empty() || allowed_tags.find(tag) != allowed_tags.end();
     }
     
-    bool is_attribute_allowed(const std::string& attr) const {
+    bool is_attribute_allowed(std::string_view attr) const {
         return allowed_attributes.empty() || allowed_attributes.find(attr) != allowed_attributes.end();
     }
     
@@ -138,14 +146,61 @@ private:
     Type type_;
 };
 
+// Read-only mapping of a whole regular file; the view stays valid for the
+// lifetime of the object.
+class MappedFile {
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+
+public:
+    explicit MappedFile(const std::string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw XMLError(XMLError::Type::IOError, "Failed to open file: " + filename);
+        }
+        
+        struct stat info;
+        if (fstat(fd, &info) < 0) {
+            close(fd);
+            throw XMLError(XMLError::Type::IOError, "Failed to stat file: " + filename);
+        }
+        
+        size = static_cast<size_t>(info.st_size);
+        if (size > 0) {
+            void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                close(fd);
+                throw XMLError(XMLError::Type::IOError, "Failed to map file: " + filename);
+            }
+            madvise(mapping, size, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapping);
+        }
+        close(fd);
+    }
+    
+    ~MappedFile() {
+        if (data) {
+            munmap(const_cast<char*>(data), size);
+        }
+    }
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    std::string_view view() const {
+        return std::string_view(data, size);
+    }
+};
+
 class XMLStats {
 public:
     size_t total_nodes = 0;
     size_t max_depth = 0;
     size_t total_attributes = 0;
     size_t total_text_length = 0;
-    std::map<std::string, size_t> tag_counts;
-    std::map<std::string, size_t> attribute_counts;
+    std::map<std::string, size_t, std::less<>> tag_counts;
+    std::map<std::string, size_t, std::less<>> attribute_counts;
     std::chrono::milliseconds parse_time{0};
     
     void print() const {
@@ -176,39 +231,701 @@ public:
     }
 };
 
+// Interns tag and attribute names as dense integers. Names are views into
+// the document, so a table must not outlive the buffer it was built from.
+class SymbolTable {
+private:
+    std::unordered_map<std::string_view, uint32_t> ids;
+    std::vector<std::string_view> names;
+
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+    
+    uint32_t intern(std::string_view name) {
+        auto inserted = ids.try_emplace(name, static_cast<uint32_t>(names.size()));
+        if (inserted.second) {
+            names.push_back(name);
+        }
+        return inserted.first->second;
+    }
+    
+    uint32_t find(std::string_view name) const {
+        auto it = ids.find(name);
+        return it == ids.end() ? npos : it->second;
+    }
+    
+    std::string_view name(uint32_t id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+    
+    size_t memory_usage() const {
+        return names.capacity() * sizeof(std::string_view) +
+               ids.bucket_count() * sizeof(void*) +
+               ids.size() * (sizeof(std::string_view) + sizeof(uint32_t) + 2 * sizeof(void*));
+    }
+};
+
+// Names, attribute values and text are raw slices of the parser's input and
+// stay valid as long as the document does. Entity references in them are
+// left undecoded. name_id indexes the parser's SymbolTable.
+struct XMLAttribute {
+    std::string_view name;
+    std::string_view value;
+    uint32_t name_id;
+};
+
+struct XMLEvent {
+    enum class Type { StartElement, EndElement, Text, CData, Comment };
+    
+    Type type = Type::Text;
+    std::string_view name;
+    uint32_t name_id = SymbolTable::npos;
+    std::string_view text;
+    std::vector<XMLAttribute> attributes;
+    size_t depth = 0;
+};
+
+// Pull parser over an in-memory (usually mmap'd) document: each next() call
+// produces one event without copying, so memory use is bounded by nesting
+// depth rather than document size. A self-closing tag yields a start and an
+// end event. Validator limits are enforced and XMLStats collected as events
+// are produced; violations throw XMLError. Names are interned as they are
+// scanned, so per-name counts and allow-list checks are indexed by symbol;
+// the name-keyed stats maps are filled in once, when parsing ends.
+class XMLPullParser {
+private:
+    enum : int8_t { UNCHECKED = 0, ALLOWED = 1, DENIED = -1 };
+    
+    struct OpenElement {
+        std::string_view name;
+        uint32_t name_id;
+        size_t children;
+    };
+    
+    std::string_view input;
+    size_t position = 0;
+    const XMLValidator& validator;
+    XMLStats& stats;
+    const std::atomic<bool>* cancelled;
+    std::vector<OpenElement> open_elements;
+    bool pending_end = false;
+    bool root_seen = false;
+    SymbolTable symbols;
+    std::vector<size_t> tag_hits;
+    std::vector<size_t> attribute_hits;
+    std::vector<int8_t> tag_permissions;
+    std::vector<int8_t> attribute_permissions;
+    bool stats_flushed = false;
+
+public:
+    XMLPullParser(std::string_view input, const XMLValidator& validator, XMLStats& stats,
+                  const std::atomic<bool>* cancelled = nullptr)
+        : input(input), validator(validator), stats(stats), cancelled(cancelled) {}
+    
+    ~XMLPullParser() {
+        flush_stats();
+    }
+    
+    XMLPullParser(const XMLPullParser&) = delete;
+    XMLPullParser& operator=(const XMLPullParser&) = delete;
+    
+    // Returns false once the root element has closed and the input is spent.
+    bool next(XMLEvent& event) {
+        if (cancelled && cancelled->load(std::memory_order_relaxed)) {
+            throw XMLError(XMLError::Type::InvalidSyntax, "Parsing cancelled");
+        }
+        
+        event.name = std::string_view();
+        event.name_id = SymbolTable::npos;
+        event.text = std::string_view();
+        event.attributes.clear();
+        
+        if (pending_end) {
+            pending_end = false;
+            close_element(event);
+            return true;
+        }
+        
+        while (position < input.size()) {
+            if (input[position] != '<') {
+                size_t end = input.find('<', position);
+                if (end == std::string_view::npos) end = input.size();
+                std::string_view text = input.substr(position, end - position);
+                position = end;
+                
+                if (open_elements.empty()) {
+                    if (!is_blank(text)) {
+                        throw XMLError(XMLError::Type::InvalidSyntax, "Text outside the root element");
+                    }
+                    continue;
+                }
+                check_text_length(text.size());
+                stats.total_text_length += text.size();
+                event.type = XMLEvent::Type::Text;
+                event.text = text;
+                event.depth = open_elements.size();
+                return true;
+            }
+            
+            std::string_view rest = input.substr(position);
+            if (starts_with(rest, "<!--")) {
+                if (!validator.get_allow_comments()) {
+                    throw XMLError(XMLError::Type::DisallowedComment, "Comments are not allowed");
+                }
+                size_t end = input.find("-->", position + 4);
+                if (end == std::string_view::npos) {
+                    throw XMLError(XMLError::Type::InvalidSyntax, "Unterminated comment");
+                }
+                event.type = XMLEvent::Type::Comment;
+                event.text = input.substr(position + 4, end - position - 4);
+                event.depth = open_elements.size();
+                position = end + 3;
+                return true;
+            }
+            if (starts_with(rest, "<![CDATA[")) {
+                if (!validator.get_allow_cdata()) {
+                    throw XMLError(XMLError::Type::DisallowedCDATA, "CDATA sections are not allowed");
+                }
+                if (open_elements.empty()) {
+                    throw XMLError(XMLError::Type::InvalidSyntax, "CDATA outside the root element");
+                }
+                size_t end = input.find("]]>", position + 9);
+                if (end == std::string_view::npos) {
+                    throw XMLError(XMLError::Type::InvalidSyntax, "Unterminated CDATA section");
+                }
+                event.type = XMLEvent::Type::CData;
+                event.text = input.substr(position + 9, end - position - 9);
+                event.depth = open_elements.size();
+                check_text_length(event.text.size());
+                stats.total_text_length += event.text.size();
+                position = end + 3;
+                return true;
+            }
+            if (starts_with(rest, "<!DOCTYPE")) {
+                if (!validator.get_allow_dtd()) {
+                    throw XMLError(XMLError::Type::DisallowedDTD, "DTD processing is not allowed");
+                }
+                skip_doctype();
+                continue;
+            }
+            if (starts_with(rest, "<?")) {
+                size_t end = input.find("?>", position + 2);
+                if (end == std::string_view::npos) {
+                    throw XMLError(XMLError::Type::InvalidSyntax, "Unterminated processing instruction");
+                }
+                position = end + 2;
+                continue;
+            }
+            if (starts_with(rest, "</")) {
+                parse_end_tag(event);
+                return true;
+            }
+            parse_start_tag(event);
+            return true;
+        }
+        
+        if (!open_elements.empty()) {
+            throw XMLError(XMLError::Type::InvalidSyntax,
+                         "Missing closing tag for: " + std::string(open_elements.back().name));
+        }
+        if (!root_seen) {
+            throw XMLError(XMLError::Type::InvalidSyntax, "No root element found");
+        }
+        flush_stats();
+        return false;
+    }
+    
+    size_t depth() const { return open_elements.size(); }
+    
+    const SymbolTable& get_symbols() const { return symbols; }
+    
+    // Hands the symbol table to a consumer that keeps name ids, e.g. a DOM.
+    SymbolTable release_symbols() {
+        flush_stats();
+        return std::move(symbols);
+    }
+    
+    // Adds the per-symbol counts to the stats maps. Runs once, at the end of
+    // the document or when the parser is destroyed after an error.
+    void flush_stats() {
+        if (stats_flushed) return;
+        stats_flushed = true;
+        for (size_t id = 0; id < tag_hits.size(); id++) {
+            if (tag_hits[id] > 0) {
+                stats.tag_counts[std::string(symbols.name(static_cast<uint32_t>(id)))] += tag_hits[id];
+            }
+        }
+        for (size_t id = 0; id < attribute_hits.size(); id++) {
+            if (attribute_hits[id] > 0) {
+                stats.attribute_counts[std::string(symbols.name(static_cast<uint32_t>(id)))] += attribute_hits[id];
+            }
+        }
+    }
+
+private:
+    static bool starts_with(std::string_view text, std::string_view prefix) {
+        return text.compare(0, prefix.size(), prefix) == 0;
+    }
+    
+    static bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+    
+    static bool is_blank(std::string_view text) {
+        return std::all_of(text.begin(), text.end(), is_space);
+    }
+    
+    static bool is_name_char(char c) {
+        return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-' || c == ':' || c == '.' ||
+               static_cast<unsigned char>(c) >= 0x80;
+    }
+    
+    size_t skip_space(size_t from) const {
+        while (from < input.size() && is_space(input[from])) from++;
+        return from;
+    }
+    
+    std::string_view scan_name(size_t& from) const {
+        size_t start = from;
+        while (from < input.size() && is_name_char(input[from])) from++;
+        if (from == start || isdigit(static_cast<unsigned char>(input[start])) ||
+            input[start] == '-' || input[start] == '.') {
+            throw XMLError(XMLError::Type::InvalidSyntax, "Invalid name at offset " + std::to_string(start));
+        }
+        return input.substr(start, from - start);
+    }
+    
+    void check_text_length(size_t length) const {
+        if (length > validator.get_max_text_length()) {
+            throw XMLError(XMLError::Type::MaxTextLengthExceeded,
+                         "Text length exceeds maximum allowed");
+        }
+    }
+    
+    static void count(std::vector<size_t>& hits, uint32_t id) {
+        if (id >= hits.size()) {
+            hits.resize(id + 1, 0);
+        }
+        hits[id]++;
+    }
+    
+    // The allow-list lookup runs once per distinct name.
+    template <typename Check>
+    static bool permitted(std::vector<int8_t>& permissions, uint32_t id, std::string_view name, Check check) {
+        if (id >= permissions.size()) {
+            permissions.resize(id + 1, UNCHECKED);
+        }
+        if (permissions[id] == UNCHECKED) {
+            permissions[id] = check(name) ? ALLOWED : DENIED;
+        }
+        return permissions[id] == ALLOWED;
+    }
+    
+    void parse_start_tag(XMLEvent& event) {
+        size_t cursor = position + 1;
+        std::string_view name = scan_name(cursor);
+        uint32_t name_id = symbols.intern(name);
+        
+        if (open_elements.empty() && root_seen) {
+            throw XMLError(XMLError::Type::InvalidSyntax, "Content after the root element");
+        }
+        size_t depth = open_elements.size();
+        if (depth > validator.get_max_depth()) {
+            throw XMLError(XMLError::Type::MaxDepthExceeded,
+                         "Maximum nesting depth exceeded");
+        }
+        if (!open_elements.empty()) {
+            if (open_elements.back().children >= validator.get_max_children()) {
+                throw XMLError(XMLError::Type::MaxChildrenExceeded,
+                             "Maximum number of child nodes exceeded");
+            }
+            open_elements.back().children++;
+        }
+        if (!permitted(tag_permissions, name_id, name,
+                       [this](std::string_view tag) { return validator.is_tag_allowed(tag); })) {
+            throw XMLError(XMLError::Type::DisallowedTag,
+                         "Tag not allowed: " + std::string(name));
+        }
+        
+        bool self_closing = false;
+        for (;;) {
+            size_t next = skip_space(cursor);
+            if (next >= input.size()) {
+                throw XMLError(XMLError::Type::InvalidSyntax, "Unclosed tag found");
+            }
+            if (input[next] == '>') {
+                cursor = next + 1;
+                break;
+            }
+            if (input[next] == '/') {
+                if (next + 1 >= input.size() || input[next + 1] != '>') {
+                    throw XMLError(XMLError::Type::InvalidSyntax, "Malformed tag: " + std::string(name));
+                }
+                self_closing = true;
+                cursor = next + 2;
+                break;
+            }
+            if (next == cursor) {
+                throw XMLError(XMLError::Type::InvalidSyntax, "Malformed tag: " + std::string(name));
+            }
+            
+            cursor = next;
+            std::string_view attr_name = scan_name(cursor);
+            uint32_t attr_id = symbols.intern(attr_name);
+            cursor = skip_space(cursor);
+            if (cursor >= input.size() || input[cursor] != '=') {
+                throw XMLError(XMLError::Type::InvalidSyntax, "Attribute without value: " + std::string(attr_name));
+            }
+            cursor = skip_space(cursor + 1);
+            if (cursor >= input.size() || (input[cursor] != '"' && input[cursor] != '\'')) {
+                throw XMLError(XMLError::Type::InvalidSyntax, "Unquoted attribute value: " + std::string(attr_name));
+            }
+            size_t value_end = input.find(input[cursor], cursor + 1);
+            if (value_end == std::string_view::npos) {
+                throw XMLError(XMLError::Type::InvalidSyntax, "Unclosed tag found");
+            }
+            
+            if (event.attributes.size() >= validator.get_max_attributes()) {
+                throw XMLError(XMLError::Type::MaxAttributesExceeded,
+                             "Maximum number of attributes exceeded");
+            }
+            if (!permitted(attribute_permissions, attr_id, attr_name,
+                           [this](std::string_view attr) { return validator.is_attribute_allowed(attr); })) {
+                throw XMLError(XMLError::Type::DisallowedAttribute,
+                             "Attribute not allowed: " + std::string(attr_name));
+            }
+            std::string_view value = input.substr(cursor + 1, value_end - cursor - 1);
+            check_text_length(value.size());
+            event.attributes.push_back({attr_name, value, attr_id});
+            count(attribute_hits, attr_id);
+            stats.total_attributes++;
+            cursor = value_end + 1;
+        }
+        
+        position = cursor;
+        root_seen = true;
+        open_elements.push_back({name, name_id, 0});
+        stats.total_nodes++;
+        stats.max_depth = std::max(stats.max_depth, depth);
+        count(tag_hits, name_id);
+        
+        event.type = XMLEvent::Type::StartElement;
+        event.name = name;
+        event.name_id = name_id;
+        event.depth = depth;
+        pending_end = self_closing;
+    }
+    
+    void parse_end_tag(XMLEvent& event) {
+        size_t cursor = position + 2;
+        std::string_view name = scan_name(cursor);
+        cursor = skip_space(cursor);
+        if (cursor >= input.size() || input[cursor] != '>') {
+            throw XMLError(XMLError::Type::InvalidSyntax, "Unclosed tag found");
+        }
+        if (open_elements.empty() || open_elements.back().name != name) {
+            throw XMLError(XMLError::Type::InvalidSyntax,
+                         "Unexpected closing tag: " + std::string(name));
+        }
+        position = cursor + 1;
+        close_element(event);
+    }
+    
+    void close_element(XMLEvent& event) {
+        event.type = XMLEvent::Type::EndElement;
+        event.name = open_elements.back().name;
+        event.name_id = open_elements.back().name_id;
+        event.depth = open_elements.size() - 1;
+        open_elements.pop_back();
+    }
+    
+    // Skips <!DOCTYPE ...>, including a bracketed internal subset.
+    void skip_doctype() {
+        if (root_seen) {
+            throw XMLError(XMLError::Type::InvalidSyntax, "DOCTYPE after the root element");
+        }
+        size_t cursor = position + 9;
+        int brackets = 0;
+        char quote = 0;
+        for (; cursor < input.size(); cursor++) {
+            char c = input[cursor];
+            if (quote) {
+                if (c == quote) quote = 0;
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+            } else if (c == '[') {
+                brackets++;
+            } else if (c == ']') {
+                brackets--;
+            } else if (c == '>' && brackets <= 0) {
+                position = cursor + 1;
+                return;
+            }
+        }
+        throw XMLError(XMLError::Type::InvalidSyntax, "Unterminated DOCTYPE");
+    }
+};
+
+// Bump allocator for decoded strings. Blocks are only released together,
+// so the returned views stay valid for the arena's lifetime.
+class StringArena {
+private:
+    static constexpr size_t block_size = 64 * 1024;
+    
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* cursor = nullptr;
+    size_t remaining = 0;
+    size_t allocated = 0;
+
+public:
+    std::string_view store(std::string_view text) {
+        if (text.empty()) return std::string_view();
+        if (text.size() > block_size / 4) {
+            // Large strings get a block of their own, so the current block
+            // is not abandoned half full.
+            blocks.push_back(std::make_unique<char[]>(text.size()));
+            allocated += text.size();
+            std::memcpy(blocks.back().get(), text.data(), text.size());
+            return std::string_view(blocks.back().get(), text.size());
+        }
+        if (text.size() > remaining) {
+            blocks.push_back(std::make_unique<char[]>(block_size));
+            allocated += block_size;
+            cursor = blocks.back().get();
+            remaining = block_size;
+        }
+        char* out = cursor;
+        std::memcpy(out, text.data(), text.size());
+        cursor += text.size();
+        remaining -= text.size();
+        return std::string_view(out, text.size());
+    }
+    
+    // Takes over another arena's blocks; views into them stay valid.
+    void merge(StringArena&& other) {
+        for (auto& block : other.blocks) {
+            blocks.push_back(std::move(block));
+        }
+        allocated += other.allocated;
+        other.blocks.clear();
+        other.cursor = nullptr;
+        other.remaining = 0;
+        other.allocated = 0;
+    }
+    
+    size_t memory_usage() const {
+        return allocated + blocks.capacity() * sizeof(void*);
+    }
+};
+
+// Compact DOM: nodes and attributes live in two contiguous arrays linked by
+// index, names are SymbolTable ids, and text and attribute values point
+// either into the source buffer (kept alive by the document) or, where
+// entities had to be decoded, into the string arena. An element's first run
+// of text is stored inline; only mixed content needs separate text nodes.
+// Destroying the document frees everything in a handful of deallocations.
+class XMLDocument {
+public:
+    using NodeId = uint32_t;
+    static constexpr NodeId npos = UINT32_MAX;
+    
+    enum class NodeType : uint8_t { Element, Text };
+    
+    struct Node {
+        NodeId parent = npos;
+        NodeId first_child = npos;
+        NodeId next_sibling = npos;
+        uint32_t name = SymbolTable::npos;
+        uint32_t first_attribute = 0;
+        uint32_t attribute_count = 0;
+        uint32_t text_length = 0;
+        NodeType type = NodeType::Element;
+        const char* text_data = nullptr;
+        
+        std::string_view text() const { return std::string_view(text_data, text_length); }
+    };
+    
+    struct Attribute {
+        uint32_t name;
+        uint32_t value_length;
+        const char* value_data;
+        
+        std::string_view value() const { return std::string_view(value_data, value_length); }
+    };
+
+private:
+    std::shared_ptr<const void> source;
+    std::vector<Node> nodes;
+    std::vector<Attribute> attributes;
+    SymbolTable symbols;
+    StringArena strings;
+    
+    static uint32_t checked_length(std::string_view text) {
+        if (text.size() > UINT32_MAX) {
+            throw XMLError(XMLError::Type::MaxTextLengthExceeded, "Text length exceeds maximum allowed");
+        }
+        return static_cast<uint32_t>(text.size());
+    }
+
+public:
+    explicit XMLDocument(std::shared_ptr<const void> source) : source(std::move(source)) {}
+    
+    XMLDocument(const XMLDocument&) = delete;
+    XMLDocument& operator=(const XMLDocument&) = delete;
+    
+    void reserve(size_t node_count) {
+        nodes.reserve(node_count);
+    }
+    
+    // previous is the parent's current last child (npos if none); the
+    // builder tracks it so nodes need no last-child link.
+    NodeId add_element(NodeId parent, NodeId previous, uint32_t name) {
+        NodeId id = static_cast<NodeId>(nodes.size());
+        Node node;
+        node.parent = parent;
+        node.name = name;
+        node.first_attribute = static_cast<uint32_t>(attributes.size());
+        link(parent, previous, id);
+        nodes.push_back(node);
+        return id;
+    }
+    
+    // Attributes must be added right after their element. Returns the
+    // attribute's index for set_attribute_value().
+    size_t add_attribute(NodeId element, uint32_t name, std::string_view value) {
+        attributes.push_back({name, checked_length(value), value.data()});
+        nodes[element].attribute_count++;
+        return attributes.size() - 1;
+    }
+    
+    // Returns the node now holding the text: parent itself if the text went
+    // inline, otherwise a new text node.
+    NodeId add_text(NodeId parent, NodeId previous, std::string_view text) {
+        Node& owner = nodes[parent];
+        if (owner.first_child == npos && owner.text_length == 0) {
+            owner.text_data = text.data();
+            owner.text_length = checked_length(text);
+            return parent;
+        }
+        NodeId id = static_cast<NodeId>(nodes.size());
+        Node node;
+        node.parent = parent;
+        node.type = NodeType::Text;
+        node.text_data = text.data();
+        node.text_length = checked_length(text);
+        link(parent, previous, id);
+        nodes.push_back(node);
+        return id;
+    }
+    
+    void set_text(NodeId id, std::string_view text) {
+        nodes[id].text_data = text.data();
+        nodes[id].text_length = checked_length(text);
+    }
+    
+    void set_attribute_value(size_t index, std::string_view value) {
+        attributes[index].value_data = value.data();
+        attributes[index].value_length = checked_length(value);
+    }
+    
+    // Copies text that does not exist verbatim in the source.
+    std::string_view store(std::string_view text) {
+        return strings.store(text);
+    }
+    
+    // For strings decoded into a separate arena, e.g. on another thread.
+    void adopt(StringArena&& arena) {
+        strings.merge(std::move(arena));
+    }
+    
+    void set_symbols(SymbolTable table) {
+        symbols = std::move(table);
+    }
+    
+    NodeId root() const { return nodes.empty() ? npos : 0; }
+    const Node& node(NodeId id) const { return nodes[id]; }
+    size_t node_count() const { return nodes.size(); }
+    
+    std::string_view name(NodeId id) const {
+        return symbols.name(nodes[id].name);
+    }
+    
+    std::string_view attribute_name(const Attribute& attribute) const {
+        return symbols.name(attribute.name);
+    }
+    
+    const Attribute* attributes_begin(NodeId id) const {
+        return attributes.data() + nodes[id].first_attribute;
+    }
+    
+    const Attribute* attributes_end(NodeId id) const {
+        return attributes_begin(id) + nodes[id].attribute_count;
+    }
+    
+    std::optional<std::string_view> attribute(NodeId id, std::string_view attr_name) const {
+        uint32_t symbol = symbols.find(attr_name);
+        for (const Attribute* attr = attributes_begin(id); attr != attributes_end(id); ++attr) {
+            if (attr->name == symbol) return attr->value();
+        }
+        return std::nullopt;
+    }
+    
+    bool has_element_children(NodeId id) const {
+        for (NodeId child = nodes[id].first_child; child != npos; child = nodes[child].next_sibling) {
+            if (nodes[child].type == NodeType::Element) return true;
+        }
+        return false;
+    }
+    
+    // The element's own text: the inline run plus any text children.
+    std::string text(NodeId id) const {
+        std::string result(nodes[id].text());
+        for (NodeId child = nodes[id].first_child; child != npos; child = nodes[child].next_sibling) {
+            if (nodes[child].type == NodeType::Text) result += nodes[child].text();
+        }
+        return result;
+    }
+    
+    NodeId find_child(NodeId id, std::string_view child_name) const {
+        uint32_t symbol = symbols.find(child_name);
+        if (symbol == SymbolTable::npos) return npos;
+        for (NodeId child = nodes[id].first_child; child != npos; child = nodes[child].next_sibling) {
+            if (nodes[child].type == NodeType::Element && nodes[child].name == symbol) return child;
+        }
+        return npos;
+    }
+    
+    // Bytes owned by the document, not counting the shared source buffer.
+    size_t memory_usage() const {
+        return sizeof(*this) + nodes.capacity() * sizeof(Node) +
+               attributes.capacity() * sizeof(Attribute) +
+               symbols.memory_usage() + strings.memory_usage();
+    }
+
+private:
+    void link(NodeId parent, NodeId previous, NodeId id) {
+        if (previous != npos) {
+            nodes[previous].next_sibling = id;
+        } else if (parent != npos) {
+            nodes[parent].first_child = id;
+        }
+    }
+};
+
 class XMLParser {
 private:
-    std::string xml_content;
-    std::map<std::string, std::string> entities;
+    // Owns the buffer document points into: a MappedFile or a std::string.
+    // Documents built from it share ownership, since their values are
+    // slices of it.
+    std::shared_ptr<const void> document_owner;
+    std::string_view document;
+    std::unordered_map<std::string, std::string> entities;
+    size_t decode_threads = 0;
     bool external_entities_enabled;
     XMLValidator validator;
     XMLStats stats;
     std::atomic<bool> parsing_cancelled{false};
     std::mutex parse_mutex;
     
-    struct XMLNode {
-        std::string name;
-        std::map<std::string, std::string> attributes;
-        std::string content;
-        std::vector<std::shared_ptr<XMLNode>> children;
-        std::weak_ptr<XMLNode> parent;
-        size_t depth = 0;
-        
-        bool has_circular_reference() const {
-            std::set<const XMLNode*> visited;
-            const XMLNode* current = this;
-            while (current) {
-                if (!visited.insert(current).second) {
-                    return true;
-                }
-                auto parent_ptr = current->parent.lock();
-                if (!parent_ptr) break;
-                current = parent_ptr.get();
-            }
-            return false;
-        }
-    };
-    
     class ParseGuard {
     private:
         XMLParser& parser;
@@ -230,6 +947,12 @@ public:
     
     ~XMLParser() = default;
     
+    // Threads used to decode entity references when building a large
+    // document; 0 means one per core, 1 decodes inline.
+    void set_decode_threads(size_t threads) {
+        decode_threads = threads;
+    }
+    
     void set_external_entities(bool enabled) {
         external_entities_enabled = enabled;
     }
@@ -246,26 +969,43 @@ public:
         parsing_cancelled = true;
     }
     
+    // Regular files are mapped rather than copied; anything else (pipes,
+    // devices) is read in chunks.
     bool load_from_file(const std::string& filename) {
-        std::ifstream file(filename);
+        struct stat info;
+        if (stat(filename.c_str(), &info) == 0 && S_ISREG(info.st_mode)) {
+            auto mapping = std::make_shared<MappedFile>(filename);
+            document = mapping->view();
+            document_owner = std::move(mapping);
+            return true;
+        }
+        
+        std::ifstream file(filename, std::ios::binary);
         if (!file.is_open()) {
             throw XMLError(XMLError::Type::IOError, "Failed to open file: " + filename);
         }
         
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        xml_content = buffer.str();
+        auto content = std::make_shared<std::string>();
+        char chunk[65536];
+        while (file.read(chunk, sizeof(chunk)) || file.gcount() > 0) {
+            content->append(chunk, static_cast<size_t>(file.gcount()));
+        }
+        document = *content;
+        document_owner = std::move(content);
         
         return true;
     }
     
     bool load_from_string(const std::string& content) {
-        xml_content = content;
+        auto copy = std::make_shared<std::string>(content);
+        document = *copy;
+        document_owner = std::move(copy);
         return true;
     }
     
-    std::shared_ptr<XMLNode> parse() {
-        if (xml_content.empty()) {
+    // Builds the tree as one consumer of the pull parser's event stream.
+    std::unique_ptr<XMLDocument> parse() {
+        if (document.empty()) {
             return nullptr;
         }
         
@@ -273,45 +1013,145 @@ public:
         stats = XMLStats();
         
         try {
-            return parse_node(xml_content, 0);
+            return build_document();
         } catch (const XMLError& e) {
             std::cerr << "XML parsing error: " << e.what() << std::endl;
             return nullptr;
         }
     }
     
-    std::string process_entities(const std::string& text) {
+    // SAX-style: calls handler(const XMLEvent&) for every event without
+    // building a tree. Stats are collected as for parse(); errors throw.
+    template <typename Handler>
+    void parse_events(Handler&& handler) {
+        ParseGuard guard(*this);
+        stats = XMLStats();
+        
+        XMLPullParser reader(document, validator, stats, &parsing_cancelled);
+        XMLEvent event;
+        while (reader.next(event)) {
+            handler(event);
+        }
+    }
+    
+    // For callers that want to drive parsing themselves. The reader refers
+    // to this parser's document, validator and stats.
+    XMLPullParser pull_parser() {
+        parsing_cancelled = false;
+        stats = XMLStats();
+        return XMLPullParser(document, validator, stats, &parsing_cancelled);
+    }
+    
+    // Decoded text for the DOM; process_entities() is the escaped form.
+    std::string process_entities(std::string_view text) {
+        return XMLSanitizer::sanitize_text(decode_entities(text));
+    }
+    
+    std::string decode_entities(std::string_view text) {
+        std::string result;
+        decode_entities_into(text, result);
+        return result;
+    }
+    
+    // One left-to-right pass: memchr finds each '&' and the runs between
+    // references are appended unchanged. Replacement text is not rescanned,
+    // so cost is linear and a self-referencing entity cannot loop. A '&'
+    // with no later ';' is kept literally.
+    void decode_entities_into(std::string_view text, std::string& out) {
         if (text.length() > validator.get_max_text_length()) {
             throw XMLError(XMLError::Type::MaxTextLengthExceeded,
                          "Text length exceeds maximum allowed");
         }
         
-        std::string result = text;
+        out.reserve(out.size() + text.size());
+        if (!external_entities_enabled) {
+            out.append(text);
+            return;
+        }
         
-        if (external_entities_enabled) {
-            std::regex entity_regex("&([^;]+);");
-            std::smatch match;
+        const char* cursor = text.data();
+        const char* end = text.data() + text.size();
+        while (cursor < end) {
+            const char* amp = static_cast<const char*>(std::memchr(cursor, '&', end - cursor));
+            if (!amp) {
+                out.append(cursor, end - cursor);
+                break;
+            }
+            out.append(cursor, amp - cursor);
             
-            while (std::regex_search(result, match, entity_regex)) {
-                if (parsing_cancelled) {
-                    throw XMLError(XMLError::Type::InvalidSyntax, "Parsing cancelled");
-                }
-                
-                std::string entity_name = match[1];
-                std::string replacement = resolve_entity(entity_name);
-                result.replace(match.position(), match.length(), replacement);
+            const char* semicolon = static_cast<const char*>(std::memchr(amp + 1, ';', end - amp - 1));
+            if (!semicolon) {
+                out.append(amp, end - amp);
+                break;
+            }
+            if (semicolon == amp + 1) {
+                out.push_back('&');
+                cursor = amp + 1;
+                continue;
             }
+            
+            std::string_view name(amp + 1, semicolon - amp - 1);
+            if (const char* predefined = predefined_entity(name)) {
+                out.push_back(*predefined);
+            } else if (name[0] == '#') {
+                append_character_reference(name, out);
+            } else {
+                out += resolve_entity(std::string(name));
+            }
+            cursor = semicolon + 1;
+        }
+    }
+    
+    static const char* predefined_entity(std::string_view name) {
+        switch (name.size()) {
+            case 2:
+                if (name == "lt") return "<";
+                if (name == "gt") return ">";
+                break;
+            case 3:
+                if (name == "amp") return "&";
+                break;
+            case 4:
+                if (name == "quot") return "\"";
+                if (name == "apos") return "'";
+                break;
+        }
+        return nullptr;
+    }
+    
+    // &#NNN; and &#xHHH;, appended as UTF-8.
+    static void append_character_reference(std::string_view name, std::string& out) {
+        bool hex = name.size() > 1 && (name[1] == 'x' || name[1] == 'X');
+        std::string_view digits = name.substr(hex ? 2 : 1);
+        uint32_t code = 0;
+        auto parsed = std::from_chars(digits.data(), digits.data() + digits.size(), code, hex ? 16 : 10);
+        if (digits.empty() || parsed.ec != std::errc() || parsed.ptr != digits.data() + digits.size() ||
+            code == 0 || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) {
+            throw XMLError(XMLError::Type::MalformedEntity,
+                          "Invalid character reference: " + std::string(name));
         }
         
-        return XMLSanitizer::sanitize_text(result);
+        if (code < 0x80) {
+            out.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
     }
     
     std::string resolve_entity(const std::string& entity_name) {
-        if (entity_name == "lt") return "<";
-        if (entity_name == "gt") return ">";
-        if (entity_name == "amp") return "&";
-        if (entity_name == "quot") return "\"";
-        if (entity_name == "apos") return "'";
+        if (const char* predefined = predefined_entity(entity_name)) {
+            return predefined;
+        }
         
         if (entity_name.find("SYSTEM") != std::string::npos) {
             if (!validator.get_allow_dtd()) {
@@ -368,227 +1208,215 @@ public:
                       "Failed to read external entity: " + file_path);
     }
     
+    // Values are stored as given; text is escaped when it is written out.
     void add_entity(const std::string& name, const std::string& value) {
-        entities[XMLSanitizer::sanitize_tag_name(name)] = 
-            XMLSanitizer::sanitize_text(value);
+        entities[XMLSanitizer::sanitize_tag_name(name)] = value;
     }
     
+    // Replaces each CDATA section in text with its escaped contents, in one
+    // pass. The parser itself sees CDATA as events; this is for fragments.
     std::string extract_cdata(const std::string& text) {
         if (!validator.get_allow_cdata()) {
             throw XMLError(XMLError::Type::DisallowedCDATA,
                          "CDATA sections are not allowed");
         }
         
-        std::string result = text;
-        std::regex cdata_regex("<!\\[CDATA\\[(.*?)\\]\\]>");
-        std::smatch match;
+        static constexpr std::string_view open_marker = "<![CDATA[";
+        static constexpr std::string_view close_marker = "]]>";
+        std::string_view rest = text;
+        std::string result;
+        result.reserve(text.size());
         
-        while (std::regex_search(result, match, cdata_regex)) {
-            if (parsing_cancelled) {
-                throw XMLError(XMLError::Type::InvalidSyntax, "Parsing cancelled");
+        for (;;) {
+            size_t start = rest.find(open_marker);
+            size_t finish = start == std::string_view::npos
+                ? std::string_view::npos : rest.find(close_marker, start + open_marker.size());
+            if (finish == std::string_view::npos) {
+                result.append(rest);
+                break;
             }
-            
-            std::string cdata_content = match[1];
-            result.replace(match.position(), match.length(), 
-                         XMLSanitizer::sanitize_text(cdata_content));
+            result.append(rest.substr(0, start));
+            result += XMLSanitizer::sanitize_text(std::string(
+                rest.substr(start + open_marker.size(), finish - start - open_marker.size())));
+            rest.remove_prefix(finish + close_marker.size());
         }
         
         return result;
     }
     
-    std::shared_ptr<XMLNode> parse_node(const std::string& content, size_t depth) {
-        if (parsing_cancelled) {
-            throw XMLError(XMLError::Type::InvalidSyntax, "Parsing cancelled");
-        }
-        
-        if (depth > validator.get_max_depth()) {
-            throw XMLError(XMLError::Type::MaxDepthExceeded,
-                         "Maximum nesting depth exceeded");
-        }
-        
-        auto node = std::make_shared<XMLNode>();
-        node->depth = depth;
-        stats.max_depth = std::max(stats.max_depth, depth);
-        stats.total_nodes++;
-        
-        size_t tag_start = content.find('<');
-        if (tag_start == std::string::npos) {
-            return nullptr;
-        }
-        
-        size_t tag_end = content.find('>', tag_start);
-        if (tag_end == std::string::npos) {
-            throw XMLError(XMLError::Type::InvalidSyntax,
-                         "Unclosed tag found");
-        }
-        
-        std::string tag_content = content.substr(tag_start + 1, tag_end - tag_start - 1);
-        
-        if (tag_content[0] == '/') {
-            return nullptr;
-        }
-        
-        bool self_closing = (tag_content.back() == '/');
-        
-        size_t space_pos = tag_content.find(' ');
-        if (space_pos != std::string::npos) {
-            node->name = XMLSanitizer::sanitize_tag_name(
-                tag_content.substr(0, space_pos));
-            parse_attributes(tag_content.substr(space_pos + 1), node);
-        } else {
-            node->name = XMLSanitizer::sanitize_tag_name(
-                self_closing ? tag_content.substr(0, tag_content.length() - 1) 
-                           : tag_content);
-        }
-        
-        if (!validator.is_tag_allowed(node->name)) {
-            throw XMLError(XMLError::Type::DisallowedTag,
-                         "Tag not allowed: " + node->name);
-        }
-        
-        stats.tag_counts[node->name]++;
-        
-        if (self_closing) {
-            return node;
-        }
-        
-        std::string closing_tag = "</" + node->name + ">";
-        size_t content_start = tag_end + 1;
-        size_t content_end = content.find(closing_tag, content_start);
-        
-        if (content_end == std::string::npos) {
-            throw XMLError(XMLError::Type::InvalidSyntax,
-                         "Missing closing tag for: " + node->name);
-        }
+    // A value holding entity references, decoded after the tree is built.
+    struct PendingDecode {
+        std::string_view raw;
+        size_t target;
+        bool is_attribute;
+    };
+    
+    static constexpr size_t parallel_decode_threshold = 4096;
+    
+    std::unique_ptr<XMLDocument> build_document() {
+        XMLPullParser reader(document, validator, stats, &parsing_cancelled);
+        auto result = std::make_unique<XMLDocument>(document_owner);
+        // Most elements cost a start and an end tag.
+        result->reserve(static_cast<size_t>(std::count(document.begin(), document.end(), '<')) / 2 + 1);
         
-        std::string raw_content = content.substr(content_start, 
-                                               content_end - content_start);
-        node->content = process_entities(extract_cdata(raw_content));
-        stats.total_text_length += node->content.length();
+        struct OpenNode {
+            XMLDocument::NodeId id;
+            XMLDocument::NodeId last_child;
+        };
+        std::vector<OpenNode> path;
+        std::vector<PendingDecode> pending;
+        XMLEvent event;
         
-        size_t child_start = 0;
-        while (child_start < raw_content.length()) {
-            if (node->children.size() >= validator.get_max_children()) {
-                throw XMLError(XMLError::Type::MaxChildrenExceeded,
-                             "Maximum number of child nodes exceeded");
-            }
-            
-            size_t child_tag_start = raw_content.find('<', child_start);
-            if (child_tag_start == std::string::npos) {
-                break;
-            }
-            
-            auto child_node = parse_node(raw_content, depth + 1);
-            if (child_node) {
-                child_node->parent = node;
-                if (child_node->has_circular_reference()) {
-                    throw XMLError(XMLError::Type::InvalidSyntax,
-                                 "Circular reference detected");
+        while (reader.next(event)) {
+            switch (event.type) {
+                case XMLEvent::Type::StartElement: {
+                    XMLDocument::NodeId id;
+                    if (path.empty()) {
+                        id = result->add_element(XMLDocument::npos, XMLDocument::npos, event.name_id);
+                    } else {
+                        id = result->add_element(path.back().id, path.back().last_child, event.name_id);
+                        path.back().last_child = id;
+                    }
+                    for (const auto& attr : event.attributes) {
+                        size_t index = result->add_attribute(id, attr.name_id, attr.value);
+                        if (attr.value.find('&') != std::string_view::npos) {
+                            pending.push_back({attr.value, index, true});
+                        }
+                    }
+                    path.push_back({id, XMLDocument::npos});
+                    break;
                 }
-                node->children.push_back(child_node);
-                child_start = raw_content.find('>', child_tag_start) + 1;
-            } else {
-                break;
+                case XMLEvent::Type::EndElement:
+                    path.pop_back();
+                    break;
+                case XMLEvent::Type::Text:
+                case XMLEvent::Type::CData: {
+                    // Indentation between elements is not content.
+                    if (event.type == XMLEvent::Type::Text &&
+                        event.text.find_first_not_of(" \t\r\n") == std::string_view::npos) {
+                        break;
+                    }
+                    OpenNode& owner = path.back();
+                    XMLDocument::NodeId id = result->add_text(owner.id, owner.last_child, event.text);
+                    if (id != owner.id) {
+                        owner.last_child = id;
+                    }
+                    if (event.type == XMLEvent::Type::Text && event.text.find('&') != std::string_view::npos) {
+                        pending.push_back({event.text, id, false});
+                    }
+                    break;
+                }
+                case XMLEvent::Type::Comment:
+                    break;
             }
         }
         
-        return node;
+        decode_pending(*result, pending);
+        result->set_symbols(reader.release_symbols());
+        return result;
     }
     
-    void parse_attributes(const std::string& attr_string, 
-                         std::shared_ptr<XMLNode> node) {
-        std::regex attr_regex("([^\\s=]+)=\"([^\"]*)\"");
-        std::smatch match;
-        std::string::const_iterator search_start(attr_string.cbegin());
+    // Values are independent, so large batches are split across threads,
+    // each decoding into its own arena. The first error is rethrown.
+    void decode_pending(XMLDocument& target, const std::vector<PendingDecode>& pending) {
+        size_t threads = decode_threads > 0 ? decode_threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min(threads, pending.size() / parallel_decode_threshold + 1);
         
-        while (std::regex_search(search_start, attr_string.cend(), match, attr_regex)) {
-            if (node->attributes.size() >= validator.get_max_attributes()) {
-                throw XMLError(XMLError::Type::MaxAttributesExceeded,
-                             "Maximum number of attributes exceeded");
+        std::vector<StringArena> arenas(threads);
+        std::vector<std::exception_ptr> errors(threads);
+        auto decode_range = [&](size_t worker, size_t begin, size_t end) {
+            try {
+                std::string buffer;
+                for (size_t i = begin; i < end; i++) {
+                    buffer.clear();
+                    decode_entities_into(pending[i].raw, buffer);
+                    std::string_view value = arenas[worker].store(buffer);
+                    if (pending[i].is_attribute) {
+                        target.set_attribute_value(pending[i].target, value);
+                    } else {
+                        target.set_text(static_cast<XMLDocument::NodeId>(pending[i].target), value);
+                    }
+                }
+            } catch (...) {
+                errors[worker] = std::current_exception();
             }
-            
-            std::string name = XMLSanitizer::sanitize_tag_name(match[1]);
-            std::string value = match[2];
-            
-            if (!validator.is_attribute_allowed(name)) {
-                throw XMLError(XMLError::Type::DisallowedAttribute,
-                             "Attribute not allowed: " + name);
+        };
+        
+        if (threads <= 1) {
+            decode_range(0, 0, pending.size());
+        } else {
+            std::vector<std::thread> workers;
+            size_t per_thread = (pending.size() + threads - 1) / threads;
+            for (size_t worker = 1; worker < threads; worker++) {
+                size_t begin = std::min(pending.size(), worker * per_thread);
+                workers.emplace_back(decode_range, worker, begin, std::min(pending.size(), begin + per_thread));
+            }
+            decode_range(0, 0, std::min(pending.size(), per_thread));
+            for (auto& worker : workers) {
+                worker.join();
             }
-            
-            value = process_entities(value);
-            
-            node->attributes[name] = XMLSanitizer::sanitize_attribute(value);
-            stats.attribute_counts[name]++;
-            stats.total_attributes++;
-            
-            search_start = match.suffix().first;
+        }
+        
+        for (size_t worker = 0; worker < threads; worker++) {
+            target.adopt(std::move(arenas[worker]));
+        }
+        for (const auto& error : errors) {
+            if (error) std::rethrow_exception(error);
         }
     }
     
-    void print_node(const std::shared_ptr<XMLNode>& node, int depth = 0) {
-        if (!node) return;
+    void print_node(const XMLDocument& doc, XMLDocument::NodeId id = 0, int depth = 0) {
+        if (id == XMLDocument::npos || id >= doc.node_count()) return;
         
         std::string indent(depth * 2, ' ');
-        std::cout << indent << "<" << node->name;
+        std::cout << indent << "<" << doc.name(id);
         
-        for (const auto& attr : node->attributes) {
-            std::cout << " " << attr.first << "=\"" << attr.second << "\"";
+        for (auto attr = doc.attributes_begin(id); attr != doc.attributes_end(id); ++attr) {
+            std::cout << " " << doc.attribute_name(*attr) << "=\""
+                      << XMLSanitizer::sanitize_attribute(std::string(attr->value())) << "\"";
         }
         
-        if (node->children.empty() && node->content.empty()) {
+        std::string content = doc.text(id);
+        bool has_children = doc.has_element_children(id);
+        if (!has_children && content.empty()) {
             std::cout << "/>" << std::endl;
         } else {
             std::cout << ">";
             
-            if (!node->content.empty()) {
-                std::cout << node->content;
+            if (!content.empty()) {
+                std::cout << XMLSanitizer::sanitize_text(content);
             }
             
-            if (!node->children.empty()) {
+            if (has_children) {
                 std::cout << std::endl;
-                for (const auto& child : node->children) {
-                    print_node(child, depth + 1);
+                for (auto child = doc.node(id).first_child; child != XMLDocument::npos;
+                     child = doc.node(child).next_sibling) {
+                    if (doc.node(child).type == XMLDocument::NodeType::Element) {
+                        print_node(doc, child, depth + 1);
+                    }
                 }
                 std::cout << indent;
             }
             
-            std::cout << "</" << node->name << ">" << std::endl;
+            std::cout << "</" << doc.name(id) << ">" << std::endl;
         }
     }
     
-    std::string get_node_value(const std::shared_ptr<XMLNode>& node, 
-                              const std::string& path) {
-        if (!node) return "";
+    // path is relative to the root, e.g. "book/title".
+    std::string get_node_value(const XMLDocument& doc, const std::string& path) {
+        XMLDocument::NodeId id = doc.root();
+        if (id == XMLDocument::npos) return "";
         
-        std::vector<std::string> path_parts;
         std::istringstream path_stream(path);
         std::string part;
         
         while (std::getline(path_stream, part, '/')) {
-            if (!part.empty()) {
-                path_parts.push_back(part);
-            }
+            if (part.empty()) continue;
+            id = doc.find_child(id, part);
+            if (id == XMLDocument::npos) return "";
         }
         
-        return navigate_node(node, path_parts, 0);
-    }
-    
-    std::string navigate_node(const std::shared_ptr<XMLNode>& node,
-                            const std::vector<std::string>& path, 
-                            size_t index) {
-        if (!node || index >= path.size()) {
-            return node ? node->content : "";
-        }
-        
-        std::string target = path[index];
-        
-        for (const auto& child : node->children) {
-            if (child->name == target) {
-                return navigate_node(child, path, index + 1);
-            }
-        }
-        
-        return "";
+        return doc.text(id);
     }
 };
 
@@ -598,6 +1426,7 @@ int main(int argc, char* argv[]) {
         std::cout << "Commands:" << std::endl;
         std::cout << "  parse <filename> - Parse XML file" << std::endl;
         std::cout << "  string <xml_string> - Parse XML string" << std::endl;
+        std::cout << "  stream <filename> - Stream XML file without building a tree" << std::endl;
         std::cout << "  entity <name> <value> - Add entity" << std::endl;
         std::cout << "  external <enabled> - Enable/disable external entities" << std::endl;
         return 1;
@@ -624,7 +1453,7 @@ int main(int argc, char* argv[]) {
                 auto root = parser.parse();
                 if (root) {
                     std::cout << "Parsed XML structure:" << std::endl;
-                    parser.print_node(root);
+                    parser.print_node(*root);
                     parser.get_stats().print();
                 } else {
                     std::cout << "Failed to parse XML" << std::endl;
@@ -636,13 +1465,29 @@ int main(int argc, char* argv[]) {
                 auto root = parser.parse();
                 if (root) {
                     std::cout << "Parsed XML structure:" << std::endl;
-                    parser.print_node(root);
+                    parser.print_node(*root);
                     parser.get_stats().print();
                 } else {
                     std::cout << "Failed to parse XML" << std::endl;
                 }
             }
         }
+        else if (command == "stream" && argc == 3) {
+            if (parser.load_from_file(argv[2])) {
+                size_t elements = 0;
+                size_t text_nodes = 0;
+                parser.parse_events([&](const XMLEvent& event) {
+                    if (event.type == XMLEvent::Type::StartElement) {
+                        elements++;
+                    } else if (event.type == XMLEvent::Type::Text || event.type == XMLEvent::Type::CData) {
+                        text_nodes++;
+                    }
+                });
+                std::cout << "Streamed " << elements << " elements and " << text_nodes
+                          << " text nodes" << std::endl;
+                parser.get_stats().print();
+            }
+        }
         else if (command == "entity" && argc == 4) {
             parser.add_entity(argv[2], argv[3]);
             std::cout << "Added entity: " << argv[2] << " = " << argv[3] << std::endl;
@@ -17,78 +17,337 @@
 #include <optional>
 #include <variant>
 #include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <new>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+#include <iomanip>
+#include <shared_mutex>
+#include <deque>
+#include <cmath>
+#include <fstream>
+#include <execinfo.h>
 
+// Records live allocations for leak reports and heap profiles. With a
+// sample period of 0 every allocation is recorded; otherwise allocations are
+// sampled about once per sample_period bytes, at exponentially distributed
+// intervals as in tcmalloc's heap profiler, and only the sampled ones are
+// recorded. Each record carries a deduplicated call stack. Other calls touch
+// only their thread's counter shard and the live byte count.
 class MemoryTracker {
+public:
+    static constexpr size_t DEFAULT_SAMPLE_PERIOD = 512 * 1024;
+
 private:
+    static constexpr size_t COUNTER_SHARDS = 16;
+    static constexpr size_t TABLE_SHARDS = 64;
+    static constexpr size_t FILTER_SIZE = 4096;
+    static constexpr int MAX_FRAMES = 32;
+    static constexpr int SKIP_FRAMES = 2;
+    
     struct AllocationInfo {
-        void* ptr;
         size_t size;
-        std::string type;
-        std::chrono::steady_clock::time_point allocated_time;
+        const char* type;
+        uint32_t stack_id;
         std::thread::id thread_id;
-        std::string stack_trace;
+        std::chrono::steady_clock::time_point allocated_time;
+    };
+    
+    struct alignas(64) TableShard {
+        mutable std::mutex mtx;
+        std::unordered_map<void*, AllocationInfo> allocations;
+    };
+    
+    struct alignas(64) CounterShard {
+        std::atomic<uint64_t> allocation_count{0};
+        std::atomic<int64_t> bytes_until_sample{0};
+    };
+    
+    struct FramesHash {
+        size_t operator()(const std::vector<void*>& frames) const {
+            size_t hash = frames.size();
+            for (void* frame : frames) {
+                hash = hash * 1099511628211ULL ^ reinterpret_cast<uintptr_t>(frame);
+            }
+            return hash;
+        }
+    };
+    
+    struct StackInfo {
+        const std::vector<void*>* frames;
+        std::atomic<uint64_t> sampled_count{0};
+        std::atomic<uint64_t> sampled_bytes{0};
     };
     
-    std::map<void*, AllocationInfo> allocations;
-    std::mutex mtx;
-    std::atomic<size_t> total_allocated{0};
-    std::atomic<size_t> peak_allocated{0};
-    std::atomic<size_t> allocation_count{0};
+    const size_t sample_period;
+    CounterShard counters[COUNTER_SHARDS];
+    TableShard table[TABLE_SHARDS];
+    // Per-bucket count of recorded allocations, so frees of unrecorded
+    // pointers skip the table.
+    std::atomic<uint32_t> filter[FILTER_SIZE] = {};
+    std::atomic<int64_t> live_bytes{0};
+    std::atomic<int64_t> peak_bytes{0};
     
+    mutable std::shared_mutex stack_mutex;
+    std::unordered_map<std::vector<void*>, uint32_t, FramesHash> stack_ids;
+    std::deque<StackInfo> stacks;
+    
+    static size_t thread_shard() {
+        static std::atomic<size_t> next{0};
+        thread_local size_t shard = next.fetch_add(1, std::memory_order_relaxed) % COUNTER_SHARDS;
+        return shard;
+    }
+    
+    static size_t pointer_hash(const void* ptr) {
+        uintptr_t bits = reinterpret_cast<uintptr_t>(ptr);
+        return static_cast<size_t>((bits >> 4) * 0x9e3779b97f4a7c15ULL >> 32);
+    }
+    
+    TableShard& table_shard(const void* ptr) {
+        return table[pointer_hash(ptr) % TABLE_SHARDS];
+    }
+    
+    std::atomic<uint32_t>& filter_slot(const void* ptr) {
+        return filter[(pointer_hash(ptr) >> 8) % FILTER_SIZE];
+    }
+    
+    int64_t next_sample_interval() const {
+        thread_local std::mt19937_64 rng(std::random_device{}());
+        std::exponential_distribution<double> interval(1.0 / static_cast<double>(sample_period));
+        return std::max<int64_t>(1, static_cast<int64_t>(interval(rng)));
+    }
+    
+    bool should_sample(CounterShard& shard, size_t size) {
+        if (sample_period == 0) return true;
+        int64_t left = shard.bytes_until_sample.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+        if (left > static_cast<int64_t>(size)) return false;
+        shard.bytes_until_sample.store(next_sample_interval(), std::memory_order_relaxed);
+        return true;
+    }
+    
+    // Bytes and objects one recorded allocation of this size stands for.
+    double scale(size_t size) const {
+        if (sample_period == 0) return 1.0;
+        return 1.0 / (1.0 - std::exp(-static_cast<double>(size) / static_cast<double>(sample_period)));
+    }
+    
+    uint32_t capture_stack(size_t size) {
+        void* buffer[MAX_FRAMES + SKIP_FRAMES];
+        int depth = backtrace(buffer, MAX_FRAMES + SKIP_FRAMES);
+        std::vector<void*> frames(buffer + std::min(depth, SKIP_FRAMES), buffer + depth);
+        
+        StackInfo* info = nullptr;
+        uint32_t id;
+        {
+            std::shared_lock<std::shared_mutex> lock(stack_mutex);
+            auto it = stack_ids.find(frames);
+            if (it != stack_ids.end()) {
+                id = it->second;
+                info = &stacks[id - 1];
+            }
+        }
+        if (!info) {
+            std::unique_lock<std::shared_mutex> lock(stack_mutex);
+            auto inserted = stack_ids.emplace(std::move(frames), static_cast<uint32_t>(stacks.size() + 1));
+            id = inserted.first->second;
+            if (inserted.second) {
+                stacks.emplace_back();
+                stacks.back().frames = &inserted.first->first;
+            }
+            info = &stacks[id - 1];
+        }
+        info->sampled_count.fetch_add(1, std::memory_order_relaxed);
+        info->sampled_bytes.fetch_add(size, std::memory_order_relaxed);
+        return id;
+    }
+    
+    void print_stack(uint32_t stack_id, int max_frames) const {
+        std::shared_lock<std::shared_mutex> lock(stack_mutex);
+        const auto& frames = *stacks[stack_id - 1].frames;
+        int count = std::min(max_frames, static_cast<int>(frames.size()));
+        char** symbols = backtrace_symbols(frames.data(), count);
+        for (int i = 0; i < count; i++) {
+            std::cout << "      at " << (symbols ? symbols[i] : "?") << std::endl;
+        }
+        free(symbols);
+    }
+
 public:
-    void track_allocation(void* ptr, size_t size, const std::string& type) {
-        std::lock_guard<std::mutex> lock(mtx);
-        allocations[ptr] = {
-            ptr,
-            size,
-            type,
-            std::chrono::steady_clock::now(),
-            std::this_thread::get_id(),
-            get_stack_trace()
-        };
-        total_allocated += size;
-        allocation_count++;
-        peak_allocated = std::max(peak_allocated.load(), total_allocated.load());
+    explicit MemoryTracker(size_t sample_period = 0) : sample_period(sample_period) {
+        if (sample_period > 0) {
+            for (auto& shard : counters) {
+                shard.bytes_until_sample.store(next_sample_interval(), std::memory_order_relaxed);
+            }
+        }
     }
     
-    void track_deallocation(void* ptr) {
-        std::lock_guard<std::mutex> lock(mtx);
-        auto it = allocations.find(ptr);
-        if (it != allocations.end()) {
-            total_allocated -= it->second.size;
-            allocations.erase(it);
+    MemoryTracker(const MemoryTracker&) = delete;
+    MemoryTracker& operator=(const MemoryTracker&) = delete;
+    
+    // type must outlive the tracker (a literal or a typeid name).
+    void track_allocation(void* ptr, size_t size, const char* type) {
+        CounterShard& shard = counters[thread_shard()];
+        shard.allocation_count.fetch_add(1, std::memory_order_relaxed);
+        
+        int64_t live = live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + static_cast<int64_t>(size);
+        int64_t peak = peak_bytes.load(std::memory_order_relaxed);
+        while (live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
         }
+        
+        if (!should_sample(shard, size)) return;
+        
+        AllocationInfo info{size, type, capture_stack(size), std::this_thread::get_id(), std::chrono::steady_clock::now()};
+        TableShard& entry = table_shard(ptr);
+        {
+            std::lock_guard<std::mutex> lock(entry.mtx);
+            entry.allocations[ptr] = info;
+        }
+        filter_slot(ptr).fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    // size is needed for allocations that were not sampled; recorded ones
+    // use their own.
+    void track_deallocation(void* ptr, size_t size = 0) {
+        std::atomic<uint32_t>& slot = filter_slot(ptr);
+        if (slot.load(std::memory_order_relaxed) != 0) {
+            TableShard& entry = table_shard(ptr);
+            std::lock_guard<std::mutex> lock(entry.mtx);
+            auto it = entry.allocations.find(ptr);
+            if (it != entry.allocations.end()) {
+                live_bytes.fetch_sub(static_cast<int64_t>(it->second.size), std::memory_order_relaxed);
+                entry.allocations.erase(it);
+                slot.fetch_sub(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        if (sample_period > 0) {
+            live_bytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+        }
+    }
+    
+    size_t get_live_bytes() const {
+        return static_cast<size_t>(std::max<int64_t>(live_bytes.load(std::memory_order_relaxed), 0));
     }
     
-    std::string get_stack_trace() {
-        return "Stack trace not implemented";
+    size_t get_peak_bytes() const {
+        return static_cast<size_t>(peak_bytes.load(std::memory_order_relaxed));
+    }
+    
+    uint64_t get_allocation_count() const {
+        uint64_t total = 0;
+        for (const auto& shard : counters) {
+            total += shard.allocation_count.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+    
+    size_t get_recorded_count() const {
+        size_t total = 0;
+        for (const auto& shard : table) {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            total += shard.allocations.size();
+        }
+        return total;
     }
     
     void print_stats() const {
         std::cout << "Memory Statistics:" << std::endl;
-        std::cout << "  Total allocated: " << total_allocated << " bytes" << std::endl;
-        std::cout << "  Peak allocated: " << peak_allocated << " bytes" << std::endl;
-        std::cout << "  Allocation count: " << allocation_count << std::endl;
-        std::cout << "  Active allocations: " << allocations.size() << std::endl;
+        std::cout << "  Total allocated: " << get_live_bytes() << " bytes" << std::endl;
+        std::cout << "  Peak allocated: " << get_peak_bytes() << " bytes" << std::endl;
+        std::cout << "  Allocation count: " << get_allocation_count() << std::endl;
+        if (sample_period == 0) {
+            std::cout << "  Active allocations: " << get_recorded_count() << std::endl;
+        } else {
+            std::cout << "  Sampled active allocations: " << get_recorded_count()
+                      << " (one sample per " << sample_period << " bytes)" << std::endl;
+        }
+        std::shared_lock<std::shared_mutex> lock(stack_mutex);
+        std::cout << "  Distinct stacks: " << stacks.size() << std::endl;
     }
     
     void check_leaks() const {
-        if (!allocations.empty()) {
-            std::cout << "\nMemory Leaks Detected:" << std::endl;
-            for (const auto& pair : allocations) {
+        bool reported = false;
+        for (const auto& shard : table) {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            for (const auto& pair : shard.allocations) {
                 const auto& info = pair.second;
-                std::cout << "  Leak: " << info.size << " bytes at " << info.ptr
-                         << " (" << info.type << ")" << std::endl;
+                if (!reported) {
+                    std::cout << "\nMemory Leaks Detected" << (sample_period > 0 ? " (sampled)" : "") << ":" << std::endl;
+                    reported = true;
+                }
+                std::cout << "  Leak: " << info.size << " bytes at " << pair.first
+                          << " (" << info.type << ")";
+                if (sample_period > 0) {
+                    std::cout << ", ~" << static_cast<size_t>(info.size * scale(info.size)) << " bytes estimated";
+                }
+                std::cout << std::endl;
+                print_stack(info.stack_id, 3);
             }
         }
     }
+    
+    // Writes the recorded allocations in the gperftools heap profile text
+    // format, which pprof reads (unsampling heap_v2 profiles itself).
+    void dump_heap_profile(std::ostream& out) const {
+        struct Totals {
+            uint64_t count = 0;
+            uint64_t bytes = 0;
+        };
+        std::map<uint32_t, Totals> in_use;
+        for (const auto& shard : table) {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            for (const auto& pair : shard.allocations) {
+                Totals& totals = in_use[pair.second.stack_id];
+                totals.count++;
+                totals.bytes += pair.second.size;
+            }
+        }
+        
+        std::shared_lock<std::shared_mutex> lock(stack_mutex);
+        Totals all_in_use;
+        Totals all_sampled;
+        for (size_t i = 0; i < stacks.size(); i++) {
+            all_sampled.count += stacks[i].sampled_count.load(std::memory_order_relaxed);
+            all_sampled.bytes += stacks[i].sampled_bytes.load(std::memory_order_relaxed);
+        }
+        for (const auto& entry : in_use) {
+            all_in_use.count += entry.second.count;
+            all_in_use.bytes += entry.second.bytes;
+        }
+        
+        out << "heap profile: " << all_in_use.count << ": " << all_in_use.bytes << " [" << all_sampled.count
+            << ": " << all_sampled.bytes << "] @ ";
+        if (sample_period > 0) {
+            out << "heap_v2/" << sample_period << "\n";
+        } else {
+            out << "heapprofile\n";
+        }
+        
+        for (size_t i = 0; i < stacks.size(); i++) {
+            auto it = in_use.find(static_cast<uint32_t>(i + 1));
+            Totals live = it != in_use.end() ? it->second : Totals{};
+            out << std::setw(6) << live.count << ": " << std::setw(8) << live.bytes << " ["
+                << std::setw(6) << stacks[i].sampled_count.load(std::memory_order_relaxed) << ": "
+                << std::setw(8) << stacks[i].sampled_bytes.load(std::memory_order_relaxed) << "] @";
+            for (void* frame : *stacks[i].frames) {
+                out << " " << frame;
+            }
+            out << "\n";
+        }
+        
+        out << "\nMAPPED_LIBRARIES:\n";
+        std::ifstream maps("/proc/self/maps");
+        out << maps.rdbuf();
+    }
 };
 
 class ResourceManager {
 private:
     std::map<std::string, std::shared_ptr<void>> resources;
     std::map<std::string, std::weak_ptr<void>> weak_resources;
-    std::mutex resource_mutex;
+    mutable std::mutex resource_mutex;
     MemoryTracker memory_tracker;
     
     struct ResourceInfo {
@@ -102,7 +361,9 @@ private:
     std::vector<ResourceInfo> resource_history;
 
 public:
-    ResourceManager() = default;
+    // sample_period 0 records every resource; see MemoryTracker.
+    explicit ResourceManager(size_t sample_period = 0) : memory_tracker(sample_period) {}
+    
     ~ResourceManager() {
         memory_tracker.check_leaks();
     }
@@ -158,11 +419,10 @@ public:
         
         auto it = resources.find(name);
         if (it != resources.end()) {
-            memory_tracker.track_deallocation(it->second.get());
-            
             for (auto& info : resource_history) {
-                if (info.name == name) {
+                if (info.name == name && info.is_valid) {
                     info.is_valid = false;
+                    memory_tracker.track_deallocation(it->second.get(), info.size);
                     break;
                 }
             }
@@ -198,8 +458,12 @@ public:
     
     void clear_resources() {
         std::lock_guard<std::mutex> lock(resource_mutex);
-        for (const auto& pair : resources) {
-            memory_tracker.track_deallocation(pair.second.get());
+        for (auto& info : resource_history) {
+            auto it = resources.find(info.name);
+            if (info.is_valid && it != resources.end()) {
+                info.is_valid = false;
+                memory_tracker.track_deallocation(it->second.get(), info.size);
+            }
         }
         resources.clear();
         weak_resources.clear();
@@ -226,166 +490,649 @@ public:
         
         memory_tracker.print_stats();
     }
+    
+    void dump_heap_profile(std::ostream& out) const {
+        memory_tracker.dump_heap_profile(out);
+    }
 };
 
+// Slab allocator. Requests up to MAX_SMALL_SIZE are rounded up to a
+// power-of-two size class and served from SLAB_SIZE slabs carved into equal
+// blocks; free blocks form intrusive lists. Each thread keeps a small cache
+// per class and exchanges blocks with the class's central depot in batches,
+// so the common path takes no lock. Larger requests get an allocation of
+// their own. Slabs and large allocations both start on a SLAB_SIZE boundary
+// with a header, which is how deallocate() finds the class from a pointer.
 class MemoryPool {
 private:
-    std::vector<std::unique_ptr<char[]>> memory_blocks;
-    std::map<void*, size_t> allocated_sizes;
-    std::mutex pool_mutex;
-    MemoryTracker memory_tracker;
+    static constexpr size_t SLAB_SIZE = 64 * 1024;
+    static constexpr size_t HEADER_SIZE = 64;
+    // Slabs keep a free bitmap after the header; the 16-byte class has the
+    // most blocks and needs 4060 bits.
+    static constexpr size_t BITMAP_WORDS = 64;
+    static constexpr size_t FIRST_BLOCK = HEADER_SIZE + BITMAP_WORDS * sizeof(uint64_t);
+    static constexpr size_t MIN_CLASS_SHIFT = 4;
+    static constexpr size_t CLASS_COUNT = 10;
+    static constexpr size_t MAX_SMALL_SIZE = size_t(1) << (MIN_CLASS_SHIFT + CLASS_COUNT - 1);
+    static constexpr uint32_t LARGE_CLASS = CLASS_COUNT;
+    static constexpr uint64_t FREE_MARK = 0x5ca1ab1efee1deadULL;
+    
+    struct SlabHeader {
+        MemoryPool* pool;
+        uint32_t size_class;
+        uint32_t block_count;
+        size_t large_size;
+    };
+    static_assert(sizeof(SlabHeader) <= HEADER_SIZE, "slab header must fit before the bitmap");
+    static_assert((SLAB_SIZE - FIRST_BLOCK) >> MIN_CLASS_SHIFT <= BITMAP_WORDS * 64,
+                  "free bitmap must cover every block of the smallest class");
+    
+    // Overlays a free block; the mark lets check_memory_corruption() spot
+    // writes after free. Whether a block is free is decided by the slab's
+    // bitmap, never by the block's own bytes.
+    struct FreeBlock {
+        FreeBlock* next;
+        uint64_t mark;
+    };
+    
+    struct alignas(64) CentralList {
+        mutable std::mutex mtx;
+        FreeBlock* head = nullptr;
+        size_t count = 0;
+        size_t slabs = 0;
+    };
     
-    static constexpr size_t BLOCK_SIZE = 1024;
-    static constexpr size_t MAX_BLOCKS = 100;
+    // Touched only by its thread except for the counters, which the owner
+    // updates with plain relaxed stores so status reports can read them.
+    struct ThreadCache {
+        FreeBlock* heads[CLASS_COUNT] = {};
+        std::atomic<size_t> counts[CLASS_COUNT] = {};
+        std::atomic<int64_t> live[CLASS_COUNT] = {};
+    };
+    
+    struct CacheSlot {
+        uint64_t pool_id;
+        ThreadCache* cache;
+    };
     
-    struct BlockInfo {
-        size_t used_size;
-        size_t fragmentation;
-        bool is_corrupted;
+    // A thread's caches for every pool it has used. Pool ids are never
+    // reused, so slots of destroyed pools simply stop matching.
+    struct ThreadSlots {
+        std::vector<CacheSlot> slots;
+        
+        ~ThreadSlots() {
+            std::lock_guard<std::mutex> lock(live_pools_mutex());
+            for (const auto& slot : slots) {
+                auto it = live_pools().find(slot.pool_id);
+                if (it != live_pools().end()) {
+                    it->second->retire_cache(slot.cache);
+                }
+            }
+        }
     };
     
-    std::vector<BlockInfo> block_info;
+    const uint64_t pool_id;
+    const size_t max_bytes;
+    CentralList central[CLASS_COUNT];
+    mutable std::mutex registry_mutex;
+    std::unordered_set<char*> slab_bases;
+    std::vector<std::unique_ptr<ThreadCache>> caches;
+    std::vector<ThreadCache*> idle_caches;
+    std::atomic<size_t> reserved_bytes{0};
+    size_t large_count = 0;
+    size_t large_bytes = 0;
+    std::atomic<size_t> corrupted_blocks{0};
+    MemoryTracker memory_tracker;
+    
+    static std::mutex& live_pools_mutex() {
+        static std::mutex mtx;
+        return mtx;
+    }
+    
+    static std::unordered_map<uint64_t, MemoryPool*>& live_pools() {
+        static std::unordered_map<uint64_t, MemoryPool*> pools;
+        return pools;
+    }
+    
+    static uint64_t next_pool_id() {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+    
+    static size_t class_of(size_t size) {
+        size_t cls = 0;
+        while ((size_t(1) << (MIN_CLASS_SHIFT + cls)) < size) cls++;
+        return cls;
+    }
+    
+    static size_t block_size_of(size_t cls) {
+        return size_t(1) << (MIN_CLASS_SHIFT + cls);
+    }
+    
+    static size_t blocks_per_slab(size_t cls) {
+        return (SLAB_SIZE - FIRST_BLOCK) / block_size_of(cls);
+    }
+    
+    // Blocks moved between a thread cache and the depot at once.
+    static size_t batch_size(size_t cls) {
+        return std::min<size_t>(64, std::max<size_t>(2, 32 * 1024 / block_size_of(cls)));
+    }
+    
+    static SlabHeader* header_of(const void* ptr) {
+        return reinterpret_cast<SlabHeader*>(reinterpret_cast<uintptr_t>(ptr) & ~(uintptr_t(SLAB_SIZE) - 1));
+    }
+    
+    // One bit per block of a slab, set while the block is free.
+    static std::atomic<uint64_t>* free_bits(SlabHeader* header) {
+        return reinterpret_cast<std::atomic<uint64_t>*>(reinterpret_cast<char*>(header) + HEADER_SIZE);
+    }
+    
+    static size_t block_index(const SlabHeader* header, const void* ptr) {
+        size_t offset = static_cast<const char*>(ptr) - reinterpret_cast<const char*>(header);
+        return (offset - FIRST_BLOCK) >> (MIN_CLASS_SHIFT + header->size_class);
+    }
+    
+    // Returns false if the block was already free. The atomic swap means
+    // two racing frees of one block cannot both succeed.
+    static bool mark_free(SlabHeader* header, size_t index) {
+        uint64_t bit = uint64_t(1) << (index % 64);
+        return (free_bits(header)[index / 64].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+    }
+    
+    static void mark_live(SlabHeader* header, size_t index) {
+        uint64_t bit = uint64_t(1) << (index % 64);
+        free_bits(header)[index / 64].fetch_and(~bit, std::memory_order_relaxed);
+    }
+    
+    static bool is_free(SlabHeader* header, size_t index) {
+        return (free_bits(header)[index / 64].load(std::memory_order_relaxed) >> (index % 64)) & 1;
+    }
+    
+    template<typename T>
+    static void bump(std::atomic<T>& counter, T delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+    
+    ThreadCache& local_cache() {
+        auto& slots = thread_slots().slots;
+        for (const auto& slot : slots) {
+            if (slot.pool_id == pool_id) return *slot.cache;
+        }
+        return attach_cache();
+    }
+    
+    static ThreadSlots& thread_slots() {
+        thread_local ThreadSlots slots;
+        return slots;
+    }
+    
+    ThreadCache& attach_cache() {
+        ThreadCache* cache;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            if (!idle_caches.empty()) {
+                cache = idle_caches.back();
+                idle_caches.pop_back();
+            } else {
+                caches.push_back(std::make_unique<ThreadCache>());
+                cache = caches.back().get();
+            }
+        }
+        
+        auto& slots = thread_slots().slots;
+        {
+            std::lock_guard<std::mutex> lock(live_pools_mutex());
+            slots.erase(std::remove_if(slots.begin(), slots.end(), [](const CacheSlot& slot) {
+                return live_pools().count(slot.pool_id) == 0;
+            }), slots.end());
+        }
+        slots.push_back({pool_id, cache});
+        return *cache;
+    }
+    
+    // Called at thread exit: cached blocks go back to the depot and the cache
+    // (with its live counts) is kept for the next thread.
+    void retire_cache(ThreadCache* cache) {
+        for (size_t cls = 0; cls < CLASS_COUNT; cls++) {
+            release_to_central(*cache, cls, cache->counts[cls].load(std::memory_order_relaxed));
+        }
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        idle_caches.push_back(cache);
+    }
+    
+    bool reserve(size_t bytes) {
+        size_t current = reserved_bytes.load(std::memory_order_relaxed);
+        do {
+            if (max_bytes > 0 && current + bytes > max_bytes) return false;
+        } while (!reserved_bytes.compare_exchange_weak(current, current + bytes, std::memory_order_relaxed));
+        return true;
+    }
+    
+    char* new_region(size_t bytes) {
+        if (!reserve(bytes)) return nullptr;
+        void* region = nullptr;
+        if (posix_memalign(&region, SLAB_SIZE, bytes) != 0) {
+            reserved_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        slab_bases.insert(static_cast<char*>(region));
+        return static_cast<char*>(region);
+    }
+    
+    void free_region(char* base, size_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            slab_bases.erase(base);
+        }
+        reserved_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        free(base);
+    }
+    
+    // Caller holds central[cls].mtx.
+    bool carve_slab(size_t cls) {
+        char* base = new_region(SLAB_SIZE);
+        if (!base) return false;
+        
+        auto* header = reinterpret_cast<SlabHeader*>(base);
+        header->pool = this;
+        header->size_class = static_cast<uint32_t>(cls);
+        header->block_count = static_cast<uint32_t>(blocks_per_slab(cls));
+        header->large_size = 0;
+        std::atomic<uint64_t>* bits = free_bits(header);
+        for (size_t word = 0; word < BITMAP_WORDS; word++) {
+            size_t first = word * 64;
+            uint64_t value = first >= header->block_count ? 0
+                : header->block_count - first >= 64 ? ~uint64_t(0)
+                : (uint64_t(1) << (header->block_count - first)) - 1;
+            new (&bits[word]) std::atomic<uint64_t>(value);
+        }
+        
+        CentralList& depot = central[cls];
+        size_t block_size = block_size_of(cls);
+        for (size_t i = header->block_count; i-- > 0;) {
+            auto* block = reinterpret_cast<FreeBlock*>(base + FIRST_BLOCK + i * block_size);
+            block->next = depot.head;
+            block->mark = FREE_MARK;
+            depot.head = block;
+        }
+        depot.count += header->block_count;
+        depot.slabs++;
+        return true;
+    }
+    
+    bool refill(ThreadCache& cache, size_t cls) {
+        CentralList& depot = central[cls];
+        std::lock_guard<std::mutex> lock(depot.mtx);
+        if (depot.count == 0 && !carve_slab(cls)) {
+            return false;
+        }
+        
+        size_t moved = std::min(batch_size(cls), depot.count);
+        for (size_t i = 0; i < moved; i++) {
+            FreeBlock* block = depot.head;
+            depot.head = block->next;
+            block->next = cache.heads[cls];
+            cache.heads[cls] = block;
+        }
+        depot.count -= moved;
+        bump(cache.counts[cls], moved);
+        return true;
+    }
+    
+    void release_to_central(ThreadCache& cache, size_t cls, size_t count) {
+        if (count == 0) return;
+        FreeBlock* first = cache.heads[cls];
+        FreeBlock* last = first;
+        for (size_t i = 1; i < count; i++) {
+            last = last->next;
+        }
+        cache.heads[cls] = last->next;
+        bump(cache.counts[cls], size_t(0) - count);
+        
+        CentralList& depot = central[cls];
+        std::lock_guard<std::mutex> lock(depot.mtx);
+        last->next = depot.head;
+        depot.head = first;
+        depot.count += count;
+    }
+    
+    // Large blocks start right after the header, an offset no slab block
+    // has, so deallocate() can tell them apart without reading the header
+    // of memory that may already be freed.
+    void* allocate_large(size_t size) {
+        size_t bytes = HEADER_SIZE + size;
+        char* base = new_region(bytes);
+        if (!base) return nullptr;
+        
+        auto* header = reinterpret_cast<SlabHeader*>(base);
+        header->pool = this;
+        header->size_class = LARGE_CLASS;
+        header->block_count = 1;
+        header->large_size = size;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            large_count++;
+            large_bytes += size;
+        }
+        return base + HEADER_SIZE;
+    }
+    
+    // The registry, not the header, says whether the block is still live,
+    // so a second free of a large block is ignored (unless the address was
+    // since reused for a new region of this pool).
+    void deallocate_large(void* ptr) {
+        SlabHeader* header = header_of(ptr);
+        char* base = reinterpret_cast<char*>(header);
+        size_t size;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            if (slab_bases.count(base) == 0 || header->size_class != LARGE_CLASS) return;
+            size = header->large_size;
+            slab_bases.erase(base);
+            large_count--;
+            large_bytes -= size;
+        }
+        memory_tracker.track_deallocation(ptr, size);
+        reserved_bytes.fetch_sub(HEADER_SIZE + size, std::memory_order_relaxed);
+        free(base);
+    }
+    
+    // Caller holds registry_mutex.
+    bool owns_block(const void* ptr) const {
+        SlabHeader* header = header_of(ptr);
+        if (slab_bases.count(reinterpret_cast<char*>(header)) == 0 || header->pool != this) {
+            return false;
+        }
+        size_t offset = static_cast<const char*>(ptr) - reinterpret_cast<const char*>(header);
+        if (header->size_class == LARGE_CLASS) {
+            return offset == HEADER_SIZE;
+        }
+        size_t block_size = block_size_of(header->size_class);
+        return offset >= FIRST_BLOCK && (offset - FIRST_BLOCK) % block_size == 0 &&
+               (offset - FIRST_BLOCK) / block_size < header->block_count;
+    }
 
 public:
-    MemoryPool() = default;
+    // max_bytes caps the memory reserved from the system; 0 is unlimited.
+    // Allocations are sampled for the heap profile once per sample_period
+    // bytes on average, 0 records all of them.
+    explicit MemoryPool(size_t max_bytes = 0, size_t sample_period = MemoryTracker::DEFAULT_SAMPLE_PERIOD)
+        : pool_id(next_pool_id()), max_bytes(max_bytes), memory_tracker(sample_period) {
+        std::lock_guard<std::mutex> lock(live_pools_mutex());
+        live_pools()[pool_id] = this;
+    }
+    
     ~MemoryPool() {
+        {
+            std::lock_guard<std::mutex> lock(live_pools_mutex());
+            live_pools().erase(pool_id);
+        }
         memory_tracker.check_leaks();
+        for (char* base : slab_bases) {
+            free(base);
+        }
     }
     
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+    
+    // Blocks are aligned for any fundamental type. Returns nullptr when the
+    // pool's byte limit is reached or the system is out of memory.
     void* allocate(size_t size) {
-        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (size == 0) size = 1;
+        if (size > MAX_SMALL_SIZE) {
+            void* ptr = allocate_large(size);
+            if (ptr) memory_tracker.track_allocation(ptr, size, "MemoryPool");
+            return ptr;
+        }
         
-        if (memory_blocks.size() >= MAX_BLOCKS) {
+        size_t cls = class_of(size);
+        ThreadCache& cache = local_cache();
+        if (!cache.heads[cls] && !refill(cache, cls)) {
             return nullptr;
         }
         
-        auto block = std::make_unique<char[]>(BLOCK_SIZE);
-        void* ptr = block.get();
+        FreeBlock* block = cache.heads[cls];
+        cache.heads[cls] = block->next;
+        SlabHeader* header = header_of(block);
+        mark_live(header, block_index(header, block));
+        bump(cache.counts[cls], size_t(0) - 1);
+        bump(cache.live[cls], int64_t(1));
         
-        allocated_sizes[ptr] = size;
-        memory_blocks.push_back(std::move(block));
-        
-        BlockInfo info{size, BLOCK_SIZE - size, false};
-        block_info.push_back(info);
-        
-        memory_tracker.track_allocation(ptr, size, "MemoryPool");
-        
-        return ptr;
+        memory_tracker.track_allocation(block, block_size_of(cls), "MemoryPool");
+        return block;
     }
     
+    // ptr must be null or come from this pool. Repeated frees are ignored:
+    // slab blocks by their bitmap bit, large blocks by the region registry.
+    // Pointers into another pool's slabs are ignored as well.
     void deallocate(void* ptr) {
-        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (!ptr) return;
+        SlabHeader* header = header_of(ptr);
+        if (static_cast<char*>(ptr) - reinterpret_cast<char*>(header) == static_cast<ptrdiff_t>(HEADER_SIZE)) {
+            deallocate_large(ptr);
+            return;
+        }
+        if (header->pool != this) return;
+        if (!mark_free(header, block_index(header, ptr))) return;
         
-        auto it = allocated_sizes.find(ptr);
-        if (it != allocated_sizes.end()) {
-            memory_tracker.track_deallocation(ptr);
-            allocated_sizes.erase(it);
+        auto* block = static_cast<FreeBlock*>(ptr);
+        size_t cls = header->size_class;
+        memory_tracker.track_deallocation(ptr, block_size_of(cls));
+        ThreadCache& cache = local_cache();
+        block->mark = FREE_MARK;
+        block->next = cache.heads[cls];
+        cache.heads[cls] = block;
+        bump(cache.counts[cls], size_t(1));
+        bump(cache.live[cls], int64_t(-1));
+        
+        if (cache.counts[cls].load(std::memory_order_relaxed) > 2 * batch_size(cls)) {
+            release_to_central(cache, cls, batch_size(cls));
         }
     }
     
+    // Usable size of the block (its size class), or 0 if ptr is not a live
+    // allocation of this pool.
     size_t get_allocated_size(void* ptr) const {
-        std::lock_guard<std::mutex> lock(pool_mutex);
-        
-        auto it = allocated_sizes.find(ptr);
-        return (it != allocated_sizes.end()) ? it->second : 0;
+        if (!is_valid_pointer(ptr)) return 0;
+        SlabHeader* header = header_of(ptr);
+        return header->size_class == LARGE_CLASS ? header->large_size : block_size_of(header->size_class);
     }
     
+    // Diagnostic: not synchronized with another thread freeing or reusing
+    // the same block.
     bool is_valid_pointer(void* ptr) const {
-        std::lock_guard<std::mutex> lock(pool_mutex);
-        return allocated_sizes.find(ptr) != allocated_sizes.end();
+        if (!ptr) return false;
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        if (!owns_block(ptr)) return false;
+        SlabHeader* header = header_of(ptr);
+        return header->size_class == LARGE_CLASS || !is_free(header, block_index(header, ptr));
     }
     
-    void check_memory_corruption() {
-        std::lock_guard<std::mutex> lock(pool_mutex);
-        
-        for (size_t i = 0; i < memory_blocks.size(); ++i) {
-            char* block = memory_blocks[i].get();
-            size_t allocated = allocated_sizes[block];
-            
-            bool corrupted = false;
-            for (size_t j = allocated; j < BLOCK_SIZE; ++j) {
-                if (block[j] != 0) {
-                    corrupted = true;
+    // Walks the depot free lists (and the calling thread's cache) checking
+    // every block's link and mark. A list is cut at the first damaged block,
+    // which leaks the rest of it rather than handing out bad memory.
+    size_t check_memory_corruption() {
+        size_t corrupted = 0;
+        auto verify = [&](FreeBlock*& head, size_t cls) {
+            size_t kept = 0;
+            FreeBlock** link = &head;
+            while (*link) {
+                bool owned;
+                {
+                    std::lock_guard<std::mutex> lock(registry_mutex);
+                    owned = owns_block(*link) && header_of(*link)->size_class == cls;
+                }
+                SlabHeader* header = header_of(*link);
+                if (!owned || (*link)->mark != FREE_MARK || !is_free(header, block_index(header, *link))) {
+                    corrupted++;
+                    *link = nullptr;
                     break;
                 }
+                kept++;
+                link = &(*link)->next;
             }
-            
-            block_info[i].is_corrupted = corrupted;
+            return kept;
+        };
+        
+        ThreadCache& cache = local_cache();
+        for (size_t cls = 0; cls < CLASS_COUNT; cls++) {
+            cache.counts[cls].store(verify(cache.heads[cls], cls), std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(central[cls].mtx);
+            central[cls].count = verify(central[cls].head, cls);
         }
+        corrupted_blocks.fetch_add(corrupted, std::memory_order_relaxed);
+        return corrupted;
     }
     
-    void defragment() {
-        std::lock_guard<std::mutex> lock(pool_mutex);
-        
-        size_t total_used = 0;
-        for (const auto& info : block_info) {
-            total_used += info.used_size;
-        }
-        
-        std::vector<std::unique_ptr<char[]>> new_blocks;
-        std::map<void*, size_t> new_sizes;
-        std::vector<BlockInfo> new_info;
-        
-        size_t current_block = 0;
-        size_t current_offset = 0;
+    // Returns slabs whose blocks are all back in the depot to the system,
+    // after flushing the calling thread's cache. Live blocks never move.
+    // Returns the number of slabs released.
+    size_t defragment() {
+        ThreadCache& cache = local_cache();
+        size_t released = 0;
         
-        for (const auto& pair : allocated_sizes) {
-            size_t size = pair.second;
+        for (size_t cls = 0; cls < CLASS_COUNT; cls++) {
+            release_to_central(cache, cls, cache.counts[cls].load(std::memory_order_relaxed));
             
-            if (current_offset + size > BLOCK_SIZE) {
-                current_block++;
-                current_offset = 0;
+            CentralList& depot = central[cls];
+            std::lock_guard<std::mutex> lock(depot.mtx);
+            std::unordered_map<SlabHeader*, size_t> free_per_slab;
+            for (FreeBlock* block = depot.head; block; block = block->next) {
+                free_per_slab[header_of(block)]++;
             }
             
-            while (current_block >= new_blocks.size()) {
-                new_blocks.push_back(std::make_unique<char[]>(BLOCK_SIZE));
-                new_info.push_back({0, BLOCK_SIZE, false});
+            std::unordered_set<SlabHeader*> empty;
+            for (const auto& entry : free_per_slab) {
+                if (entry.second == entry.first->block_count) empty.insert(entry.first);
             }
+            if (empty.empty()) continue;
             
-            char* src = static_cast<char*>(pair.first);
-            char* dst = new_blocks[current_block].get() + current_offset;
-            std::memcpy(dst, src, size);
-            
-            new_sizes[dst] = size;
-            new_info[current_block].used_size += size;
-            new_info[current_block].fragmentation = 
-                BLOCK_SIZE - new_info[current_block].used_size;
-            
-            current_offset += size;
+            FreeBlock** link = &depot.head;
+            while (*link) {
+                if (empty.count(header_of(*link))) {
+                    *link = (*link)->next;
+                    depot.count--;
+                } else {
+                    link = &(*link)->next;
+                }
+            }
+            for (SlabHeader* header : empty) {
+                free_region(reinterpret_cast<char*>(header), SLAB_SIZE);
+                depot.slabs--;
+                released++;
+            }
         }
-        
-        memory_blocks = std::move(new_blocks);
-        allocated_sizes = std::move(new_sizes);
-        block_info = std::move(new_info);
+        return released;
     }
     
     void print_pool_status() const {
-        std::lock_guard<std::mutex> lock(pool_mutex);
+        int64_t live[CLASS_COUNT] = {};
+        size_t cached[CLASS_COUNT] = {};
+        size_t large_allocations;
+        size_t large_total;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            for (const auto& cache : caches) {
+                for (size_t cls = 0; cls < CLASS_COUNT; cls++) {
+                    live[cls] += cache->live[cls].load(std::memory_order_relaxed);
+                    cached[cls] += cache->counts[cls].load(std::memory_order_relaxed);
+                }
+            }
+            large_allocations = large_count;
+            large_total = large_bytes;
+        }
         
         std::cout << "Memory Pool Status:" << std::endl;
-        std::cout << "  Total blocks: " << memory_blocks.size() << std::endl;
-        std::cout << "  Allocated pointers: " << allocated_sizes.size() << std::endl;
-        
-        size_t total_fragmentation = 0;
-        size_t corrupted_blocks = 0;
+        std::cout << "  Class      Slabs   Live blocks   Free (depot/cached)" << std::endl;
         
-        for (size_t i = 0; i < memory_blocks.size(); ++i) {
-            const auto& info = block_info[i];
-            total_fragmentation += info.fragmentation;
-            if (info.is_corrupted) corrupted_blocks++;
+        size_t slab_bytes = 0;
+        size_t live_bytes = 0;
+        size_t free_bytes = 0;
+        size_t total_slabs = 0;
+        for (size_t cls = 0; cls < CLASS_COUNT; cls++) {
+            size_t slabs;
+            size_t depot_free;
+            {
+                std::lock_guard<std::mutex> lock(central[cls].mtx);
+                slabs = central[cls].slabs;
+                depot_free = central[cls].count;
+            }
+            if (slabs == 0) continue;
             
-            std::cout << "  Block " << i << ":" << std::endl;
-            std::cout << "    Used: " << info.used_size << " bytes" << std::endl;
-            std::cout << "    Fragmentation: " << info.fragmentation << " bytes" << std::endl;
-            std::cout << "    Corrupted: " << (info.is_corrupted ? "Yes" : "No") << std::endl;
+            size_t block_size = block_size_of(cls);
+            size_t in_use = static_cast<size_t>(std::max<int64_t>(live[cls], 0));
+            total_slabs += slabs;
+            slab_bytes += slabs * SLAB_SIZE;
+            live_bytes += in_use * block_size;
+            free_bytes += (depot_free + cached[cls]) * block_size;
+            std::cout << "  " << std::setw(6) << block_size << " B " << std::setw(7) << slabs
+                      << std::setw(14) << in_use << std::setw(12) << depot_free << "/" << cached[cls] << std::endl;
         }
         
+        size_t reserved = slab_bytes + large_total;
+        size_t used = live_bytes + large_total;
         std::cout << "\nSummary:" << std::endl;
-        std::cout << "  Total fragmentation: " << total_fragmentation << " bytes" << std::endl;
-        std::cout << "  Corrupted blocks: " << corrupted_blocks << std::endl;
+        std::cout << "  Slabs: " << total_slabs << " (" << slab_bytes << " bytes)" << std::endl;
+        std::cout << "  Large allocations: " << large_allocations << " (" << large_total << " bytes)" << std::endl;
+        std::cout << "  Live bytes: " << used << " of " << reserved << " reserved" << std::endl;
+        std::cout << "  Utilization: " << std::fixed << std::setprecision(1)
+                  << (reserved > 0 ? 100.0 * used / reserved : 0.0) << "%" << std::defaultfloat << std::endl;
+        std::cout << "  Fragmentation: " << free_bytes << " bytes free in slabs, "
+                  << (slab_bytes - live_bytes - free_bytes) << " bytes of slab headers and tails" << std::endl;
+        std::cout << "  Corrupted blocks: " << corrupted_blocks.load(std::memory_order_relaxed) << std::endl;
         
         memory_tracker.print_stats();
     }
+    
+    void dump_heap_profile(std::ostream& out) const {
+        memory_tracker.dump_heap_profile(out);
+    }
+};
+
+// Standard allocator over a MemoryPool, e.g.
+// std::vector<int, PoolAllocator<int>> values(PoolAllocator<int>(pool));
+template<typename T>
+class PoolAllocator {
+private:
+    template<typename U> friend class PoolAllocator;
+    MemoryPool* pool;
+
+public:
+    using value_type = T;
+    
+    static_assert(alignof(T) <= alignof(std::max_align_t), "MemoryPool blocks are only max_align_t aligned");
+    
+    explicit PoolAllocator(MemoryPool& pool) noexcept : pool(&pool) {}
+    
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept : pool(other.pool) {}
+    
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        void* ptr = pool->allocate(n * sizeof(T));
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+    
+    void deallocate(T* ptr, size_t) noexcept {
+        pool->deallocate(ptr);
+    }
+    
+    template<typename U>
+    bool operator==(const PoolAllocator<U>& other) const noexcept {
+        return pool == other.pool;
+    }
+    
+    template<typename U>
+    bool operator!=(const PoolAllocator<U>& other) const noexcept {
+        return pool != other.pool;
+    }
 };
 
 class SmartPointerTest {
@@ -471,6 +1218,30 @@ public:
         memory_pool.defragment();
     }
     
+    void test_pool_allocator() {
+        std::cout << "\nTesting pool-backed containers..." << std::endl;
+        
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; t++) {
+            workers.emplace_back([this, t]() {
+                std::vector<int, PoolAllocator<int>> values{PoolAllocator<int>(memory_pool)};
+                std::map<int, int, std::less<int>, PoolAllocator<std::pair<const int, int>>> squares{
+                    PoolAllocator<std::pair<const int, int>>(memory_pool)};
+                for (int i = 0; i < 10000; i++) {
+                    values.push_back(i * t);
+                    squares[i] = i * i;
+                }
+                std::cout << "Thread " << t << ": " << values.size() << " values, "
+                          << squares.size() << " map entries" << std::endl;
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        
+        std::cout << "Slabs released: " << memory_pool.defragment() << std::endl;
+    }
+    
     void test_circular_reference() {
         std::cout << "\nTesting circular reference..." << std::endl;
         
@@ -520,10 +1291,19 @@ public:
         array[0] = 999;
     }
     
+    void print_pool_status() const {
+        memory_pool.print_pool_status();
+    }
+    
+    void dump_pool_profile(std::ostream& out) const {
+        memory_pool.dump_heap_profile(out);
+    }
+    
     void run_all_tests() {
         test_shared_ptr_management();
         test_raw_pointer_vulnerability();
         test_memory_pool_vulnerability();
+        test_pool_allocator();
         test_circular_reference();
         test_array_vulnerability();
         
@@ -543,6 +1323,8 @@ int main(int argc, char* argv[]) {
         std::cout << "  shared - Test shared_ptr management" << std::endl;
         std::cout << "  raw - Test raw pointer vulnerabilities" << std::endl;
         std::cout << "  pool - Test memory pool vulnerabilities" << std::endl;
+        std::cout << "  alloc - Test pool-backed containers" << std::endl;
+        std::cout << "  profile [file] - Run the container test and write a pool heap profile" << std::endl;
         std::cout << "  circular - Test circular reference" << std::endl;
         std::cout << "  array - Test array vulnerabilities" << std::endl;
         return 1;
@@ -563,6 +1345,17 @@ int main(int argc, char* argv[]) {
     else if (command == "pool") {
         test.test_memory_pool_vulnerability();
     }
+    else if (command == "alloc") {
+        test.test_pool_allocator();
+        test.print_pool_status();
+    }
+    else if (command == "profile") {
+        std::string path = argc > 2 ? argv[2] : "memory_pool.heap";
+        test.test_pool_allocator();
+        std::ofstream out(path);
+        test.dump_pool_profile(out);
+        std::cout << "Heap profile written to " << path << " (view with: pprof -sample_index=alloc_space " << argv[0] << " " << path << ")" << std::endl;
+    }
     else if (command == "circular") {
         test.test_circular_reference();
     }
@@ -4,6 +4,7 @@
 #include <memory>
 #include <type_traits>
 #include <algorithm>
+#include <charconv>
 #include <functional>
 #include <utility>
 #include <tuple>
@@ -11,6 +12,20 @@
 #include <chrono>
 #include <numeric>
 #include <random>
+#include <optional>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace TemplateEngine {
 
@@ -380,26 +395,419 @@ private:
 };
 
 
+// Compiler barriers for benchmarks: do_not_optimize makes the compiler
+// assume value is read (and, for lvalues, written), clobber_memory that all
+// memory is.
+template<typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+template<typename T>
+inline void do_not_optimize(T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(void*)) {
+        asm volatile("" : "+r"(value) : : "memory");
+    } else {
+        asm volatile("" : "+m"(value) : : "memory");
+    }
+#else
+    static volatile void* sink;
+    sink = &value;
+#endif
+}
+
+inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+
+// One-shot timing of a single call.
 template<typename Func>
 class BenchmarkRunner {
 public:
     template<typename... Args>
     static auto measure(Func func, Args&&... args) {
-        auto start = std::chrono::high_resolution_clock::now();
+        auto start = std::chrono::steady_clock::now();
         
         if constexpr (std::is_void_v<std::invoke_result_t<Func, Args...>>) {
             func(std::forward<Args>(args)...);
-            auto end = std::chrono::high_resolution_clock::now();
+            auto end = std::chrono::steady_clock::now();
             return std::chrono::duration_cast<std::chrono::microseconds>(end - start);
         } else {
             auto result = func(std::forward<Args>(args)...);
-            auto end = std::chrono::high_resolution_clock::now();
+            do_not_optimize(result);
+            auto end = std::chrono::steady_clock::now();
             auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
             return std::make_pair(result, duration);
         }
     }
 };
 
+
+// Hardware counters for the calling thread (user space only) through
+// perf_event_open. Unavailable off Linux or when perf_event_paranoid or
+// a container forbids it.
+class PerfCounters {
+public:
+    static constexpr size_t COUNT = 4;
+    static constexpr const char* NAMES[COUNT] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+    using Values = std::array<uint64_t, COUNT>;
+    
+    PerfCounters() {
+#if defined(__linux__)
+        const uint64_t configs[COUNT] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                         PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (size_t i = 0; i < COUNT; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[i];
+            attr.disabled = i == 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds_[0], 0));
+            if (fds_[i] < 0) {
+                close_all();
+                return;
+            }
+        }
+        available_ = true;
+#endif
+    }
+    
+    ~PerfCounters() { close_all(); }
+    
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    
+    bool available() const noexcept { return available_; }
+    
+    void reset() { control(Control::RESET); }
+    void start() { control(Control::ENABLE); }
+    void stop() { control(Control::DISABLE); }
+    
+    Values read() const {
+        Values values{};
+#if defined(__linux__)
+        if (available_) {
+            struct {
+                uint64_t count;
+                uint64_t values[COUNT];
+            } group{};
+            if (::read(fds_[0], &group, sizeof(group)) == static_cast<ssize_t>(sizeof(group))) {
+                std::copy(group.values, group.values + COUNT, values.begin());
+            }
+        }
+#endif
+        return values;
+    }
+    
+private:
+    enum class Control { RESET, ENABLE, DISABLE };
+    
+    int fds_[COUNT] = {-1, -1, -1, -1};
+    bool available_ = false;
+    
+    void control(Control operation) {
+#if defined(__linux__)
+        if (!available_) return;
+        unsigned long request = operation == Control::RESET ? PERF_EVENT_IOC_RESET
+                              : operation == Control::ENABLE ? PERF_EVENT_IOC_ENABLE
+                              : PERF_EVENT_IOC_DISABLE;
+        ioctl(fds_[0], request, PERF_IOC_FLAG_GROUP);
+#else
+        (void)operation;
+#endif
+    }
+    
+    void close_all() {
+#if defined(__linux__)
+        for (int& fd : fds_) {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+#endif
+        available_ = false;
+    }
+};
+
+
+// Handed to a benchmark body, which runs its kernel iterations() times.
+// Work between pause_timing() and resume_timing() is not measured.
+class BenchmarkState {
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    size_t iterations_;
+    PerfCounters* counters_;
+    Clock::duration elapsed_{};
+    Clock::time_point started_;
+    
+public:
+    BenchmarkState(size_t iterations, PerfCounters* counters) : iterations_(iterations), counters_(counters) {}
+    
+    size_t iterations() const noexcept { return iterations_; }
+    
+    void pause_timing() {
+        elapsed_ += Clock::now() - started_;
+        if (counters_) counters_->stop();
+    }
+    
+    void resume_timing() {
+        if (counters_) counters_->start();
+        started_ = Clock::now();
+    }
+    
+    double elapsed_ns() const {
+        return std::chrono::duration<double, std::nano>(elapsed_).count();
+    }
+};
+
+
+struct BenchmarkResult {
+    std::string name;
+    size_t iterations = 0;
+    size_t repetitions = 0;
+    double min_ns = 0;
+    double median_ns = 0;
+    double mean_ns = 0;
+    double p99_ns = 0;
+    double max_ns = 0;
+    double stddev_ns = 0;
+    size_t outliers = 0;
+    bool has_counters = false;
+    std::array<double, PerfCounters::COUNT> counters{};
+};
+
+
+struct BenchmarkOptions {
+    std::string filter;
+    size_t repetitions = 30;
+    double min_batch_ms = 5.0;
+    bool perf_counters = false;
+    std::string format = "console";
+};
+
+
+// A set of named benchmarks. Each is warmed up while its iteration count is
+// scaled until one batch runs for at least min_batch_ms, then timed for
+// `repetitions` batches; statistics are over per-iteration batch times.
+class BenchmarkSuite {
+private:
+    using Body = std::function<void(BenchmarkState&)>;
+    
+    std::vector<std::pair<std::string, Body>> benchmarks_;
+    
+    static double run_batch(const Body& body, size_t iterations, PerfCounters* counters) {
+        BenchmarkState state(iterations, counters);
+        if (counters) counters->reset();
+        state.resume_timing();
+        body(state);
+        state.pause_timing();
+        return state.elapsed_ns();
+    }
+    
+    // Linear interpolation between closest ranks. Nearest rank would make
+    // p99 equal the maximum for anything under 100 repetitions.
+    static double percentile(const std::vector<double>& sorted, double fraction) {
+        double position = fraction * (sorted.size() - 1);
+        size_t lower = static_cast<size_t>(position);
+        if (lower + 1 >= sorted.size()) return sorted.back();
+        return sorted[lower] + (position - lower) * (sorted[lower + 1] - sorted[lower]);
+    }
+    
+    static BenchmarkResult run_one(const std::string& name, const Body& body, const BenchmarkOptions& options,
+                                   PerfCounters* counters) {
+        const double target_ns = options.min_batch_ms * 1e6;
+        size_t iterations = 1;
+        for (;;) {
+            double elapsed = run_batch(body, iterations, nullptr);
+            if (elapsed >= target_ns || iterations >= (size_t(1) << 30)) break;
+            double factor = elapsed > 0 ? 1.4 * target_ns / elapsed : 10.0;
+            iterations = static_cast<size_t>(iterations * std::clamp(factor, 2.0, 10.0));
+        }
+        run_batch(body, iterations, nullptr);
+        
+        std::vector<double> samples;
+        std::array<double, PerfCounters::COUNT> totals{};
+        for (size_t rep = 0; rep < options.repetitions; ++rep) {
+            samples.push_back(run_batch(body, iterations, counters) / iterations);
+            if (counters) {
+                auto values = counters->read();
+                for (size_t i = 0; i < PerfCounters::COUNT; ++i) totals[i] += values[i];
+            }
+        }
+        
+        BenchmarkResult result;
+        result.name = name;
+        result.iterations = iterations;
+        result.repetitions = samples.size();
+        
+        std::vector<double> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        result.min_ns = sorted.front();
+        result.max_ns = sorted.back();
+        result.median_ns = percentile(sorted, 0.5);
+        result.p99_ns = percentile(sorted, 0.99);
+        result.mean_ns = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+        
+        double squares = 0;
+        for (double sample : sorted) squares += (sample - result.mean_ns) * (sample - result.mean_ns);
+        result.stddev_ns = sorted.size() > 1 ? std::sqrt(squares / (sorted.size() - 1)) : 0.0;
+        
+        double q1 = percentile(sorted, 0.25);
+        double q3 = percentile(sorted, 0.75);
+        double fence = 1.5 * (q3 - q1);
+        result.outliers = count_if_container(sorted, [&](double sample) {
+            return sample < q1 - fence || sample > q3 + fence;
+        });
+        
+        if (counters) {
+            result.has_counters = true;
+            double total_iterations = static_cast<double>(iterations) * samples.size();
+            for (size_t i = 0; i < PerfCounters::COUNT; ++i) result.counters[i] = totals[i] / total_iterations;
+        }
+        return result;
+    }
+    
+    static std::string json_escape(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+    
+    static std::string csv_quote(const std::string& text) {
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+    
+public:
+    void add(std::string name, Body body) {
+        benchmarks_.emplace_back(std::move(name), std::move(body));
+    }
+    
+    // Registers a nullary kernel; its result is kept alive with
+    // do_not_optimize.
+    template<typename Func>
+    void add_function(std::string name, Func func) {
+        add(std::move(name), [func](BenchmarkState& state) {
+            for (size_t i = 0; i < state.iterations(); ++i) {
+                if constexpr (std::is_void_v<std::invoke_result_t<Func>>) {
+                    func();
+                    clobber_memory();
+                } else {
+                    auto result = func();
+                    do_not_optimize(result);
+                }
+            }
+        });
+    }
+    
+    std::vector<BenchmarkResult> run(const BenchmarkOptions& options) const {
+        std::unique_ptr<PerfCounters> counters;
+        if (options.perf_counters) {
+            counters = std::make_unique<PerfCounters>();
+            if (!counters->available()) {
+                std::cerr << "perf_event counters unavailable, timing only\n";
+                counters.reset();
+            }
+        }
+        
+        std::vector<BenchmarkResult> results;
+        for (const auto& [name, body] : benchmarks_) {
+            if (name.find(options.filter) == std::string::npos) continue;
+            results.push_back(run_one(name, body, options, counters.get()));
+        }
+        return results;
+    }
+    
+    static void write_console(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+        out << std::left << std::setw(36) << "Benchmark" << std::right << std::setw(11) << "Iterations"
+            << std::setw(12) << "Min ns" << std::setw(12) << "Median ns" << std::setw(12) << "P99 ns"
+            << std::setw(12) << "Stddev ns" << std::setw(9) << "Outliers" << "\n";
+        out << std::fixed << std::setprecision(1);
+        for (const auto& result : results) {
+            out << std::left << std::setw(36) << result.name << std::right << std::setw(11) << result.iterations
+                << std::setw(12) << result.min_ns << std::setw(12) << result.median_ns << std::setw(12)
+                << result.p99_ns << std::setw(12) << result.stddev_ns << std::setw(9) << result.outliers << "\n";
+            if (result.has_counters) {
+                out << "    per iteration:";
+                for (size_t i = 0; i < PerfCounters::COUNT; ++i) {
+                    out << " " << PerfCounters::NAMES[i] << "=" << result.counters[i];
+                }
+                out << "\n";
+            }
+        }
+        out << std::defaultfloat;
+    }
+    
+    static void write_json(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+        out << "{\n  \"benchmarks\": [";
+        out << std::setprecision(6);
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto& result = results[i];
+            out << (i ? "," : "") << "\n    {\"name\": \"" << json_escape(result.name) << "\""
+                << ", \"iterations\": " << result.iterations << ", \"repetitions\": " << result.repetitions
+                << ", \"min_ns\": " << result.min_ns << ", \"median_ns\": " << result.median_ns
+                << ", \"mean_ns\": " << result.mean_ns << ", \"p99_ns\": " << result.p99_ns
+                << ", \"max_ns\": " << result.max_ns << ", \"stddev_ns\": " << result.stddev_ns
+                << ", \"outliers\": " << result.outliers;
+            if (result.has_counters) {
+                for (size_t c = 0; c < PerfCounters::COUNT; ++c) {
+                    out << ", \"" << PerfCounters::NAMES[c] << "\": " << result.counters[c];
+                }
+            }
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+    
+    static void write_csv(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+        out << "name,iterations,repetitions,min_ns,median_ns,mean_ns,p99_ns,max_ns,stddev_ns,outliers";
+        for (const char* counter : PerfCounters::NAMES) out << "," << counter;
+        out << "\n" << std::setprecision(6);
+        for (const auto& result : results) {
+            out << csv_quote(result.name) << "," << result.iterations << "," << result.repetitions << ","
+                << result.min_ns << "," << result.median_ns << "," << result.mean_ns << "," << result.p99_ns
+                << "," << result.max_ns << "," << result.stddev_ns << "," << result.outliers;
+            for (size_t c = 0; c < PerfCounters::COUNT; ++c) {
+                out << ",";
+                if (result.has_counters) out << result.counters[c];
+            }
+            out << "\n";
+        }
+    }
+    
+    static void write(std::ostream& out, const std::vector<BenchmarkResult>& results, const std::string& format) {
+        if (format == "json") {
+            write_json(out, results);
+        } else if (format == "csv") {
+            write_csv(out, results);
+        } else {
+            write_console(out, results);
+        }
+    }
+};
+
 } 
 
 
@@ -536,7 +944,154 @@ void demonstratePerformance() {
               << fib_duration.count() << " microseconds\n";
 }
 
-int main() {
+void registerTemplateBenchmarks(TemplateEngine::BenchmarkSuite& suite) {
+    using namespace TemplateEngine;
+    
+    auto shuffled = std::make_shared<std::vector<int>>(10000);
+    std::iota(shuffled->begin(), shuffled->end(), 1);
+    std::mt19937 gen(42);
+    std::shuffle(shuffled->begin(), shuffled->end(), gen);
+    
+    suite.add("sort/std::sort 10000", [shuffled](BenchmarkState& state) {
+        std::vector<int> work(shuffled->size());
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            state.pause_timing();
+            std::copy(shuffled->begin(), shuffled->end(), work.begin());
+            state.resume_timing();
+            std::sort(work.begin(), work.end());
+            do_not_optimize(work.data());
+            clobber_memory();
+        }
+    });
+    
+    auto sorted = std::make_shared<std::vector<int>>(100000);
+    std::iota(sorted->begin(), sorted->end(), 0);
+    auto keys = std::make_shared<std::vector<int>>(1024);
+    std::uniform_int_distribution<int> key(0, 100000);
+    for (auto& k : *keys) k = key(gen);
+    
+    suite.add("search/lower_bound 100000", [sorted, keys](BenchmarkState& state) {
+        for (size_t i = 0; i < state.iterations(); ++i) {
+            auto it = std::lower_bound(sorted->begin(), sorted->end(), (*keys)[i & 1023]);
+            do_not_optimize(it);
+        }
+    });
+    
+    suite.add_function("count_if_container 10000", [shuffled]() {
+        return count_if_container(*shuffled, [](int x) { return x % 2 == 0; });
+    });
+    
+    suite.add_function("StaticArray<int, 64>/fill+sum", []() {
+        StaticArray<int, 64> array;
+        for (int i = 0; i < 64; ++i) {
+            int value = i;
+            do_not_optimize(value);
+            array.push_back(value);
+        }
+        return std::accumulate(array.begin(), array.end(), 0);
+    });
+    
+    suite.add_function("StaticArray<bool, 1024>/set+get", []() {
+        StaticArray<bool, 1024> bits;
+        for (size_t i = 0; i < 1024; ++i) bits.push_back(i % 3 == 0);
+        do_not_optimize(bits);
+        const auto& view = bits;
+        size_t set = 0;
+        for (size_t i = 0; i < view.size(); ++i) set += view[i];
+        return set;
+    });
+    
+    suite.add_function("Variant<int, string, double>/visit", []() {
+        Variant<int, std::string, double> value(3.14);
+        do_not_optimize(value);
+        return value.visit([](const auto& held) -> size_t { return sizeof(held); });
+    });
+    
+    suite.add_function("UniquePtr/make+reset", []() {
+        auto ptr = make_unique_custom<std::string>("benchmark payload");
+        do_not_optimize(*ptr);
+        ptr.reset();
+        return ptr.get();
+    });
+    
+    auto multiply = partial([](int a, int b, int c) { return a * b * c; }, 2, 3);
+    suite.add_function("PartialApplication/call", [multiply]() {
+        int c = 4;
+        do_not_optimize(c);
+        return multiply(c);
+    });
+    
+    auto events = std::make_shared<Observable<int>>();
+    auto received = std::make_shared<long>(0);
+    for (int i = 0; i < 8; ++i) {
+        events->subscribe([received](const int& event) { *received += event; });
+    }
+    suite.add_function("Observable<int>/notify 8 observers", [events, received]() {
+        events->notify(1);
+        return *received;
+    });
+    
+    suite.add_function("fibonacci(20) at run time", []() {
+        int n = 20;
+        do_not_optimize(n);
+        return fibonacci(n);
+    });
+}
+
+// The whole of `text` must be a number in [min, max]; no sign wrapping,
+// trailing characters, NaN or infinity.
+template<typename T>
+T parseOption(const std::string& text, T min, T max) {
+    T value{};
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    if (text.empty() || result.ec != std::errc() || result.ptr != end || !(value >= min && value <= max)) {
+        throw std::invalid_argument(text);
+    }
+    return value;
+}
+
+int runBenchmarks(int argc, char* argv[]) {
+    using namespace TemplateEngine;
+    
+    BenchmarkOptions options;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&arg](const char* prefix) -> std::optional<std::string> {
+                size_t length = std::strlen(prefix);
+                if (arg.compare(0, length, prefix) != 0) return std::nullopt;
+                return arg.substr(length);
+            };
+            
+            if (auto v = value("--filter=")) options.filter = *v;
+            else if (auto v = value("--repetitions=")) options.repetitions = parseOption<size_t>(*v, 1, 1000000);
+            else if (auto v = value("--min-time-ms=")) options.min_batch_ms = parseOption<double>(*v, 0.0, 60000.0);
+            else if (auto v = value("--format=")) options.format = *v;
+            else if (arg == "--perf") options.perf_counters = true;
+            else throw std::invalid_argument(arg);
+        }
+        if (options.format != "console" && options.format != "json" && options.format != "csv") {
+            throw std::invalid_argument(options.format);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid benchmark option: " << e.what() << "\n"
+                  << "Usage: " << argv[0] << " bench [--filter=TEXT] [--repetitions=N] [--min-time-ms=MS]"
+                  << " [--format=console|json|csv] [--perf]\n";
+        return 1;
+    }
+    
+    BenchmarkSuite suite;
+    registerTemplateBenchmarks(suite);
+    BenchmarkSuite::write(std::cout, suite.run(options), options.format);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        return runBenchmarks(argc, argv);
+    }
+    
     std::cout << "C++ Template Programming Demonstration\n";
     std::cout << "=====================================\n\n";
     